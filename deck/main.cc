@@ -49,28 +49,14 @@ vpic_simulation** restore_main(void)
 void checkpt(const char* fbase, int tag)
 {
 
-    ////////// Pull Kokkos data back from the device
-    species_t* sp;
-    LIST_FOR_EACH( sp, simulation->species_list )
-    {
-        if (simulation->step() > sp->last_copied)
-        {
-            sp->copy_to_host();
-        }
-    }
-
-    simulation->field_array->copy_to_host();
-    simulation->interpolator_array->copy_to_host();
-
-    //std::cout << "Copying data back to host for checkpointing.." << std::endl;
-
-    ///// End Kokkos Copy Data /////
+    // The Kokkos data is checkpointed straight from the device (see
+    // checkpt_kokkos.h), so nothing needs to be copied back first
 
     char fname[256];
     if( !fbase ) ERROR(( "NULL filename base" ));
     sprintf( fname, "%s.%i.%i", fbase, tag, world_rank );
     if( world_rank==0 ) log_printf( "*** Checkpointing to \"%s\"\n", fbase );
-    checkpt_objects( fname );
+    simulation->checkpt_objects( fname );
 }
 
 /**
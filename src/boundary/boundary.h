@@ -124,6 +124,12 @@ boundary_p_kokkos( particle_bc_t       * RESTRICT pbc_list,
             field_array_t       * RESTRICT fa
         );
 
+void
+boundary_p_kokkos_device( particle_bc_t       * RESTRICT pbc_list,
+            species_t           * RESTRICT sp_list,
+            field_array_t       * RESTRICT fa
+        );
+
 /* In maxwellian_reflux.c */
 
 particle_bc_t *
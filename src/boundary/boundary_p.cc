@@ -537,6 +537,304 @@ boundary_p_kokkos(
   }
 }
 
+// Slots of species_t::k_exchange_count_d after the six per face send counts
+enum { EXCHANGE_ABSORBED = 6, EXCHANGE_DROPPED = 7, EXCHANGE_KEPT = 8 };
+
+/**
+ * @brief Device resident version of boundary_p_kokkos. The movers advance_p
+ * left in k_pc_d / k_pm_d are sorted by face and packed into injectors on
+ * the device, exchanged straight from device buffers and the received
+ * particles finish their move on the device. Particles that stay local are
+ * staged in k_pr_d for species_t::append_inbound_on_device, particles that
+ * hit another boundary become the movers of the next round.
+ *
+ * Unlike the host version this does not feed the particle boundary
+ * diagnostic, so advance() falls back to the host path when that (or
+ * anything else that edits the movers on the host) is in use.
+ *
+ * Species are exchanged one after the other, each with its own count and
+ * particle messages on every shared face. Without VPIC_ENABLE_GPU_AWARE_MPI
+ * the packed buffers are staged through host mirrors, which is a single
+ * contiguous copy per face (and free on CPU builds).
+ *
+ * @param pbc_list Particle boundary condition list
+ * @param sp_list Species list
+ * @param fa Field array
+ */
+void
+boundary_p_kokkos_device(
+        particle_bc_t       * RESTRICT pbc_list,
+        species_t           * RESTRICT sp_list,
+        field_array_t       * RESTRICT fa
+      )
+{
+  species_t * sp;
+  int face;
+
+  // Check input args
+
+  if( !sp_list ) return; // Nothing to do if no species
+  if( !fa )
+    ERROR(( "Bad args" ));
+
+  // Unpack the grid
+
+  grid_t * RESTRICT g  = fa->g;
+  mp_t   * RESTRICT mp = g->mp;
+  mp_t   * RESTRICT mp_k = g->mp_k;
+  const int64_t rangel = g->rangel;
+  const int64_t rangeh = g->rangeh;
+  const int64_t rangem = g->range[world_size];
+
+  const int nx = g->nx, ny = g->ny, nz = g->nz;
+  const int sy = g->sy, sz = g->sz;
+  const float cx = 0.25 * g->rdy * g->rdz / g->dt;
+  const float cy = 0.25 * g->rdz * g->rdx / g->dt;
+  const float cz = 0.25 * g->rdx * g->rdy / g->dt;
+
+  const auto& k_neighbor = g->k_neighbor_d;
+  k_field_t k_field = fa->k_f_d;
+
+  int bc[6], shared[6], n_send[6], n_recv[6], recv_offset[6];
+
+  // Local copies of the face tables so the kernels can capture them
+  int64_t range[6];
+  int face_axis[6];
+  float face_dir[6];
+
+  for( face=0; face<6; face++ ) {
+    bc[face] = g->bc[f2b[face]];
+    shared[face] = (bc[face]>=0) && (bc[face]<world_size) &&
+                   (bc[face]!=world_rank);
+    range[face] = shared[face] ? g->range[bc[face]] : 0;
+    face_axis[face] = axis[face];
+    face_dir[face] = dir[face];
+  }
+
+  LIST_FOR_EACH( sp, sp_list )
+  {
+    const int nm = sp->nm;
+    const int max_nm = sp->max_nm;
+    const int max_nr = sp->k_pr_d.extent(0);
+    const int num_to_copy = sp->num_to_copy;
+    const int32_t sp_id = sp->id;
+    const float qsp = sp->q;
+    const float q_8V = qsp*g->r8V;
+
+    // Avoid capturing sp
+    auto& particle_send = sp->k_pc_d;
+    auto& particle_send_i = sp->k_pc_i_d;
+    auto& movers = sp->k_pm_d;
+    auto& k_nm = sp->k_nm_d;
+    auto& particle_recv = sp->k_pr_d;
+    auto& particle_recv_i = sp->k_pr_i_d;
+    auto& pi_send = sp->k_pi_send_d;
+    auto& counts = sp->k_exchange_count_d;
+    auto& counts_h = sp->k_exchange_count_h;
+
+    // Begin receiving the particle counts
+
+    for( face=0; face<6; face++ )
+      if( shared[face] ) {
+        mp_size_recv_buffer( mp, f2b[face], sizeof(int) );
+        mp_begin_recv( mp, f2b[face], sizeof(int), bc[face], f2rb[face] );
+      }
+
+    // Absorb, pack for a neighbor or drop each mover
+
+    Kokkos::parallel_for("boundary_p_kokkos_device: reset counts",
+      Kokkos::RangePolicy<Kokkos::DefaultExecutionSpace>(0, 1),
+      KOKKOS_LAMBDA (const int) {
+        for( int c=0; c<EXCHANGE_KEPT; c++ ) counts(c) = 0;
+        counts(EXCHANGE_KEPT) = num_to_copy;
+      });
+
+    Kokkos::parallel_for("boundary_p_kokkos_device: pack",
+      Kokkos::RangePolicy<Kokkos::DefaultExecutionSpace>(0, nm),
+      KOKKOS_LAMBDA (const int n) {
+        int voxel = particle_send_i(n);
+        const int face = voxel & 7;
+        voxel >>= 3;
+        particle_send_i(n) = voxel;
+
+        const int64_t nn = k_neighbor( 6*voxel + face );
+
+        // Absorb
+        if( nn==absorb_particles ) {
+          Kokkos::atomic_increment( &counts(EXCHANGE_ABSORBED) );
+          k_accumulate_rhob_single( k_field, particle_send, particle_send_i, n,
+                                    q_8V, nx, ny, nz, sy, sz );
+          return;
+        }
+
+        // Send to a neighboring node
+        if( ((nn>=0) & (nn< rangel)) | ((nn>rangeh) & (nn<=rangem)) ) {
+          const int slot = face*max_nm + Kokkos::atomic_fetch_add( &counts(face), 1 );
+          particle_injector_t& pi = pi_send(slot);
+          pi.dx = particle_send(n, particle_var::dx);
+          pi.dy = particle_send(n, particle_var::dy);
+          pi.dz = particle_send(n, particle_var::dz);
+          pi.ux = particle_send(n, particle_var::ux);
+          pi.uy = particle_send(n, particle_var::uy);
+          pi.uz = particle_send(n, particle_var::uz);
+          pi.w  = particle_send(n, particle_var::w);
+          pi.dispx = movers(n, particle_mover_var::dispx);
+          pi.dispy = movers(n, particle_mover_var::dispy);
+          pi.dispz = movers(n, particle_mover_var::dispz);
+          (&pi.dx)[face_axis[face]] = face_dir[face];
+          pi.i     = nn - range[face];
+          pi.sp_id = sp_id;
+          return;
+        }
+
+        // Custom boundary conditions are not supported here either
+        Kokkos::atomic_increment( &counts(EXCHANGE_DROPPED) );
+      });
+
+    Kokkos::deep_copy( counts_h, counts );
+    for( face=0; face<6; face++ ) n_send[face] = counts_h(face);
+    if( counts_h(EXCHANGE_DROPPED) )
+      WARNING(( "Unknown boundary interaction ... dropping %i particles "
+                "(species=%s)", counts_h(EXCHANGE_DROPPED), sp->name ));
+
+    // Exchange the counts, then post the receives for the particles
+
+    for( face=0; face<6; face++ )
+      if( shared[face] ) {
+        *((int *)mp_send_buffer( mp, f2b[face] )) = n_send[face];
+        mp_begin_send( mp, f2b[face], sizeof(int), bc[face], f2b[face] );
+      }
+
+    int nr = 0;
+    for( face=0; face<6; face++ ) {
+      n_recv[face] = 0;
+      recv_offset[face] = nr;
+      if( shared[face] ) {
+        mp_end_recv( mp, f2b[face] );
+        n_recv[face] = *((int *)mp_recv_buffer( mp, f2b[face] ));
+        nr += n_recv[face];
+      }
+    }
+
+    sp->resize_exchange_recv( nr );
+    auto& pi_recv = sp->k_pi_recv_d;
+
+#ifdef VPIC_ENABLE_GPU_AWARE_MPI
+    particle_injector_t * send_buf = sp->k_pi_send_d.data();
+    particle_injector_t * recv_buf = sp->k_pi_recv_d.data();
+#else
+    particle_injector_t * send_buf = sp->k_pi_send_h.data();
+    particle_injector_t * recv_buf = sp->k_pi_recv_h.data();
+#endif
+
+    for( face=0; face<6; face++ )
+      if( n_recv[face] ) {
+        const int size = n_recv[face]*sizeof(particle_injector_t);
+        char * buf = (char *)(recv_buf + recv_offset[face]);
+        mp_set_recv_buffer( mp_k, f2b[face], size, buf );
+        mp_begin_recv_kokkos( mp_k, f2b[face], size, bc[face], f2rb[face], buf );
+      }
+
+    for( face=0; face<6; face++ )
+      if( shared[face] ) mp_end_send( mp, f2b[face] );
+
+    for( face=0; face<6; face++ )
+      if( shared[face] && n_send[face] ) {
+        const int size = n_send[face]*sizeof(particle_injector_t);
+        char * buf = (char *)(send_buf + face*max_nm);
+#ifndef VPIC_ENABLE_GPU_AWARE_MPI
+        const auto span = std::make_pair( face*max_nm, face*max_nm + n_send[face] );
+        Kokkos::deep_copy( Kokkos::subview( sp->k_pi_send_h, span ),
+                           Kokkos::subview( sp->k_pi_send_d, span ) );
+#endif
+        mp_set_send_buffer( mp_k, f2b[face], size, buf );
+        mp_begin_send_kokkos( mp_k, f2b[face], size, bc[face], f2b[face], buf );
+      }
+
+    for( face=0; face<6; face++ )
+      if( n_recv[face] ) {
+        mp_end_recv_kokkos( mp_k, f2b[face] );
+        mp_unset_recv_buffer( mp_k, f2b[face] );
+      }
+
+#ifndef VPIC_ENABLE_GPU_AWARE_MPI
+    Kokkos::deep_copy( Kokkos::subview( sp->k_pi_recv_d, std::make_pair(0, nr) ),
+                       Kokkos::subview( sp->k_pi_recv_h, std::make_pair(0, nr) ) );
+#endif
+
+    // Finish moving the received particles. The mover list is rebuilt from
+    // scratch with the ones that hit yet another boundary.
+
+    Kokkos::deep_copy( k_nm, 0 );
+
+    if( nr ) {
+      // The field array's scatter view is kept reset between uses, so it
+      // can be reused here instead of allocating one per species per round
+      k_field_sa_t k_f_sv = fa->k_field_sa_d;
+
+      Kokkos::parallel_for("boundary_p_kokkos_device: unpack",
+        Kokkos::RangePolicy<Kokkos::DefaultExecutionSpace>(0, nr),
+        KOKKOS_LAMBDA (const int n) {
+          using local_particle_t = Kokkos::View<float*[PARTICLE_VAR_COUNT],
+                Kokkos::LayoutRight, Kokkos::MemoryTraits<Kokkos::Unmanaged> >;
+          using local_particle_i_t = Kokkos::View<int*,
+                Kokkos::MemoryTraits<Kokkos::Unmanaged> >;
+
+          const particle_injector_t& pi = pi_recv(n);
+          float p[PARTICLE_VAR_COUNT];
+          int p_i = pi.i;
+          p[particle_var::dx] = pi.dx;
+          p[particle_var::dy] = pi.dy;
+          p[particle_var::dz] = pi.dz;
+          p[particle_var::ux] = pi.ux;
+          p[particle_var::uy] = pi.uy;
+          p[particle_var::uz] = pi.uz;
+          p[particle_var::w]  = pi.w;
+          local_particle_t local_p( p, 1 );
+          local_particle_i_t local_p_i( &p_i, 1 );
+
+          DECLARE_ALIGNED_ARRAY( particle_mover_t, 16, local_pm, 1 );
+          local_pm->dispx = pi.dispx;
+          local_pm->dispy = pi.dispy;
+          local_pm->dispz = pi.dispz;
+          local_pm->i     = 0;
+
+          if( move_p_kokkos( local_p, local_p_i, local_pm, k_f_sv, g,
+                             k_neighbor, rangel, rangeh, qsp, cx, cy, cz,
+                             nx, ny, nz ) ) {
+            // Mover for the next round
+            const int keep = Kokkos::atomic_fetch_add( &k_nm(0), 1 );
+            if( keep >= max_nm ) Kokkos::abort("overran max_nm");
+            movers(keep, particle_mover_var::dispx) = local_pm->dispx;
+            movers(keep, particle_mover_var::dispy) = local_pm->dispy;
+            movers(keep, particle_mover_var::dispz) = local_pm->dispz;
+            for( int v=0; v<PARTICLE_VAR_COUNT; v++ ) particle_send(keep, v) = p[v];
+            particle_send_i(keep) = p_i;
+          } else {
+            // Stays here, append after the compress
+            const int slot = Kokkos::atomic_fetch_add( &counts(EXCHANGE_KEPT), 1 );
+            if( slot >= max_nr ) Kokkos::abort("overran received particle buffer");
+            for( int v=0; v<PARTICLE_VAR_COUNT; v++ ) particle_recv(slot, v) = p[v];
+            particle_recv_i(slot) = p_i;
+          }
+        });
+
+      Kokkos::Experimental::contribute( k_field, k_f_sv );
+      k_f_sv.reset_except( k_field );
+    }
+
+    Kokkos::deep_copy( counts_h, counts );
+    sp->num_to_copy = counts_h(EXCHANGE_KEPT);
+    Kokkos::deep_copy( sp->nm, Kokkos::subview( k_nm, 0 ) );
+
+    for( face=0; face<6; face++ )
+      if( shared[face] && n_send[face] ) {
+        mp_end_send_kokkos( mp_k, f2b[face] );
+        mp_unset_send_buffer( mp_k, f2b[face] );
+      }
+  }
+}
+
 void
 boundary_p( particle_bc_t       * RESTRICT pbc_list,
             species_t           * RESTRICT sp_list,
@@ -34,6 +34,7 @@ new_collision_op_internal( void * params,
   cop->params     = params;
   cop->apply      = apply;
   cop->delete_cop = delete_cop;
+  cop->on_device  = 0;
   cop->next       = NULL; /* Set by append_collision_op */
   REGISTER_OBJECT( cop, checkpt, restore, reanimate );
   return cop;
@@ -47,6 +48,12 @@ delete_collision_op_internal( collision_op_t * cop ) {
 
 /* Public interface **********************************************************/
 
+collision_rng_pool_t *
+new_collision_rng_pool( rng_pool_t * RESTRICT rp ) {
+  if( !rp ) ERROR(( "Bad args" ));
+  return new collision_rng_pool_t( u64rand( rp->rng[0] ) );
+}
+
 int
 num_collision_op( const collision_op_t * RESTRICT cop_list ) {
   const collision_op_t * RESTRICT cop;
@@ -55,6 +62,14 @@ num_collision_op( const collision_op_t * RESTRICT cop_list ) {
   return n;
 }
 
+int
+num_host_collision_op( const collision_op_t * RESTRICT cop_list ) {
+  const collision_op_t * RESTRICT cop;
+  int n = 0;
+  LIST_FOR_EACH( cop, cop_list ) if( !cop->on_device ) n++;
+  return n;
+}
+
 void
 apply_collision_op_list( collision_op_t * cop_list ) {
   collision_op_t * cop;
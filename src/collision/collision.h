@@ -7,6 +7,9 @@
 
 #include "../species_advance/species_advance.h"
 
+#include <Kokkos_Random.hpp>
+#include <type_traits>
+
 #include <math.h>
 #ifndef M_PI
 # define M_PI 3.14159265358979323846
@@ -15,11 +18,29 @@
 struct collision_op;
 typedef struct collision_op collision_op_t;
 
+/* Device entropy used by the models that run on the Kokkos particle
+   arrays */
+
+typedef Kokkos::Random_XorShift64_Pool<> collision_rng_pool_t;
+
 /* In collision.c */
 
+/* Returns a new device entropy pool seeded from the host pool rp.  As
+   rp is seeded by seed_rng_pool, a run with the same seed_entropy gets
+   the same device pool. */
+
+collision_rng_pool_t *
+new_collision_rng_pool( rng_pool_t * RESTRICT rp );
+
 int
 num_collision_op( const collision_op_t * RESTRICT cop_list );
 
+/* Number of collision operators in the list that work on the legacy
+   host particle arrays */
+
+int
+num_host_collision_op( const collision_op_t * RESTRICT cop_list );
+
 void
 apply_collision_op_list( collision_op_t * RESTRICT cop_list );
 
@@ -48,7 +69,10 @@ append_collision_op( collision_op_t * cop,
    for the finite duration:
      sp->g->dt * interval
    every interval time step to all the particle momenta in the
-   species.  Above, dW is a basic Weiner process. */
+   species.  Above, dW is a basic Weiner process.
+
+   This operator runs on the device with the Kokkos particle arrays.
+   rp seeds its device entropy the first time it is applied. */
 
 collision_op_t *
 langevin( float                 kT,
@@ -126,6 +150,97 @@ unary_collision_model( const char       * RESTRICT name,
                        /**/  rng_pool_t * RESTRICT rp,
                        int                         interval );
 
+/* Kokkos version of unary_collision_model.  The microscopic physics
+   is given by a model class instead of function pointers so that it is
+   inlined in the device kernel:
+
+     struct my_model {
+       float n0, ...;   // Parameters, set on the host
+
+       // Rate constant (FREQUENCY) for a particle of momentum u{xyz}
+       KOKKOS_INLINE_FUNCTION float
+       rate_constant( float ux, float uy, float uz ) const;
+
+       // Final momentum of a particle that collided
+       template<class generator_t>
+       KOKKOS_INLINE_FUNCTION void
+       collide( float & ux, float & uy, float & uz,
+                generator_t & rng ) const;
+     };
+
+     define_collision_op( unary_collision_model_kokkos( "name", my_model{...},
+                                                        sp, entropy, 1 ) );
+
+   The model is copied into the operator (and the checkpoint), so it
+   must be trivially copyable.  rng is a Kokkos random generator (see
+   Kokkos_Random.hpp, e.g. rng.frand() and rng.normal()). */
+
+typedef int
+(*unary_collision_kokkos_kernel_t)( const void           * RESTRICT model,
+                                    /**/  species_t      * RESTRICT sp,
+                                    collision_rng_pool_t & pool,
+                                    float dt );
+
+collision_op_t *
+unary_collision_kokkos_op( const char       * RESTRICT name,
+                           unary_collision_kokkos_kernel_t kernel,
+                           const void       * RESTRICT model,
+                           size_t                      model_size,
+                           /**/  species_t  * RESTRICT sp,
+                           /**/  rng_pool_t * RESTRICT rp,
+                           int                         interval );
+
+/* Tests every particle of sp for collision over the time dt.  Returns
+   the number of particles whose collision probability exceeded one. */
+
+template<class model_t>
+int
+unary_collision_kokkos_kernel( const void           * RESTRICT model_v,
+                               /**/  species_t      * RESTRICT sp,
+                               collision_rng_pool_t & pool,
+                               float dt ) {
+  const model_t model = *(const model_t *)model_v;
+  const k_particles_t p = sp->k_p_d;
+  int n_large_pr = 0;
+
+  Kokkos::parallel_reduce( "unary_collision_model_kokkos",
+                           Kokkos::RangePolicy<>(0, sp->np),
+  KOKKOS_LAMBDA( const int i, int & n_large ) {
+    float ux = p(i,particle_var::ux);
+    float uy = p(i,particle_var::uy);
+    float uz = p(i,particle_var::uz);
+    const float pr_coll = dt*model.rate_constant( ux, uy, uz );
+    if( pr_coll>1 ) n_large++;
+
+    /* Strictly < so that 0 rate constants guarantee no collision */
+    auto rng = pool.get_state();
+    if( rng.frand()<pr_coll ) {
+      model.collide( ux, uy, uz, rng );
+      p(i,particle_var::ux) = ux;
+      p(i,particle_var::uy) = uy;
+      p(i,particle_var::uz) = uz;
+    }
+    pool.free_state( rng );
+  }, n_large_pr );
+
+  return n_large_pr;
+}
+
+template<class model_t>
+collision_op_t *
+unary_collision_model_kokkos( const char       * RESTRICT name,
+                              const model_t             & model,
+                              /**/  species_t  * RESTRICT sp,
+                              /**/  rng_pool_t * RESTRICT rp,
+                              int                         interval ) {
+  static_assert( std::is_trivially_copyable<model_t>::value,
+                 "collision models are checkpointed as raw bytes" );
+  return unary_collision_kokkos_op( name,
+                                    unary_collision_kokkos_kernel<model_t>,
+                                    &model, sizeof(model_t),
+                                    sp, rp, interval );
+}
+
 /* In binary.c */
 
 /* A binary_rate_constant_func_t returns the lab-frame rate constant
@@ -303,4 +418,28 @@ large_angle_coulomb( const char * RESTRICT name, /* Model name */
                      const double sample,        /* Sampling density */
                      const int interval );       /* How often to apply this */
 
+/* In takizuka_abe.cc */
+
+/* Binary Coulomb collisions between species spi and spj (which may be
+   the same species) with the Takizuka and Abe model (JCP 25, 205,
+   1977).  Every interval steps, the particles in each voxel are paired
+   at random and each pair is scattered through a small angle with
+   tan^2(theta/2) of variance
+
+     qi^2 qj^2 n lnL dt / ( 8 pi eps0^2 mu^2 vr^3 )
+
+   where n is the density of the voxel (for two species, the lower of
+   their two densities), lnL the Coulomb logarithm,
+   mu the reduced mass and vr the relative velocity.  The model is
+   non-relativistic.  Unlike the models above, it runs on the device
+   with the Kokkos particle arrays; rp only seeds its device entropy. */
+
+collision_op_t *
+takizuka_abe( const char * RESTRICT name, /* Model name */
+              species_t  * RESTRICT spi,  /* Species-i */
+              species_t  * RESTRICT spj,  /* Species-j */
+              rng_pool_t * RESTRICT rp,   /* Entropy pool */
+              float coulomb_log,          /* Coulomb logarithm */
+              int interval );             /* How often to apply this */
+
 #endif /* _collision_h_ */
@@ -17,6 +17,7 @@ struct collision_op {
   void * params;
   collision_op_func_t apply;
   delete_collision_op_func_t delete_cop;
+  int on_device;       /* Works on the Kokkos particle arrays */
   collision_op_t * next;
 };
 
@@ -37,18 +38,4 @@ new_collision_op_internal( void * params,
 void
 delete_collision_op_internal( collision_op_t * cop );
 
-///////////////////////////////////////////////////////////////////////////////
-// Langevin pipeline interface
-
-typedef struct langevin_pipeline_args {
-  MEM_PTR( particle_t, 128 ) p;
-  MEM_PTR( rng_t,      128 ) rng[ MAX_PIPELINE ];
-  float decay; 
-  float drive;
-  int np;
-  PAD_STRUCT( (1+MAX_PIPELINE)*SIZEOF_MEM_PTR+2*sizeof(float)+sizeof(int) )
-} langevin_pipeline_args_t;
-
-PROTOTYPE_PIPELINE( langevin, langevin_pipeline_args_t );
-
 #endif /* _collision_h_ */
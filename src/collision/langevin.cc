@@ -9,36 +9,9 @@ typedef struct langevin {
   float kT;
   float nu;
   int interval;
+  collision_rng_pool_t * pool; /* Device entropy, seeded from rp on first use */
 } langevin_t;
 
-void
-langevin_pipeline( langevin_pipeline_args_t * RESTRICT args,
-                   int pipeline_rank,
-                   int n_pipeline ) {
-  if( pipeline_rank==n_pipeline ) return; /* No host straggler cleanup */
-
-  particle_t * RESTRICT p     = args->p;
-  rng_t      * RESTRICT rng   = args->rng[ pipeline_rank ];
-  float                 decay = args->decay;
-  float                 drive = args->drive;
-
-  double n_target = (double)args->np / (double)n_pipeline;
-  /**/  int i  = (int)( 0.5 + n_target*(double) pipeline_rank    );
-  const int i1 = (int)( 0.5 + n_target*(double)(pipeline_rank+1) );
-
-  for( ; i<i1; i++ ) {
-    p[i].ux = decay*p[i].ux + drive*frandn(rng);
-    p[i].uy = decay*p[i].uy + drive*frandn(rng);
-    p[i].uz = decay*p[i].uz + drive*frandn(rng);
-  }
-}
-
-#if defined(V4_ACCELERATION) && defined(HAS_V4_PIPELINE)
-
-#error "V4 pipeline not implemented"
-
-#endif
-
 void
 apply_langevin( langevin_t * l ) {
   if( l->interval<1 || (l->sp->g->step % l->interval) ) return;
@@ -87,14 +60,21 @@ apply_langevin( langevin_t * l ) {
      desired temperature. */
 
   float nudt  = l->nu * (float)l->interval * l->sp->g->dt;
-  DECLARE_ALIGNED_ARRAY( langevin_pipeline_args_t, 128, args, 1 );
-  args->p     = l->sp->p;
-  COPY( args->rng, l->rp->rng, N_PIPELINE );
-  args->decay = exp( -nudt );
-  args->drive = sqrt(( -expm1(-2*nudt)*l->kT )/( l->sp->m*l->sp->g->cvac ));
-  args->np    = l->sp->np;
-  EXEC_PIPELINES( langevin, args, 0 );
-  WAIT_PIPELINES();
+  const float decay = exp( -nudt );
+  const float drive = sqrt(( -expm1(-2*nudt)*l->kT )/( l->sp->m*l->sp->g->cvac ));
+
+  if( !l->pool ) l->pool = new_collision_rng_pool( l->rp );
+  collision_rng_pool_t pool = *l->pool;
+  const k_particles_t p = l->sp->k_p_d;
+
+  Kokkos::parallel_for( "langevin", Kokkos::RangePolicy<>(0, l->sp->np),
+  KOKKOS_LAMBDA( const int i ) {
+    auto rng = pool.get_state();
+    p(i,particle_var::ux) = decay*p(i,particle_var::ux) + drive*(float)rng.normal();
+    p(i,particle_var::uy) = decay*p(i,particle_var::uy) + drive*(float)rng.normal();
+    p(i,particle_var::uz) = decay*p(i,particle_var::uz) + drive*(float)rng.normal();
+    pool.free_state( rng );
+  });
 }
 
 void
@@ -112,12 +92,15 @@ restore_langevin( void ) {
   RESTORE( l );
   RESTORE_PTR( l->sp );
   RESTORE_PTR( l->rp );
+  l->pool = NULL; /* Reseeded from the restored rp */
   return restore_collision_op_internal( l );
 }
 
 void
 delete_langevin( collision_op_t * cop ) {
-  FREE( cop->params );
+  langevin_t * l = (langevin_t *)cop->params;
+  delete l->pool;
+  FREE( l );
   delete_collision_op_internal( cop );
 }
 
@@ -130,8 +113,9 @@ langevin( float                 kT,
           rng_pool_t * RESTRICT rp,
           int                   interval ) {
   langevin_t * l;
+  collision_op_t * cop;
 
-  if( !sp || !rp || rp->n_rng<N_PIPELINE || kT<0 || nu<0 )
+  if( !sp || !rp || kT<0 || nu<0 )
     ERROR(( "Bad args" ));
 
   MALLOC( l, 1 );
@@ -140,11 +124,14 @@ langevin( float                 kT,
   l->kT       = kT;
   l->nu       = nu;
   l->interval = interval;
-  return new_collision_op_internal( l,
-                                    (collision_op_func_t)apply_langevin,
-                                    delete_langevin,
-                                    (checkpt_func_t)checkpt_langevin,
-                                    (restore_func_t)restore_langevin,
-                                    NULL );
+  l->pool     = NULL;
+  cop = new_collision_op_internal( l,
+                                   (collision_op_func_t)apply_langevin,
+                                   delete_langevin,
+                                   (checkpt_func_t)checkpt_langevin,
+                                   (restore_func_t)restore_langevin,
+                                   NULL );
+  cop->on_device = 1;
+  return cop;
 }
 
@@ -0,0 +1,301 @@
+#define IN_collision
+#include "collision_private.h"
+#include "../particle_operations/sort.h"
+
+/* Private interface *********************************************************/
+
+typedef Kokkos::View<int*,
+                     Kokkos::DefaultExecutionSpace::scratch_memory_space,
+                     Kokkos::MemoryTraits<Kokkos::Unmanaged> > takizuka_abe_perm_t;
+
+typedef struct takizuka_abe_model {
+  char * name;
+  species_t  * spi;
+  species_t  * spj;
+  rng_pool_t * rp;
+  float var0;     /* <delta^2> |u|^3 per unit weight in the voxel */
+  float fi, fj;   /* Share of the momentum change taken by i and j */
+  int interval;
+  collision_rng_pool_t * pool; /* Device entropy, seeded from rp on first use */
+} takizuka_abe_model_t;
+
+/* Scatter particle k of pk off particle l of pl.  This is the
+   SCATTER_PARTICLES kernel of the open-collisional deck: the relative
+   momentum u = uk - ul is rotated by theta, with tan(theta/2) = delta
+   drawn from a normal distribution of variance sqrt_var^2 / |u|^3, and
+   phi uniform on [0,2pi). */
+
+template<class generator_t>
+KOKKOS_INLINE_FUNCTION void
+takizuka_abe_scatter( const k_particles_t & pk, const int k, const float fk,
+                      const k_particles_t & pl, const int l, const float fl,
+                      const float sqrt_var,
+                      generator_t & gen ) {
+  const float ux = pk(k,particle_var::ux) - pl(l,particle_var::ux);
+  const float uy = pk(k,particle_var::uy) - pl(l,particle_var::uy);
+  const float uz = pk(k,particle_var::uz) - pl(l,particle_var::uz);
+  const float uperp2 = ux*ux + uy*uy;
+  const float u2     = uperp2 + uz*uz;
+  if( u2==0 ) return; /* Comoving, nothing to scatter */
+
+  const float uperp = sqrtf( uperp2 );
+  const float u     = sqrtf( u2 );
+  const float delta = sqrt_var*(float)gen.normal() / ( u*sqrtf( u ) );
+  const float sin_theta       = 2*delta / ( 1 + delta*delta );
+  const float one_m_cos_theta = sin_theta*delta;
+  const float phi     = 2*float(M_PI)*gen.frand();
+  const float sin_phi = sinf( phi );
+  const float cos_phi = cosf( phi );
+
+  float dux, duy, duz;
+  if( uperp>0 ) {
+    dux = ( ux*uz*sin_theta*cos_phi - uy*u*sin_theta*sin_phi )/uperp
+        - ux*one_m_cos_theta;
+    duy = ( uy*uz*sin_theta*cos_phi + ux*u*sin_theta*sin_phi )/uperp
+        - uy*one_m_cos_theta;
+    duz = -uperp*sin_theta*cos_phi - uz*one_m_cos_theta;
+  } else { /* Purely z-directed relative momentum */
+    dux =  u*sin_theta*cos_phi;
+    duy =  u*sin_theta*sin_phi;
+    duz = -u*one_m_cos_theta;
+  }
+
+  pk(k,particle_var::ux) += fk*dux;
+  pk(k,particle_var::uy) += fk*duy;
+  pk(k,particle_var::uz) += fk*duz;
+  pl(l,particle_var::ux) -= fl*dux;
+  pl(l,particle_var::uy) -= fl*duy;
+  pl(l,particle_var::uz) -= fl*duz;
+}
+
+/* Fisher-Yates shuffle of the particles listed in slots [k0,k1) of a
+   cell table (see species_t::k_partition_d) */
+
+template<class generator_t>
+KOKKOS_INLINE_FUNCTION void
+takizuka_abe_shuffle( const takizuka_abe_perm_t & perm,
+                      const Kokkos::View<int*> & slot,
+                      const int k0, const int k1, generator_t & gen ) {
+  int n = 0;
+  for( int k=k0; k<k1; k++ ) if( slot(k)>=0 ) perm(n++) = slot(k);
+  for( int i=n-1; i>0; i-- ) {
+    const int j = (int)gen.urand( i+1 );
+    const int t = perm(i); perm(i) = perm(j); perm(j) = t;
+  }
+}
+
+void
+apply_takizuka_abe( takizuka_abe_model_t * cm ) {
+  species_t * spi = cm->spi;
+  species_t * spj = cm->spj;
+  const grid_t * g = spi->g;
+  if( cm->interval<1 || (g->step % cm->interval) ) return;
+
+  if( !cm->pool )
+    cm->pool = new_collision_rng_pool( cm->rp );
+
+  /* Pairing is done within voxels, so the particles must be grouped by
+     voxel in the cell tables. */
+
+  ParticleSorter<> sorter;
+  sorter.partition( spi, g->nv );
+  if( spj!=spi ) sorter.partition( spj, g->nv );
+
+  const int nv      = g->nv;
+  const bool intra  = spi==spj;
+  const float var0  = cm->var0;
+  const float fi    = cm->fi;
+  const float fj    = cm->fj;
+  const k_particles_t pi = spi->k_p_d;
+  const k_particles_t pj = spj->k_p_d;
+  const Kokkos::View<int*> parti = spi->k_partition_d;
+  const Kokkos::View<int*> partj = spj->k_partition_d;
+  const Kokkos::View<int*> sloti = spi->k_cell_slot_d;
+  const Kokkos::View<int*> slotj = spj->k_cell_slot_d;
+  const Kokkos::View<int*> counti = spi->k_cell_count_d;
+  const Kokkos::View<int*> countj = spj->k_cell_count_d;
+  collision_rng_pool_t pool = *cm->pool;
+
+  /* The most populated voxel sizes the per team shuffle scratch */
+
+  int max_n = 0;
+  Kokkos::parallel_reduce( "takizuka_abe max ppc", Kokkos::RangePolicy<>(0, nv),
+  KOKKOS_LAMBDA( const int v, int & m ) {
+    const int n = counti(v) + ( intra ? 0 : countj(v) );
+    if( n>m ) m = n;
+  }, Kokkos::Max<int>( max_n ) );
+  if( max_n<2 ) return;
+
+  const size_t scratch = takizuka_abe_perm_t::shmem_size( max_n );
+  Kokkos::TeamPolicy<> policy( nv, Kokkos::AUTO );
+  policy.set_scratch_size( 0, Kokkos::PerTeam( scratch ) );
+
+  /* One team per voxel.  The team shuffles the voxel's particles, then
+     scatters disjoint groups of them in parallel. */
+
+  Kokkos::parallel_for( "takizuka_abe", policy,
+  KOKKOS_LAMBDA( const KOKKOS_TEAM_POLICY_DEVICE::member_type & team ) {
+    const int v  = team.league_rank();
+    const int nk = counti(v);
+    const int nl = intra ? nk : countj(v);
+    if( intra ? nk<2 : ( nk==0 || nl==0 ) ) return;
+
+    takizuka_abe_perm_t perm( team.team_scratch(0), intra ? nk : nk+nl );
+    Kokkos::single( Kokkos::PerTeam( team ), [&] () {
+      auto gen = pool.get_state();
+      takizuka_abe_shuffle( perm, sloti, parti(v), parti(v+1), gen );
+      if( !intra ) {
+        takizuka_abe_perm_t perm_l( &perm(nk), nl );
+        takizuka_abe_shuffle( perm_l, slotj, partj(v), partj(v+1), gen );
+      }
+      pool.free_state( gen );
+    } );
+    team.team_barrier();
+
+    if( intra ) {
+
+      /* Particles are paired off in shuffled order.  With an odd count,
+         the last three collide pairwise at half the variance. */
+
+      float wk = 0;
+      Kokkos::parallel_reduce( Kokkos::TeamThreadRange( team, nk ),
+      [&] ( const int n, float & s ) { s += pi(perm(n),particle_var::w); }, wk );
+      const float sqrt_var = sqrtf( var0*wk );
+      const int   n_pair   = nk/2 - (nk&1);
+
+      Kokkos::parallel_for( Kokkos::TeamThreadRange( team, n_pair + (nk&1) ),
+      [&] ( const int p ) {
+        auto gen = pool.get_state();
+        if( p<n_pair ) {
+          takizuka_abe_scatter( pi, perm(2*p), fi, pi, perm(2*p+1), fj,
+                                sqrt_var, gen );
+        } else {
+          const float sqrt_half_var = sqrt_var*float(M_SQRT1_2);
+          const int a = perm(nk-3), b = perm(nk-2), c = perm(nk-1);
+          takizuka_abe_scatter( pi, a, fi, pi, b, fj, sqrt_half_var, gen );
+          takizuka_abe_scatter( pi, a, fi, pi, c, fj, sqrt_half_var, gen );
+          takizuka_abe_scatter( pi, b, fi, pi, c, fj, sqrt_half_var, gen );
+        }
+        pool.free_state( gen );
+      } );
+
+    } else {
+
+      /* Each particle of the less populated species collides with ii or
+         ii+1 particles of the other, each of which collides once.  As in
+         Takizuka and Abe, every collision uses the lower of the two
+         densities, so a particle of either species is scattered at the
+         rate set by the density of the other. */
+
+      const bool i_big = nk>=nl;
+      const int  nb = i_big ? nk : nl, ns = i_big ? nl : nk;
+      const int  b0 = i_big ? 0  : nk, s0 = i_big ? nk : 0;
+      const k_particles_t & pb = i_big ? pi : pj;
+      const k_particles_t & ps = i_big ? pj : pi;
+      const float fb = i_big ? fi : fj, fs = i_big ? fj : fi;
+
+      float wb = 0, ws = 0;
+      Kokkos::parallel_reduce( Kokkos::TeamThreadRange( team, nb ),
+      [&] ( const int n, float & s ) { s += pb(perm(b0+n),particle_var::w); }, wb );
+      Kokkos::parallel_reduce( Kokkos::TeamThreadRange( team, ns ),
+      [&] ( const int n, float & s ) { s += ps(perm(s0+n),particle_var::w); }, ws );
+      const float sqrt_var = sqrtf( var0*( wb<ws ? wb : ws ) );
+      const int ii = nb/ns, r = nb - ns*ii;
+
+      Kokkos::parallel_for( Kokkos::TeamThreadRange( team, ns ),
+      [&] ( const int s ) {
+        auto gen = pool.get_state();
+        const int m     = s<r ? ii+1 : ii;
+        const int first = s<r ? s*(ii+1) : r*(ii+1) + (s-r)*ii;
+        const int l = perm(s0+s);
+        for( int n=first; n<first+m; n++ ) {
+          /* Keep the (i,j) order of the momentum change */
+          if( i_big ) takizuka_abe_scatter( pb, perm(b0+n), fb, ps, l, fs,
+                                            sqrt_var, gen );
+          else        takizuka_abe_scatter( ps, l, fs, pb, perm(b0+n), fb,
+                                            sqrt_var, gen );
+        }
+        pool.free_state( gen );
+      } );
+
+    }
+  } );
+}
+
+void
+checkpt_takizuka_abe( const collision_op_t * cop ) {
+  const takizuka_abe_model_t * cm =
+    (const takizuka_abe_model_t *)cop->params;
+  CHECKPT( cm, 1 );
+  CHECKPT_STR( cm->name );
+  CHECKPT_PTR( cm->spi );
+  CHECKPT_PTR( cm->spj );
+  CHECKPT_PTR( cm->rp );
+  checkpt_collision_op_internal( cop );
+}
+
+collision_op_t *
+restore_takizuka_abe( void ) {
+  takizuka_abe_model_t * cm;
+  RESTORE( cm );
+  RESTORE_STR( cm->name );
+  RESTORE_PTR( cm->spi );
+  RESTORE_PTR( cm->spj );
+  RESTORE_PTR( cm->rp );
+  cm->pool = NULL; /* Reseeded from the restored rp */
+  return restore_collision_op_internal( cm );
+}
+
+void
+delete_takizuka_abe( collision_op_t * cop ) {
+  takizuka_abe_model_t * cm = (takizuka_abe_model_t *)cop->params;
+  delete cm->pool;
+  FREE( cm->name );
+  FREE( cm );
+  delete_collision_op_internal( cop );
+}
+
+/* Public interface **********************************************************/
+
+collision_op_t *
+takizuka_abe( const char * RESTRICT name,
+              species_t  * RESTRICT spi,
+              species_t  * RESTRICT spj,
+              rng_pool_t * RESTRICT rp,
+              float                 coulomb_log,
+              int                   interval ) {
+  takizuka_abe_model_t * cm;
+  collision_op_t * cop;
+  size_t len = name ? strlen(name) : 0;
+
+  if( !spi || !spi->q || spi->m<=0 || !spj || !spj->q || spj->m<=0 ||
+      spi->g!=spj->g || !rp || coulomb_log<=0 ) ERROR(( "Bad args" ));
+  if( len==0 ) ERROR(( "Cannot specify a nameless collision model" ));
+
+  const grid_t * g = spi->g;
+  const double mu  = (double)spi->m*(double)spj->m / ((double)spi->m + (double)spj->m);
+  const double qq  = (double)spi->q*(double)spj->q;
+  const double c   = g->cvac;
+
+  MALLOC( cm, 1 );
+  MALLOC( cm->name, len+1 );
+  strcpy( cm->name, name );
+  cm->spi      = spi;
+  cm->spj      = spj;
+  cm->rp       = rp;
+  cm->var0     = ( qq*qq*coulomb_log*g->dt*interval ) /
+                 ( 8*M_PI*g->eps0*g->eps0*mu*mu*c*c*c*g->dV );
+  cm->fi       = spj->m / ( spi->m + spj->m );
+  cm->fj       = spi->m / ( spi->m + spj->m );
+  cm->interval = interval;
+  cm->pool     = NULL;
+
+  cop = new_collision_op_internal( cm,
+                                   (collision_op_func_t)apply_takizuka_abe,
+                                   delete_takizuka_abe,
+                                   (checkpt_func_t)checkpt_takizuka_abe,
+                                   (restore_func_t)restore_takizuka_abe,
+                                   NULL );
+  cop->on_device = 1;
+  return cop;
+}
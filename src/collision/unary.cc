@@ -105,6 +105,71 @@ delete_unary_collision_model( collision_op_t * cop ) {
   delete_collision_op_internal( cop );
 }
 
+/* Kokkos unary collision model.  The model object is kept as raw bytes
+   next to the (template instantiated) kernel that knows its type. */
+
+typedef struct unary_collision_kokkos {
+  char * name;
+  unary_collision_kokkos_kernel_t kernel;
+  char * model;
+  size_t model_size;
+  species_t * sp;
+  rng_pool_t * rp;
+  int interval;
+  collision_rng_pool_t * pool; /* Device entropy, seeded from rp on first use */
+} unary_collision_kokkos_t;
+
+void
+apply_unary_collision_kokkos( unary_collision_kokkos_t * cm ) {
+  int n_large_pr;
+  if( cm->interval<1 || (cm->sp->g->step % cm->interval) ) return;
+  if( !cm->pool ) cm->pool = new_collision_rng_pool( cm->rp );
+  n_large_pr = cm->kernel( cm->model, cm->sp, *cm->pool,
+                           cm->sp->g->dt * (float)cm->interval );
+  if( n_large_pr )
+    WARNING(( "%i particles in species \"%s\" encountered a large collision "
+              "probability in collision model \"%s\".  The collision rate for "
+              "such particles will be lower than it should be physically.  "
+              "Consider lowering the collision operator interval or reducing "
+              "the timestep.", n_large_pr, cm->sp->name, cm->name ));
+}
+
+void
+checkpt_unary_collision_kokkos( const collision_op_t * cop ) {
+  const unary_collision_kokkos_t * cm =
+    (const unary_collision_kokkos_t *)cop->params;
+  CHECKPT( cm, 1 );
+  CHECKPT_STR( cm->name );
+  CHECKPT_SYM( cm->kernel );
+  CHECKPT( cm->model, cm->model_size );
+  CHECKPT_PTR( cm->sp );
+  CHECKPT_PTR( cm->rp );
+  checkpt_collision_op_internal( cop );
+}
+
+collision_op_t *
+restore_unary_collision_kokkos( void ) {
+  unary_collision_kokkos_t * cm;
+  RESTORE( cm );
+  RESTORE_STR( cm->name );
+  RESTORE_SYM( cm->kernel );
+  RESTORE( cm->model );
+  RESTORE_PTR( cm->sp );
+  RESTORE_PTR( cm->rp );
+  cm->pool = NULL; /* Reseeded from the restored rp */
+  return restore_collision_op_internal( cm );
+}
+
+void
+delete_unary_collision_kokkos( collision_op_t * cop ) {
+  unary_collision_kokkos_t * cm = (unary_collision_kokkos_t *)cop->params;
+  delete cm->pool;
+  FREE( cm->model );
+  FREE( cm->name );
+  FREE( cm );
+  delete_collision_op_internal( cop );
+}
+
 /* Public interface **********************************************************/
 
 collision_op_t *
@@ -141,3 +206,38 @@ unary_collision_model( const char       * RESTRICT name,
                                     NULL );
 }
 
+collision_op_t *
+unary_collision_kokkos_op( const char       * RESTRICT name,
+                           unary_collision_kokkos_kernel_t kernel,
+                           const void       * RESTRICT model,
+                           size_t                      model_size,
+                           /**/  species_t  * RESTRICT sp,
+                           /**/  rng_pool_t * RESTRICT rp,
+                           int                         interval ) {
+  unary_collision_kokkos_t * cm;
+  collision_op_t * cop;
+  size_t len = name ? strlen(name) : 0;
+
+  if( !kernel || !model || !model_size || !sp || !rp ) ERROR(( "Bad args" ));
+  if( !len ) ERROR(( "Cannot specify a nameless collision model" ));
+
+  MALLOC( cm, 1 );
+  MALLOC( cm->name, len+1 );
+  strcpy( cm->name, name );
+  MALLOC( cm->model, model_size );
+  memcpy( cm->model, model, model_size );
+  cm->kernel     = kernel;
+  cm->model_size = model_size;
+  cm->sp         = sp;
+  cm->rp         = rp;
+  cm->interval   = interval;
+  cm->pool       = NULL;
+  cop = new_collision_op_internal( cm,
+                                   (collision_op_func_t)apply_unary_collision_kokkos,
+                                   delete_unary_collision_kokkos,
+                                   (checkpt_func_t)checkpt_unary_collision_kokkos,
+                                   (restore_func_t)restore_unary_collision_kokkos,
+                                   NULL );
+  cop->on_device = 1;
+  return cop;
+}
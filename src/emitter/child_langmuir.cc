@@ -16,6 +16,9 @@ typedef struct child_langmuir {
   float ut_perp;
   float thresh_e_norm;
   float norm;
+  k_emitter_component_t * k_face;   // Emitting faces, built on first use
+  k_emitter_component_t * k_offset; // First particle of each face
+  emitter_rng_pool_t    * pool;     // Seeded from rng on first use
 } child_langmuir_t;
 
 // Notes:
@@ -30,26 +33,34 @@ typedef struct child_langmuir {
 //   See maxwellian_reflux for a derivation how this works.
 // - Particles are randomly distributed across the inject surface
 //   and have random ages.
+// - A scan over the faces first places the particles of each emitting
+//   face in a contiguous block after sp->np, then one thread per
+//   particle emits, deposits rhob and ages it with the device mover.
+//   Aged particles that hit a boundary join the movers of advance_p.
 
 void
 emit_child_langmuir( child_langmuir_t * RESTRICT              cl,
                      const int        * RESTRICT ALIGNED(128) component,
                      int                                      n_component ) {
-  /**/  species_t        * RESTRICT              sp  = cl->sp;
-  const interpolator_t   * RESTRICT ALIGNED(128) fi  = cl->ia->i;
-  /**/  field_t          * RESTRICT ALIGNED(128) f   = cl->fa->f;
-  /**/  accumulator_t    * RESTRICT ALIGNED(128) a   = cl->aa->a;
-  /**/  rng_t            * RESTRICT              rng = cl->rng;
+  /**/  species_t * RESTRICT sp = cl->sp;
+  /**/  grid_t    * RESTRICT g  = sp->g;
 
-  /**/  particle_t       * RESTRICT ALIGNED(128) p   = sp->p;
-  /**/  particle_mover_t * RESTRICT ALIGNED(128) pm  = sp->pm;
-  /**/  grid_t           * RESTRICT              g   = sp->g;
+  if( !cl->k_face ) {
+    cl->k_face   = new_emitter_face_list( component, n_component );
+    cl->k_offset = new k_emitter_component_t( "child_langmuir_offset",
+                                              cl->k_face->extent(0) );
+  }
+  if( !cl->pool ) cl->pool = new emitter_rng_pool_t( u64rand( cl->rng ) );
+
+  const int n_face = cl->k_face->extent(0);
+  if( !n_face ) return;
 
-  const int max_np           = sp->max_np;
+  const int np               = sp->np;
   const int max_nm           = sp->max_nm;
   const int np_emit_per_face = cl->n_emit_per_face;
 
   const float qsp     = sp->q;
+  const float q_8V    = -qsp*g->r8V;
   const float rdx     = g->rdx;
   const float rdy     = g->rdy;
   const float rdz     = g->rdz;
@@ -63,81 +74,140 @@ emit_child_langmuir( child_langmuir_t * RESTRICT              cl,
   const float ut_perp = cl->ut_perp;
   const float thresh  = fabsf(qsp)*cl->thresh_e_norm;
 
-  int np = sp->np, np_skipped = 0;
-  int nm = sp->nm, nm_skipped = 0;
-
-  float w, ux, uy, uz;
-  int c, cc, i, np_emit;
-
-  // Loop over all components of the region
-
-  for( c=0; c<n_component; c++ ) {
-    cc = component[c];
-    i  = EXTRACT_LOCAL_CELL( cc );
-
-    // FIXME: COULD PROBABLY ACCELERATE BY GETTING RID OF SWITCH (USE
-    // MAXWELLIAN_REFLUX TRICKS?)
-
-#   define EMIT_PARTICLES(X,Y,Z,dir)                                    \
-    w = fi[i].e##X;                                                     \
-    if( dir qsp*w > thresh ) { /* This face can emit */                 \
-      w = norm_##X*sqrtf(fabsf(w*w*w));                                 \
-      for( np_emit=np_emit_per_face; np_emit; np_emit-- ) {             \
-                                                                        \
-        /* Emit the particle */                                         \
-                                                                        \
-        if( np>=max_np ) { np_skipped++; continue; }                    \
-        u##X = dir ut_para*sqrtf(2*frande(rng));                        \
-        u##Y = ut_perp*frandn(rng);                                     \
-        u##Z = ut_perp*frandn(rng);                                     \
-        p[np].d##X = -(dir 1);                                          \
-        p[np].d##Y = 2*frand_c0(rng)-1;                                 \
-        p[np].d##Z = 2*frand_c0(rng)-1;                                 \
-        p[np].i    = i;                                                 \
-        p[np].u##X = u##X;                                              \
-        p[np].u##Y = u##Y;                                              \
-        p[np].u##Z = u##Z;                                              \
-        p[np].w    = w;                                                 \
-        accumulate_rhob( f, p+np, g, -qsp );                            \
-        np++;                                                           \
-                                                                        \
-        /* Age the particle */                                          \
-                                                                        \
-        if( nm>=max_nm ) { nm_skipped++; continue; }                    \
-        w = ( frand_c0(rng)*cdt ) /                                     \
-          sqrtf( ( u##X*u##X + u##Y*u##Y ) + ( u##Z*u##Z + 1 ) );       \
-        DECLARE_ALIGNED_ARRAY( particle_mover_t, 16, local_pm, 1 );     \
-        local_pm->disp##X = w*u##X*rd##X;                               \
-        local_pm->disp##Y = w*u##Y*rd##Y;                               \
-        local_pm->disp##Z = w*u##Z*rd##Z;                               \
-        local_pm->i       = np-1;                                       \
-        if (move_p( p, local_pm, cl->fa->k_jf_accum_h, g, qsp )) {                         \
-            pm[nm++] = local_pm[0];                                     \
-        }                                                               \
-      }                                                                 \
-    }
+  const int64_t rangel = g->rangel;
+  const int64_t rangeh = g->rangeh;
+  const int nx = g->nx, ny = g->ny, nz = g->nz;
+  const int sy = g->sy, sz = g->sz;
+  const float cx = 0.25 * g->rdy * g->rdz / g->dt;
+  const float cy = 0.25 * g->rdz * g->rdx / g->dt;
+  const float cz = 0.25 * g->rdx * g->rdy / g->dt;
 
-    switch( EXTRACT_COMPONENT_TYPE( cc ) ) {
-    case BOUNDARY(-1, 0, 0): EMIT_PARTICLES(x,y,z,+) break;
-    case BOUNDARY( 0,-1, 0): EMIT_PARTICLES(y,z,x,+) break;
-    case BOUNDARY( 0, 0,-1): EMIT_PARTICLES(z,x,y,+) break;
-    case BOUNDARY( 1, 0, 0): EMIT_PARTICLES(x,y,z,-) break;
-    case BOUNDARY( 0, 1, 0): EMIT_PARTICLES(y,z,x,-) break;
-    case BOUNDARY( 0, 0, 1): EMIT_PARTICLES(z,x,y,-) break;
-    default: /* Not a cell face ... do not emit */   break;
-    }
+  // Avoid capturing cl and sp
+  const k_emitter_component_t face   = *cl->k_face;
+  const k_emitter_component_t offset = *cl->k_offset;
+  const emitter_rng_pool_t pool = *cl->pool;
+  refresh_interpolator_array( cl->ia );
+  const k_interpolator_t fi = cl->ia->k_i_d;
+  const auto& k_neighbor = g->k_neighbor_d;
+  k_field_t k_field = cl->fa->k_f_d;
+  auto& k_particles = sp->k_p_d;
+  auto& k_particles_i = sp->k_p_i_d;
+  auto& movers = sp->k_pm_d;
+  auto& movers_i = sp->k_pm_i_d;
+  auto& particle_copy = sp->k_pc_d;
+  auto& particle_copy_i = sp->k_pc_i_d;
+  auto& k_nm = sp->k_nm_d;
+
+  // The normal field component of a face's cell.  ex, ey and ez are 4
+  // apart in the interpolator.
+
+# define FACE_FIELD( cc, axis ) \
+  fi( EXTRACT_LOCAL_CELL( cc ), interpolator_var::ex + 4*(axis) )
+
+  int n_emit = 0;
+  Kokkos::parallel_scan( "child_langmuir_count", Kokkos::RangePolicy<>(0, n_face),
+  KOKKOS_LAMBDA( const int f, int & sum, const bool final ) {
+    const int cc = face(f);
+    float dir;
+    const int axis = emitter_face_axis( EXTRACT_COMPONENT_TYPE( cc ), dir );
+    if( final ) offset(f) = sum;
+    if( dir*qsp*FACE_FIELD( cc, axis ) > thresh ) sum += np_emit_per_face;
+  }, n_emit );
+
+  int np_skipped = 0, nm_skipped = 0;
+  if( np+n_emit>sp->max_np ) {
+    np_skipped = np + n_emit - sp->max_np;
+    n_emit     = sp->max_np - np;
+  }
 
-#   undef EMIT_PARTICLES
+  if( n_emit>0 ) {
+    k_field_sa_t k_f_sv = cl->fa->k_field_sa_d;
 
+    Kokkos::parallel_reduce( "child_langmuir_emit",
+                             Kokkos::RangePolicy<>(0, n_face*np_emit_per_face),
+    KOKKOS_LAMBDA( const int k, int & skipped ) {
+      const int f  = k / np_emit_per_face;
+      const int cc = face(f);
+      float dir;
+      const int axis = emitter_face_axis( EXTRACT_COMPONENT_TYPE( cc ), dir );
+      const float e  = FACE_FIELD( cc, axis );
+      if( !( dir*qsp*e > thresh ) ) return; // This face does not emit
+      const int n = offset(f) + k - f*np_emit_per_face;
+      if( n>=n_emit ) return;               // Out of particle storage
+      const int slot = np + n;
+      const int a1 = axis==2 ? 0 : axis+1;
+      const int a2 = axis==0 ? 2 : axis-1;
+      const float norm_a = axis==0 ? norm_x : ( axis==1 ? norm_y : norm_z );
+
+      // Emit the particle
+
+      float u[3], d[3];
+      auto rng = pool.get_state();
+      u[axis] = dir*ut_para*sqrtf( -2*logf( 1-rng.frand() ) );
+      u[a1]   = ut_perp*(float)rng.normal();
+      u[a2]   = ut_perp*(float)rng.normal();
+      d[axis] = -dir;
+      d[a1]   = 2*rng.frand()-1;
+      d[a2]   = 2*rng.frand()-1;
+      const float age = ( rng.frand()*cdt ) /
+        sqrtf( ( u[0]*u[0] + u[1]*u[1] ) + ( u[2]*u[2] + 1 ) );
+      pool.free_state( rng );
+
+      k_particles(slot, particle_var::dx) = d[0];
+      k_particles(slot, particle_var::dy) = d[1];
+      k_particles(slot, particle_var::dz) = d[2];
+      k_particles(slot, particle_var::ux) = u[0];
+      k_particles(slot, particle_var::uy) = u[1];
+      k_particles(slot, particle_var::uz) = u[2];
+      k_particles(slot, particle_var::w)  = norm_a*sqrtf(fabsf(e*e*e));
+      k_particles_i(slot) = EXTRACT_LOCAL_CELL( cc );
+      k_accumulate_rhob_single( k_field, k_particles, k_particles_i, slot,
+                                q_8V, nx, ny, nz, sy, sz );
+
+      // Age the particle, unless the movers are full
+
+      if( Kokkos::atomic_load( &k_nm(0) )>=max_nm ) { skipped++; return; }
+      DECLARE_ALIGNED_ARRAY( particle_mover_t, 16, local_pm, 1 );
+      local_pm->dispx = age*u[0]*rdx;
+      local_pm->dispy = age*u[1]*rdy;
+      local_pm->dispz = age*u[2]*rdz;
+      local_pm->i     = slot;
+      if( move_p_kokkos( k_particles, k_particles_i, local_pm, k_f_sv, g,
+                         k_neighbor, rangel, rangeh, qsp, cx, cy, cz,
+                         nx, ny, nz ) ) {
+        // Another particle may have taken the last mover since the check
+        const int nm = Kokkos::atomic_fetch_add( &k_nm(0), 1 );
+        if( nm >= max_nm ) { skipped++; return; }
+        movers(nm, particle_mover_var::dispx) = local_pm->dispx;
+        movers(nm, particle_mover_var::dispy) = local_pm->dispy;
+        movers(nm, particle_mover_var::dispz) = local_pm->dispz;
+        movers_i(nm) = slot;
+        for( int v=0; v<PARTICLE_VAR_COUNT; v++ )
+          particle_copy(nm, v) = k_particles(slot, v);
+        particle_copy_i(nm) = k_particles_i(slot);
+      }
+    }, nm_skipped );
+
+    Kokkos::Experimental::contribute( k_field, k_f_sv );
+    k_f_sv.reset_except( k_field );
+
+    sp->np += n_emit;
+    sp->invalidate_partition();
+    Kokkos::deep_copy( sp->k_nm_h, sp->k_nm_d );
+    if( sp->k_nm_h(0)>max_nm ) {
+      sp->k_nm_h(0) = max_nm;
+      Kokkos::deep_copy( sp->k_nm_d, sp->k_nm_h );
+    }
+    sp->nm = sp->k_nm_h(0);
   }
 
-  sp->np = np;
-  sp->nm = nm;
+# undef FACE_FIELD
 
   if( np_skipped ) WARNING(( "Insufficient local particle storage.  Did not emit %i "
                              "particles in emit_child_langmuir", np_skipped ));
-  if( nm_skipped ) WARNING(( "Insufficient local particle mover storage.  Did not age %i "
-                             "emitted particles in emit_child_langmuir", nm_skipped ));
+  if( nm_skipped ) WARNING(( "Insufficient local particle mover storage.  Did not "
+                             "(finish) aging %i emitted particles in emit_child_langmuir",
+                             nm_skipped ));
 }
 
 void
@@ -161,12 +231,19 @@ restore_child_langmuir( void ) {
   RESTORE_PTR( cl->fa );
   RESTORE_PTR( cl->aa );
   RESTORE_PTR( cl->rng );
+  cl->k_face   = NULL; // Rebuilt from the restored component list
+  cl->k_offset = NULL;
+  cl->pool     = NULL; // Reseeded from the restored rng
   return restore_emitter_internal( cl );
 }
 
 void
 delete_child_langmuir( emitter_t * e ) {
-  FREE( e->params );
+  child_langmuir_t * cl = (child_langmuir_t *)e->params;
+  delete cl->k_face;
+  delete cl->k_offset;
+  delete cl->pool;
+  FREE( cl );
   delete_emitter_internal( e );
 }
 
@@ -184,6 +261,7 @@ child_langmuir( /**/  species_t            * RESTRICT sp,
                 float thresh_e_norm,
                 float norm ) {
   child_langmuir_t * cl;
+  emitter_t * e;
 
   if( !sp || !ia || !fa || !aa || !rp ||
       sp->g!=ia->g || sp->g!=fa->g || sp->g!=aa->g ||
@@ -201,11 +279,16 @@ child_langmuir( /**/  species_t            * RESTRICT sp,
   cl->ut_perp         = ut_perp;
   cl->thresh_e_norm   = thresh_e_norm;
   cl->norm            = norm;
-  return new_emitter_internal( cl,
-                               (emit_func_t)emit_child_langmuir,
-                               delete_child_langmuir,
-                               (checkpt_func_t)checkpt_child_langmuir,
-                               (restore_func_t)restore_child_langmuir,
-                               NULL );
+  cl->k_face          = NULL;
+  cl->k_offset        = NULL;
+  cl->pool            = NULL;
+  e = new_emitter_internal( cl,
+                            (emit_func_t)emit_child_langmuir,
+                            delete_child_langmuir,
+                            (checkpt_func_t)checkpt_child_langmuir,
+                            (restore_func_t)restore_child_langmuir,
+                            NULL );
+  e->on_device = 1;
+  return e;
 }
 
@@ -37,6 +37,7 @@ new_emitter_internal( void * params,
   e->params   = params;
   e->emit     = emit;
   e->delete_e = delete_e;
+  e->on_device = 0;
   /* next set by append_emitter */
   REGISTER_OBJECT( e, checkpt, restore, reanimate );
   return e;
@@ -59,6 +60,14 @@ num_emitter( const emitter_t * RESTRICT e_list ) {
   return n;
 }
 
+int
+num_host_emitter( const emitter_t * RESTRICT e_list ) {
+  const emitter_t * RESTRICT e;
+  int n = 0;
+  LIST_FOR_EACH( e, e_list ) if( !e->on_device ) n++;
+  return n;
+}
+
 void
 apply_emitter_list( emitter_t * RESTRICT e_list ) {
   emitter_t * e;
@@ -97,3 +106,20 @@ size_emitter( emitter_t * RESTRICT e,
   return e->component;
 }
 
+k_emitter_component_t *
+new_emitter_face_list( const int32_t * component,
+                       int n_component ) {
+  float dir;
+  int c, n = 0;
+  if( n_component<0 || ( n_component && !component ) ) ERROR(( "Bad args" ));
+  for( c=0; c<n_component; c++ )
+    if( emitter_face_axis( EXTRACT_COMPONENT_TYPE( component[c] ), dir )>=0 ) n++;
+
+  k_emitter_component_t * face = new k_emitter_component_t( "emitter_faces", n );
+  k_emitter_component_t::HostMirror face_h = Kokkos::create_mirror_view( *face );
+  for( c=n=0; c<n_component; c++ )
+    if( emitter_face_axis( EXTRACT_COMPONENT_TYPE( component[c] ), dir )>=0 )
+      face_h(n++) = component[c];
+  Kokkos::deep_copy( *face, face_h );
+  return face;
+}
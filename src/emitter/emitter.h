@@ -8,6 +8,7 @@
 #define _emitter_h_
 
 #include "../species_advance/species_advance.h"
+#include <Kokkos_Random.hpp>
 
 struct emitter;
 typedef struct emitter emitter_t;
@@ -28,6 +29,32 @@ typedef struct emitter emitter_t;
 #define EXTRACT_LOCAL_CELL( component_id )     ((component_id)>>5)
 #define EXTRACT_COMPONENT_TYPE( component_id ) ((component_id)&31)
 
+// Emitters run on the device.  Their component lists are copied (and
+// compacted to what the emitter can use) into a device view on first
+// use, and their entropy comes from a device pool seeded from the host
+// rng the emitter was given.
+
+typedef Kokkos::View<int*> k_emitter_component_t;
+typedef Kokkos::Random_XorShift64_Pool<> emitter_rng_pool_t;
+
+// For a cell face component type, returns the axis (0, 1 or 2) of the
+// face normal and sets dir to +1 if the face is on the low side of the
+// cell (emission into +axis) or -1 on the high side.  Returns -1 for
+// edges, corners and the cell body.
+
+KOKKOS_INLINE_FUNCTION int
+emitter_face_axis( int component_type,
+                   float & dir ) {
+  const int t = component_type - BOUNDARY(0,0,0);
+  dir = t<0 ? 1.f : -1.f;
+  switch( t<0 ? -t : t ) {
+  case 1: return 0;
+  case 3: return 1;
+  case 9: return 2;
+  default: return -1;
+  }
+}
+
 // In emitter.c
 
 int
@@ -39,6 +66,16 @@ apply_emitter_list( emitter_t * e_list );
 void
 delete_emitter_list( emitter_t * e_list );
 
+int
+num_host_emitter( const emitter_t * e_list );
+
+// Returns a new device view holding the cell face components of
+// component[0:n_component-1], in order.
+
+k_emitter_component_t *
+new_emitter_face_list( const int32_t * component,
+                       int n_component );
+
 // Note that this append is hacked to silently return if the given
 // emitter is already part of the list.  This allows the emitter
 // initialization in vpic.h / deck_wrappers.cxx to get around
@@ -21,6 +21,7 @@ struct emitter {
   delete_emitter_func_t delete_e;
   int * ALIGNED(128) component;
   int n_component;
+  int on_device;  // Set by device emitters; host emitters are not supported
   emitter_t * next;
 };
 
@@ -189,3 +189,101 @@ field_array_t::copy_to_device() {
   Kokkos::deep_copy(k_fe_d, k_fe_h);
 
 }
+
+// The region is packed into a contiguous staging buffer, voxel major, so
+// that only the requested components of the requested voxels cross the
+// bus.  The first FIELD_VAR_COUNT floats of field_t are in field_var
+// order, which is how the host side is addressed.
+
+struct field_region_map {
+  int var[FIELD_VAR_COUNT];
+  int nvar, il, jl, kl, ni, nj, nvox, sy, sz;
+};
+
+static field_region_map
+map_field_region( const field_region_t & r,
+                  const grid_t * g ) {
+  field_region_map m;
+  if( r.il<0 || r.ih>g->nx+1 || r.il>r.ih ||
+      r.jl<0 || r.jh>g->ny+1 || r.jl>r.jh ||
+      r.kl<0 || r.kh>g->nz+1 || r.kl>r.kh )
+    ERROR(( "Bad field region [%i,%i]x[%i,%i]x[%i,%i]",
+            r.il, r.ih, r.jl, r.jh, r.kl, r.kh ));
+  m.nvar = 0;
+  for( int v=0; v<FIELD_VAR_COUNT; v++ ) if( r.vars & (1<<v) ) m.var[m.nvar++] = v;
+  m.il = r.il; m.jl = r.jl; m.kl = r.kl;
+  m.ni = r.ih-r.il+1; m.nj = r.jh-r.jl+1;
+  m.nvox = m.ni*m.nj*(r.kh-r.kl+1);
+  m.sy = g->sy; m.sz = g->sz;
+  return m;
+}
+
+static void
+size_field_region( field_array_t * fa,
+                   int n ) {
+  if( (int)fa->k_region_d.extent(0)>=n ) return;
+  fa->k_region_d = k_field_region_t( "k_field_region", n );
+  fa->k_region_h = Kokkos::create_mirror_view( fa->k_region_d );
+}
+
+void
+field_array_t::copy_to_host( const field_region_t & r ) {
+  if( !r.vars ) { copy_to_host(); return; }
+
+  const field_region_map m = map_field_region( r, g );
+  const int len = m.nvox*m.nvar;
+  size_field_region( this, len );
+
+  // Avoid capturing this
+  auto& k_field = k_f_d;
+  auto& stage = k_region_d;
+
+  Kokkos::parallel_for( "pack field region", Kokkos::RangePolicy<>(0, m.nvox),
+  KOKKOS_LAMBDA( const int n ) {
+    const int v = ( m.il + n%m.ni ) + m.sy*( m.jl + (n/m.ni)%m.nj ) +
+                  m.sz*( m.kl + n/(m.ni*m.nj) );
+    for( int c=0; c<m.nvar; c++ ) stage(n*m.nvar+c) = k_field(v, m.var[c]);
+  });
+
+  auto span = std::make_pair( 0, len );
+  Kokkos::deep_copy( Kokkos::subview( k_region_h, span ),
+                     Kokkos::subview( k_region_d, span ) );
+
+  for( int n=0; n<m.nvox; n++ ) {
+    const int v = ( m.il + n%m.ni ) + m.sy*( m.jl + (n/m.ni)%m.nj ) +
+                  m.sz*( m.kl + n/(m.ni*m.nj) );
+    float * RESTRICT hf = (float *)( f + v );
+    for( int c=0; c<m.nvar; c++ ) hf[ m.var[c] ] = k_region_h(n*m.nvar+c);
+  }
+}
+
+void
+field_array_t::copy_to_device( const field_region_t & r ) {
+  if( !r.vars ) { copy_to_device(); return; }
+
+  const field_region_map m = map_field_region( r, g );
+  const int len = m.nvox*m.nvar;
+  size_field_region( this, len );
+
+  for( int n=0; n<m.nvox; n++ ) {
+    const int v = ( m.il + n%m.ni ) + m.sy*( m.jl + (n/m.ni)%m.nj ) +
+                  m.sz*( m.kl + n/(m.ni*m.nj) );
+    const float * RESTRICT hf = (const float *)( f + v );
+    for( int c=0; c<m.nvar; c++ ) k_region_h(n*m.nvar+c) = hf[ m.var[c] ];
+  }
+
+  auto span = std::make_pair( 0, len );
+  Kokkos::deep_copy( Kokkos::subview( k_region_d, span ),
+                     Kokkos::subview( k_region_h, span ) );
+
+  // Avoid capturing this
+  auto& k_field = k_f_d;
+  auto& stage = k_region_d;
+
+  Kokkos::parallel_for( "unpack field region", Kokkos::RangePolicy<>(0, m.nvox),
+  KOKKOS_LAMBDA( const int n ) {
+    const int v = ( m.il + n%m.ni ) + m.sy*( m.jl + (n/m.ni)%m.nj ) +
+                  m.sz*( m.kl + n/(m.ni*m.nj) );
+    for( int c=0; c<m.nvar; c++ ) k_field(v, m.var[c]) = stage(n*m.nvar+c);
+  });
+}
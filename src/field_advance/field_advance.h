@@ -265,6 +265,12 @@ typedef struct field_buffers
     Kokkos::View<float*>::HostMirror   yzx_rbuf_neg_h;
     Kokkos::View<float*>::HostMirror   zxy_rbuf_neg_h;
 
+    // All six tangential B faces back to back (see remote.cc)
+    Kokkos::View<float*>   tang_b_sbuf;
+    Kokkos::View<float*>   tang_b_rbuf;
+    Kokkos::View<float*>::HostMirror   tang_b_sbuf_h;
+    Kokkos::View<float*>::HostMirror   tang_b_rbuf_h;
+
     field_buffers() {
         // User should try avoid calling this
     }
@@ -297,8 +303,26 @@ typedef struct field_buffers
         xyz_rbuf_neg_h = Kokkos::create_mirror_view(xyz_rbuf_neg);
         yzx_rbuf_neg_h = Kokkos::create_mirror_view(yzx_rbuf_neg);
         zxy_rbuf_neg_h = Kokkos::create_mirror_view(zxy_rbuf_neg);
+
+        // Each xxx_size is at least one face, so this holds all six faces
+        tang_b_sbuf = Kokkos::View<float*>("Send buffer for all tangential B faces", 2*(xyz_size+yzx_size+zxy_size));
+        tang_b_rbuf = Kokkos::View<float*>("Receive buffer for all tangential B faces", 2*(xyz_size+yzx_size+zxy_size));
+        tang_b_sbuf_h = Kokkos::create_mirror_view(tang_b_sbuf);
+        tang_b_rbuf_h = Kokkos::create_mirror_view(tang_b_rbuf);
     }
 } field_buffers_t;
+// A box of voxels, inclusive and indexed as in VOXEL (so ghosts can be
+// included), and a mask of the field_var components to transfer, e.g.
+// (1<<field_var::ey)|(1<<field_var::ez).  A region with no components
+// stands for the whole field array.
+
+typedef struct field_region {
+  int il, ih, jl, jh, kl, kh;
+  int vars;
+} field_region_t;
+
+typedef Kokkos::View<float*> k_field_region_t;
+
 // A field_array holds all the field quanties and pointers to
 // kernels used to advance them.
 
@@ -324,6 +348,10 @@ typedef struct field_array {
   k_jf_accum_t k_jf_accum_d;
   k_jf_accum_t::HostMirror k_jf_accum_h;
 
+  // Staging for region copies, grown on demand
+  k_field_region_t k_region_d;
+  k_field_region_t::HostMirror k_region_h;
+
   // Step when the field was last copied to to the host.  The copy can
   // take place at any time during the step, so checking
   // last_copied==step() does not mean that the host and device
@@ -365,6 +393,17 @@ typedef struct field_array {
       delete fb;
   }
 
+  // Calls f on every Kokkos view held directly (fb is rebuilt by
+  // init_kokkos_fields). Used by CHECKPT_KOKKOS.
+  template<class F>
+  void for_each_kokkos_view(F f)
+  {
+      f(k_f_d); f(k_f_h); f(k_field_sa_d); f(k_fe_d); f(k_fe_h);
+      f(k_f_rhob_accum_d); f(k_f_rhob_accum_h);
+      f(k_jf_accum_d); f(k_jf_accum_h);
+      f(k_region_d); f(k_region_h);
+  }
+
   /**
    * @brief Copies the field data to the host.
    */
@@ -375,6 +414,16 @@ typedef struct field_array {
    */
   void copy_to_device();
 
+  /**
+   * @brief Copies the given components of the given voxels to the host.
+   * Material ids are not copied. An empty region copies everything.
+   */
+  void copy_to_host( const field_region_t & r );
+
+  /**
+   * @brief Copies the given components of the given voxels to the device.
+   */
+  void copy_to_device( const field_region_t & r );
 
 } field_array_t;
 
@@ -420,6 +469,12 @@ typedef struct sfa_params {
         k_mc_h = Kokkos::create_mirror_view(k_mc_d);
     }
 
+    template<class F>
+    void for_each_kokkos_view(F f)
+    {
+        f(k_mc_d); f(k_mc_h);
+    }
+
     void populate_kokkos_data()
     {
         Kokkos::parallel_for("Copy materials to device", Kokkos::RangePolicy<Kokkos::DefaultHostExecutionSpace>(0, n_mc), KOKKOS_CLASS_LAMBDA (const int i)
@@ -141,30 +141,6 @@ typedef class XYZ {} XYZ;
 typedef class YZX {} YZX;
 typedef class ZXY {} ZXY;
 
-template <typename T> void begin_recv_kokkos(const grid_t* g, int i, int j, int k, int nx, int ny, int nz, Kokkos::View<float*>& rbuf, Kokkos::View<float*>::HostMirror& rbuf_h) {
-}
-template<> void begin_recv_kokkos<XYZ>(const grid_t* g, int i, int j, int k, int nx, int ny, int nz, Kokkos::View<float*>& rbuf_d, Kokkos::View<float*>::HostMirror& rbuf_h) {
-    int size = (1 + ny*(nz+1) + nz*(ny+1))*sizeof(float);
-// CPU
-    begin_recv_port_k(i,j,k,size,g,reinterpret_cast<char*>(rbuf_h.data()));
-// GPU
-//    begin_recv_port_k(i,j,k,size,g,reinterpret_cast<char*>(rbuf_d.data()));
-}
-template<> void begin_recv_kokkos<YZX>(const grid_t* g, int i, int j, int k, int nx, int ny, int nz, Kokkos::View<float*>& rbuf_d, Kokkos::View<float*>::HostMirror& rbuf_h) {
-    int size = (1 + nx*(nz+1) + nz*(nx+1))*sizeof(float);
-// CPU
-    begin_recv_port_k(i,j,k,size,g,reinterpret_cast<char*>(rbuf_h.data()));
-// GPU
-//    begin_recv_port_k(i,j,k,size,g,reinterpret_cast<char*>(rbuf_d.data()));
-}
-template<> void begin_recv_kokkos<ZXY>(const grid_t* g, int i, int j, int k, int nx, int ny, int nz, Kokkos::View<float*>& rbuf_d, Kokkos::View<float*>::HostMirror& rbuf_h) {
-    int size = (1 + nx*(ny+1) + ny*(nx+1))*sizeof(float);
-// CPU
-    begin_recv_port_k(i,j,k,size,g,reinterpret_cast<char*>(rbuf_h.data()));
-// GPU
-//    begin_recv_port_k(i,j,k,size,g,reinterpret_cast<char*>(rbuf_d.data()));
-}
-
 template <typename T> void begin_recv(int i, int j, int k, int nx, int ny, int nz, const grid_t* g) {
     int nX, nY, nZ;
     if (std::is_same<T, XYZ>::value) {
@@ -187,91 +163,6 @@ template<> void begin_recv<ZXY>(int i, int j, int k, int nx, int ny, int nz, con
     begin_recv_port(i,j,k,(1+nx*(ny+1)+ny*(nx+1))*sizeof(float),g);
 }
 
-template <typename T> void begin_send_kokkos(const grid_t* g, field_array_t* fa, int i, int j, int k, int nx, int ny, int nz, Kokkos::View<float*>& sbuf, Kokkos::View<float*>::HostMirror& sbuf_h) {}
-
-template <> void begin_send_kokkos<XYZ>(const grid_t* g, field_array_t* fa, int i, int j, int k, int nx, int ny, int nz, Kokkos::View<float*>& sbuf_d, Kokkos::View<float*>::HostMirror& sbuf_h) {
-    k_field_t& k_field = fa->k_f_d;
-    const size_t size = (1+ny*(nz+1)+nz*(ny+1));
-
-        int face = (i+j+k)<0 ? 1 : nx;
-        float dx = g->dx;
-        Kokkos::MDRangePolicy<Kokkos::Rank<2>> zy_edge({1, 1}, {nz+1, ny+2});
-        Kokkos::MDRangePolicy<Kokkos::Rank<2>> yz_edge({1, 1}, {nz+2, ny+1});
-
-        Kokkos::parallel_for("begin_send<XYZ>: ZY Edge Loop", zy_edge, KOKKOS_LAMBDA(const int z, const int y) {
-//            if(z+y == 2) {
-//                sbuf_d(0) = dx;
-//            }
-            const int x = face;
-            sbuf_d(1 + (z-1)*(ny+1) + (y-1)) = k_field(VOXEL(x,y,z, nx,ny,nz), field_var::cby);
-        });
-        Kokkos::parallel_for("begin_send<XYZ>: YZ Edge Loop", yz_edge, KOKKOS_LAMBDA(const int z, const int y) {
-            const int x = face;
-            sbuf_d(1 + nz*(ny+1) + (z-1)*ny + (y-1)) = k_field(VOXEL(x,y,z, nx,ny,nz), field_var::cbz);
-        });
-// CPU
-        Kokkos::deep_copy(sbuf_h, sbuf_d);
-        sbuf_h(0) = dx;
-        begin_send_port_k(i,j,k,size*sizeof(float), g, reinterpret_cast<char*>(sbuf_h.data()));
-
-// GPU
-//        begin_send_port_k(i,j,k,size*sizeof(float), g, reinterpret_cast<char*>(sbuf_d.data()));
-
-}
-template <> void begin_send_kokkos<YZX>(const grid_t* g, field_array_t* fa, int i, int j, int k, int nx, int ny, int nz, Kokkos::View<float*>& sbuf_d, Kokkos::View<float*>::HostMirror& sbuf_h) {
-    k_field_t& k_field = fa->k_f_d;
-    size_t size = (1+nz*(nx+1)+nx*(nz+1));
-    int face = (i+j+k)<0 ? 1 : ny;
-    float dy = g->dy;
-    Kokkos::MDRangePolicy<Kokkos::Rank<2>> xz_edge({1, 1}, {nz+2, nx+1});
-    Kokkos::MDRangePolicy<Kokkos::Rank<2>> zx_edge({1, 1}, {nz+1, nx+2});
-
-    Kokkos::parallel_for("begin_send<YZX>: XZ Edge Loop", xz_edge, KOKKOS_LAMBDA(const int z, const int x) {
-//        if(z+x == 2) {
-//            sbuf_d(0) = dy;
-//        }
-        const int y = face;
-        sbuf_d(1 + (z-1)*nx + (x-1)) = k_field(VOXEL(x,y,z,nx,ny,nz), field_var::cbz);
-    });
-    Kokkos::parallel_for("begin_send<YZX>: ZX Edge Loop", zx_edge, KOKKOS_LAMBDA(const int z, const int x) {
-        const int y = face;
-        sbuf_d(1 + (nz+1)*nx + (nx+1)*(z-1) + (x-1)) = k_field(VOXEL(x,y,z,nx,ny,nz), field_var::cbx);
-    });
-// CPU
-    Kokkos::deep_copy(sbuf_h, sbuf_d);
-    sbuf_h(0) = dy;
-    begin_send_port_k(i, j, k, size*sizeof(float), g, reinterpret_cast<char*>(sbuf_h.data()));
-// GPU
-//    begin_send_port_k(i, j, k, size*sizeof(float), g, reinterpret_cast<char*>(sbuf_d.data()));
-
-}
-template <> void begin_send_kokkos<ZXY>(const grid_t* g, field_array_t* fa, int i, int j, int k, int nx, int ny, int nz, Kokkos::View<float*>& sbuf_d, Kokkos::View<float*>::HostMirror& sbuf_h) {
-    size_t size = (1+nx*(ny+1)+ny*(nx+1));
-    k_field_t& k_field = fa->k_f_d;
-    int face = (i+j+k)<0 ? 1 : nz;
-    float dz = g->dz;
-    Kokkos::MDRangePolicy<Kokkos::Rank<2>> yx_edge({1, 1}, {ny+1, nx+2});
-    Kokkos::MDRangePolicy<Kokkos::Rank<2>> xy_edge({1, 1}, {ny+2, nx+1});
-
-    Kokkos::parallel_for("begin_send<ZXY>: YX Edge Loop", yx_edge, KOKKOS_LAMBDA(const int y, const int x) {
-//        if(y+x == 2) {
-//            sbuf_d(0) = dz;
-//        }
-        const int z = face;
-        sbuf_d(1 + (nx+1)*(y-1) + (x-1)) = k_field(VOXEL(x,y,z,nx,ny,nz), field_var::cbx);
-    });
-    Kokkos::parallel_for("begin_send<ZXY>: XY Edge Loop", xy_edge, KOKKOS_LAMBDA(const int y, const int x) {
-        const int z = face;
-        sbuf_d(1 + (nx+1)*ny + (y-1)*nx + (x-1)) = k_field(VOXEL(x,y,z,nx,ny,nz), field_var::cby);
-    });
-// CPU
-    Kokkos::deep_copy(sbuf_h, sbuf_d);
-    sbuf_h(0) = dz;
-    begin_send_port_k(i,j,k,size*sizeof(float), g, reinterpret_cast<char*>(sbuf_h.data()));
-// GPU
-//    begin_send_port_k(i,j,k,size*sizeof(float), g, reinterpret_cast<char*>(sbuf_d.data()));
-}
-
 template <typename T> void begin_send(int i, int j, int k, int nX, int nY, int nZ, field_array_t*  fa, const grid_t* g) {}
 template <> void begin_send<XYZ>(int i, int j, int k, int nx, int ny, int nz, field_array_t* field, const grid_t* g) {
     k_field_t k_field = field->k_f_d;
@@ -398,26 +289,122 @@ template <> void begin_send<ZXY>(int i, int j, int k, int nx, int ny, int nz, fi
 }
 
 
+// The Kokkos tangential B exchange keeps all six faces in one contiguous
+// buffer so that a single kernel packs (and unpacks) every face and the
+// host staging, when needed, is a single copy. Faces are stored in the
+// order -x,-y,-z,+x,+y,+z; each face starts with the sender's cell width
+// followed by the two tangential B components in the layout used by the
+// host path above.
+
+typedef Kokkos::Array<int,7> tang_b_offsets_t;
+
+static void
+tang_b_face_offsets( const grid_t * g,
+                     tang_b_offsets_t & off ) {
+    const int nx = g->nx, ny = g->ny, nz = g->nz;
+    const int n_face[3] = { 1 + ny*(nz+1) + nz*(ny+1),
+                            1 + nz*(nx+1) + nx*(nz+1),
+                            1 + nx*(ny+1) + ny*(nx+1) };
+    off[0] = 0;
+    for( int f=0; f<6; f++ ) off[f+1] = off[f] + n_face[f%3];
+}
+
+// Maps entry n (header excluded) of a face buffer along axis to the voxel
+// in plane p holding it and the B component stored there.
+KOKKOS_INLINE_FUNCTION void
+tang_b_face_entry( const int axis, const int p, int n,
+                   const int nx, const int ny, const int nz,
+                   int & x, int & y, int & z, int & var ) {
+    if( axis==0 ) {
+        if( n < nz*(ny+1) ) { z = n/(ny+1) + 1; y = n%(ny+1) + 1; var = field_var::cby; }
+        else { n -= nz*(ny+1); z = n/ny + 1; y = n%ny + 1; var = field_var::cbz; }
+        x = p;
+    } else if( axis==1 ) {
+        if( n < (nz+1)*nx ) { z = n/nx + 1; x = n%nx + 1; var = field_var::cbz; }
+        else { n -= (nz+1)*nx; z = n/(nx+1) + 1; x = n%(nx+1) + 1; var = field_var::cbx; }
+        y = p;
+    } else {
+        if( n < ny*(nx+1) ) { y = n/(nx+1) + 1; x = n%(nx+1) + 1; var = field_var::cbx; }
+        else { n -= ny*(nx+1); y = n/nx + 1; x = n%nx + 1; var = field_var::cby; }
+        z = p;
+    }
+}
+
+static const int tang_b_face_ijk[6][3] = { {-1, 0, 0}, { 0,-1, 0}, { 0, 0,-1},
+                                           { 1, 0, 0}, { 0, 1, 0}, { 0, 0, 1} };
+
+static inline bool
+tang_b_remote( const grid_t * g, int i, int j, int k ) {
+    const int rank = g->bc[ BOUNDARY(i,j,k) ];
+    return rank>=0 && rank<world_size;
+}
+
 void
 kokkos_begin_remote_ghost_tang_b( field_array_t      * RESTRICT fa,
                            const grid_t *              g,
                             field_buffers_t&            f_buffers) {
     const int nx = g->nx, ny = g->ny, nz = g->nz;
+    const float dx = g->dx, dy = g->dy, dz = g->dz;
+    k_field_t k_field = fa->k_f_d;
+    Kokkos::View<float*> sbuf = f_buffers.tang_b_sbuf;
+
+    tang_b_offsets_t off;
+    Kokkos::Array<int,6> send;
+    tang_b_face_offsets( g, off );
+
+#ifdef VPIC_ENABLE_GPU_AWARE_MPI
+    char * rbase = reinterpret_cast<char*>( f_buffers.tang_b_rbuf.data() );
+    char * sbase = reinterpret_cast<char*>( f_buffers.tang_b_sbuf.data() );
+#else
+    char * rbase = reinterpret_cast<char*>( f_buffers.tang_b_rbuf_h.data() );
+    char * sbase = reinterpret_cast<char*>( f_buffers.tang_b_sbuf_h.data() );
+#endif
+
+    // Post every receive before anything else so no message waits on us
+
+    int n_send = 0;
+    for( int f=0; f<6; f++ ) {
+        const int i = tang_b_face_ijk[f][0], j = tang_b_face_ijk[f][1], k = tang_b_face_ijk[f][2];
+        begin_recv_port_k( i, j, k, (off[f+1]-off[f])*sizeof(float), g,
+                           rbase + off[f]*sizeof(float) );
+        send[f] = tang_b_remote( g, i, j, k );
+        n_send += send[f];
+    }
+    if( !n_send ) return;
+
+    // Pack every shared face in one launch
+
+    Kokkos::parallel_for("kokkos_begin_remote_ghost_tang_b: pack", Kokkos::RangePolicy<>(0, off[6]),
+    KOKKOS_LAMBDA(const int idx) {
+        int f = 0;
+        while( idx >= off[f+1] ) f++;
+        if( !send[f] ) return;
+        const int axis = f%3;
+        const int n = idx - off[f];
+        if( n==0 ) {
+            sbuf(idx) = axis==0 ? dx : ( axis==1 ? dy : dz );
+            return;
+        }
+        const int p = f<3 ? 1 : ( axis==0 ? nx : ( axis==1 ? ny : nz ) );
+        int x, y, z, var;
+        tang_b_face_entry( axis, p, n-1, nx, ny, nz, x, y, z, var );
+        sbuf(idx) = k_field(VOXEL(x,y,z,nx,ny,nz), var);
+    });
 
-    begin_recv_kokkos<XYZ>(g,-1,0,0,nx,ny,nz, f_buffers.xyz_sbuf_neg, f_buffers.xyz_rbuf_neg_h);
-    begin_recv_kokkos<YZX>(g,0,-1,0,nx,ny,nz, f_buffers.yzx_sbuf_neg, f_buffers.yzx_rbuf_neg_h);
-    begin_recv_kokkos<ZXY>(g,0,0,-1,nx,ny,nz, f_buffers.zxy_sbuf_neg, f_buffers.zxy_rbuf_neg_h);
-    begin_recv_kokkos<XYZ>(g,1,0,0,nx,ny,nz,  f_buffers.xyz_sbuf_pos, f_buffers.xyz_rbuf_pos_h);
-    begin_recv_kokkos<YZX>(g,0,1,0,nx,ny,nz,  f_buffers.yzx_sbuf_pos, f_buffers.yzx_rbuf_pos_h);
-    begin_recv_kokkos<ZXY>(g,0,0,1,nx,ny,nz,  f_buffers.zxy_sbuf_pos, f_buffers.zxy_rbuf_pos_h);
+#ifdef VPIC_ENABLE_GPU_AWARE_MPI
+    Kokkos::fence();
+#else
+    const auto span = std::make_pair( 0, off[6] );
+    Kokkos::deep_copy( Kokkos::subview( f_buffers.tang_b_sbuf_h, span ),
+                       Kokkos::subview( f_buffers.tang_b_sbuf,   span ) );
+#endif
 
-    begin_send_kokkos<XYZ>(g,fa,-1,0,0,nx,ny,nz, f_buffers.xyz_sbuf_neg, f_buffers.xyz_sbuf_neg_h);
-    begin_send_kokkos<YZX>(g,fa,0,-1,0,nx,ny,nz, f_buffers.yzx_sbuf_neg, f_buffers.yzx_sbuf_neg_h);
-    begin_send_kokkos<ZXY>(g,fa,0,0,-1,nx,ny,nz, f_buffers.zxy_sbuf_neg, f_buffers.zxy_sbuf_neg_h);
-    begin_send_kokkos<XYZ>(g,fa,1,0,0,nx,ny,nz,  f_buffers.xyz_sbuf_pos, f_buffers.xyz_sbuf_pos_h);
-    begin_send_kokkos<YZX>(g,fa,0,1,0,nx,ny,nz,  f_buffers.yzx_sbuf_pos, f_buffers.yzx_sbuf_pos_h);
-    begin_send_kokkos<ZXY>(g,fa,0,0,1,nx,ny,nz,  f_buffers.zxy_sbuf_pos, f_buffers.zxy_sbuf_pos_h);
+    // The sends are left in flight; the caller updates the interior
+    // while they complete.
 
+    for( int f=0; f<6; f++ )
+        begin_send_port_k( tang_b_face_ijk[f][0], tang_b_face_ijk[f][1], tang_b_face_ijk[f][2],
+                           (off[f+1]-off[f])*sizeof(float), g, sbase + off[f]*sizeof(float) );
 }
 
 void
@@ -440,106 +427,6 @@ k_begin_remote_ghost_tang_b( field_array_t      * RESTRICT fa,
     begin_send<ZXY>(0,0,1,nx,ny,nz,fa,g);
 }
 
-template<typename T> void end_recv_kokkos(const grid_t* g, field_array_t* RESTRICT field, int i, int j, int k, int nx, int ny, int nz, Kokkos::View<float*>& rbuf, Kokkos::View<float*>::HostMirror& rbuf_h) {}
-
-template<> void end_recv_kokkos<XYZ>(const grid_t* g, field_array_t* RESTRICT field, int i, int j, int k, int nx, int ny, int nz, Kokkos::View<float*>& rbuf_d, Kokkos::View<float*>::HostMirror& rbuf_h) {
-    float* p = static_cast<float*>(end_recv_port_k(i,j,k,g));
-//    size_t size = 1 + (ny+1)*nz + ny*(nz+1);
-    if(p) {
-        Kokkos::deep_copy(rbuf_d, rbuf_h);
-
-        k_field_t k_field = field->k_f_d;
-
-        int face = (i+j+k)<0 ? nx+1 : 0;
-        float dx = g->dx;
-
-            float lw = rbuf_h(0);
-            const float rw = (2.*dx) / (lw + dx);
-            lw = (lw - dx)/(lw + dx);
-
-        Kokkos::MDRangePolicy<Kokkos::Rank<2>> zy_edge({1, 1}, {nz+1, ny+2});
-        Kokkos::MDRangePolicy<Kokkos::Rank<2>> yz_edge({1, 1}, {nz+2, ny+1});
-        Kokkos::parallel_for("end_recv<XYZ>: ZY Edge loop", zy_edge, KOKKOS_LAMBDA(const int z, const int y) {
-//            float lw = rbuf_d(0);
-//            const float rw = (2.*dx) / (lw + dx);
-//            lw = (lw - dx)/(lw + dx);
-            k_field(VOXEL(face,y,z,nx,ny,nz), field_var::cby) = rw*rbuf_d((z-1)*(ny+1) + (y-1) + 1) + lw*k_field(VOXEL(face+i,y+j,z+k,nx,ny,nz), field_var::cby);
-        });
-        Kokkos::parallel_for("end_recv<XYZ>: YZ Edge loop", yz_edge, KOKKOS_LAMBDA(const int z, const int y) {
-//            float lw = rbuf_d(0);
-//            const float rw = (2.*dx) / (lw + dx);
-//            lw = (lw - dx)/(lw + dx);
-            k_field(VOXEL(face,y,z,nx,ny,nz), field_var::cbz) = rw*rbuf_d((ny+1)*nz + (z-1)*ny + (y-1) + 1) + lw*k_field(VOXEL(face+i,y+j,z+k,nx,ny,nz), field_var::cbz);
-        });
-    }
-}
-template<> void end_recv_kokkos<YZX>(const grid_t* g, field_array_t* RESTRICT field, int i, int j, int k, int nx, int ny, int nz, Kokkos::View<float*>& rbuf_d, Kokkos::View<float*>::HostMirror& rbuf_h) {
-   float* p = static_cast<float*>(end_recv_port_k(i,j,k,g));
-//    size_t size = 1 + nx*(nz+1) + (nx+1)*nz;
-    if(p) {
-// CPU
-        Kokkos::deep_copy(rbuf_d, rbuf_h);
-
-        k_field_t k_field = field->k_f_d;
-
-        int face = (i+j+k)<0 ? ny+1 : 0;
-        float dy = g->dy;
-
-            float lw = rbuf_h(0);
-            const float rw = (2.*dy) / (lw+dy);
-            lw = (lw-dy)/(lw+dy);
-
-        Kokkos::MDRangePolicy<Kokkos::Rank<2>> xz_edge({1, 1}, {nz+2, nx+1});
-        Kokkos::MDRangePolicy<Kokkos::Rank<2>> zx_edge({1, 1}, {nz+1, nx+2});
-        Kokkos::parallel_for("end_recv<YZX>: XZ Edge loop", xz_edge, KOKKOS_LAMBDA(const int z, const int x) {
-            const int y = face;
-//            float lw = rbuf_d(0);
-//            const float rw = (2.*dy) / (lw+dy);
-//            lw = (lw-dy)/(lw+dy);
-            k_field(VOXEL(x,y,z,nx,ny,nz), field_var::cbz) = rw*rbuf_d(1 + (z-1)*nx + (x-1)) + lw*k_field(VOXEL(x+i,y+j,z+k,nx,ny,nz), field_var::cbz);
-        });
-        Kokkos::parallel_for("end_recv<YZX>: ZX Edge loop", zx_edge, KOKKOS_LAMBDA(const int z, const int x) {
-            const int y = face;
-//            float lw = rbuf_d(0);
-//            const float rw = (2.*dy) / (lw+dy);
-//            lw = (lw-dy)/(lw+dy);
-            k_field(VOXEL(x,y,z,nx,ny,nz), field_var::cbx) = rw*rbuf_d(1 + nx*(nz+1) + (z-1)*(nx+1) + (x-1)) + lw*k_field(VOXEL(x+i,y+j,z+k,nx,ny,nz), field_var::cbx);
-        });
-    }
-}
-template<> void end_recv_kokkos<ZXY>(const grid_t* g, field_array_t* RESTRICT field, int i, int j, int k, int nx, int ny, int nz, Kokkos::View<float*>& rbuf_d, Kokkos::View<float*>::HostMirror& rbuf_h) {
-    float* p = static_cast<float*>(end_recv_port_k(i,j,k,g));
-    if(p) {
-        k_field_t k_field = field->k_f_d;
-// CPU
-        Kokkos::deep_copy(rbuf_d, rbuf_h);
-
-        int face = (i+j+k)<0 ? nz+1 : 0;
-        float dz = g->dz;
-
-            float lw = rbuf_h(0);
-            const float rw = (2.*dz) / (lw+dz);
-            lw = (lw-dz)/(lw+dz);
-
-        Kokkos::MDRangePolicy<Kokkos::Rank<2>> yx_edge({1, 1}, {ny+1, nx+2});
-        Kokkos::MDRangePolicy<Kokkos::Rank<2>> xy_edge({1, 1}, {ny+2, nx+1});
-        Kokkos::parallel_for("end_recv<ZXY>: YX Edge loop", yx_edge, KOKKOS_LAMBDA(const int y, const int x) {
-            const int z = face;
-//            float lw = rbuf_d(0);
-//            const float rw = (2.*dz) / (lw+dz);
-//            lw = (lw-dz)/(lw+dz);
-            k_field(VOXEL(x,y,z,nx,ny,nz), field_var::cbx) = rw*rbuf_d(1 + (y-1)*(nx+1) + (x-1)) + lw*k_field(VOXEL(x+i,y+j,z+k,nx,ny,nz), field_var::cbx);
-        });
-        Kokkos::parallel_for("end_recv<ZXY>: XY Edge loop", xy_edge, KOKKOS_LAMBDA(const int y, const int x) {
-            const int z = face;
-//            float lw = rbuf_d(0);
-//            const float rw = (2.*dz) / (lw+dz);
-//            lw = (lw-dz)/(lw+dz);
-            k_field(VOXEL(x,y,z,nx,ny,nz), field_var::cby) = rw*rbuf_d(1 + ny*(nx+1) + (y-1)*nx + (x-1)) + lw*k_field(VOXEL(x+i,y+j,z+k,nx,ny,nz), field_var::cby);
-        });
-    }
-}
-
 template<typename T> void end_recv(int i, int j, int k, int nx, int ny, int nz, field_array_t* RESTRICT field, const grid_t* g) {}
 
 template<> void end_recv<XYZ>(int i, int j, int k, int nx, int ny, int nz, field_array_t* RESTRICT field, const grid_t* g) {
@@ -652,11 +539,6 @@ template<> void end_recv<ZXY>(int i, int j, int k, int nx, int ny, int nz, field
     }
 }
 
-// Completely unnecessary, only for symmetry of function calls
-template<typename T> void end_send_kokkos(const grid_t* g, int i, int j, int k) {
-    end_send_port_k(i,j,k, g);
-}
-
 void
 k_end_remote_ghost_tang_b( field_array_t      * RESTRICT field,
                          const grid_t *              g) {
@@ -682,20 +564,55 @@ kokkos_end_remote_ghost_tang_b( field_array_t      * RESTRICT field,
                          const grid_t *              g ,
                             field_buffers_t&        f_buffers) {
     const int nx = g->nx, ny = g->ny, nz = g->nz;
+    const float dx = g->dx, dy = g->dy, dz = g->dz;
+    k_field_t k_field = field->k_f_d;
+    Kokkos::View<float*> rbuf = f_buffers.tang_b_rbuf;
+
+    tang_b_offsets_t off;
+    Kokkos::Array<int,6> recv;
+    tang_b_face_offsets( g, off );
+
+    // Wait for every face before touching the device
+
+    int n_recv = 0;
+    for( int f=0; f<6; f++ ) {
+        recv[f] = end_recv_port_k( tang_b_face_ijk[f][0], tang_b_face_ijk[f][1], tang_b_face_ijk[f][2], g ) != NULL;
+        n_recv += recv[f];
+    }
+
+    if( n_recv ) {
+#ifndef VPIC_ENABLE_GPU_AWARE_MPI
+        const auto span = std::make_pair( 0, off[6] );
+        Kokkos::deep_copy( Kokkos::subview( f_buffers.tang_b_rbuf,   span ),
+                           Kokkos::subview( f_buffers.tang_b_rbuf_h, span ) );
+#endif
+
+        // Unpack every shared face in one launch. Each face only writes its
+        // own ghost plane and only reads interior values of components the
+        // other faces do not write, so the faces are independent.
+
+        Kokkos::parallel_for("kokkos_end_remote_ghost_tang_b: unpack", Kokkos::RangePolicy<>(0, off[6]),
+        KOKKOS_LAMBDA(const int idx) {
+            int f = 0;
+            while( idx >= off[f+1] ) f++;
+            const int n = idx - off[f];
+            if( !recv[f] || n==0 ) return;
+            const int axis = f%3;
+            const int s    = f<3 ? -1 : 1;
+            const float d  = axis==0 ? dx : ( axis==1 ? dy : dz );
+            float lw = rbuf(off[f]);
+            const float rw = (2.*d) / (lw + d);
+            lw = (lw - d)/(lw + d);
+            const int p = f<3 ? ( axis==0 ? nx : ( axis==1 ? ny : nz ) ) + 1 : 0;
+            int x, y, z, var;
+            tang_b_face_entry( axis, p, n-1, nx, ny, nz, x, y, z, var );
+            const int i = axis==0 ? s : 0, j = axis==1 ? s : 0, k = axis==2 ? s : 0;
+            k_field(VOXEL(x,y,z,nx,ny,nz), var) = rw*rbuf(idx) + lw*k_field(VOXEL(x+i,y+j,z+k,nx,ny,nz), var);
+        });
+    }
 
-    end_recv_kokkos<XYZ>(g, field, -1, 0, 0, nx, ny, nz, f_buffers.xyz_rbuf_neg, f_buffers.xyz_rbuf_neg_h);
-    end_recv_kokkos<YZX>(g, field, 0, -1, 0, nx, ny, nz, f_buffers.yzx_rbuf_neg, f_buffers.yzx_rbuf_neg_h);
-    end_recv_kokkos<ZXY>(g, field, 0, 0, -1, nx, ny, nz, f_buffers.zxy_rbuf_neg, f_buffers.zxy_rbuf_neg_h);
-    end_recv_kokkos<XYZ>(g, field, 1, 0, 0,  nx, ny, nz, f_buffers.xyz_rbuf_pos, f_buffers.xyz_rbuf_pos_h);
-    end_recv_kokkos<YZX>(g, field, 0, 1, 0,  nx, ny, nz, f_buffers.yzx_rbuf_pos, f_buffers.yzx_rbuf_pos_h);
-    end_recv_kokkos<ZXY>(g, field, 0, 0, 1,  nx, ny, nz, f_buffers.zxy_rbuf_pos, f_buffers.zxy_rbuf_pos_h);
-
-    end_send_kokkos<XYZ>(g, -1,0,0);
-    end_send_kokkos<YZX>(g, 0,-1,0);
-    end_send_kokkos<ZXY>(g, 0,0,-1);
-    end_send_kokkos<XYZ>(g, 1,0,0);
-    end_send_kokkos<YZX>(g, 0,1,0);
-    end_send_kokkos<ZXY>(g, 0,0,1);
+    for( int f=0; f<6; f++ )
+        end_send_port_k( tang_b_face_ijk[f][0], tang_b_face_ijk[f][1], tang_b_face_ijk[f][2], g );
 }
 
 template<typename T> void begin_recv_ghost_norm_e_kokkos(const grid_t* g, int i, int j, int k, Kokkos::View<float*>& rbuf_d, Kokkos::View<float*>::HostMirror& rbuf_h) {}
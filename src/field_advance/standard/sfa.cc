@@ -1,5 +1,6 @@
 #define IN_sfa
 #include "sfa_private.h"
+#include "../../util/checkpt/checkpt_kokkos.h"
 
 static field_advance_kernels_t sfa_kernels = {
 
@@ -179,15 +180,34 @@ destroy_sfa_params( sfa_params_t * p ) {
 
 /*****************************************************************************/
 
+// Sizes of the face buffers of field_buffers_t for grid g
+
+static void
+field_buffer_sizes( const grid_t * g,
+                    int * xyz_sz,
+                    int * yzx_sz,
+                    int * zxy_sz ) {
+  const int nx = g->nx, ny = g->ny, nz = g->nz;
+  *xyz_sz = 2*ny*(nz+1) + 2*nz*(ny+1) + ny*nz;
+  *yzx_sz = 2*nz*(nx+1) + 2*nx*(nz+1) + nz*nx;
+  *zxy_sz = 2*nx*(ny+1) + 2*ny*(nx+1) + nx*ny;
+}
+
+// The fields are checkpointed as sections straight from the device (see
+// checkpt_kokkos.h); only the storage of the legacy host array is
+// checkpointed. It is refilled by restore_kokkos.
+
 void
 checkpt_standard_field_array( const field_array_t * fa ) {
   sfa_params_t * p = (sfa_params_t *)fa->params;
-  CHECKPT( fa, 1 );
-  CHECKPT_ALIGNED( fa->f, fa->g->nv, 128 );
+  CHECKPT_KOKKOS( fa );
+  checkpt_data( fa->f, 0, fa->g->nv*sizeof(field_t), 1, 1, 128 );
   CHECKPT_PTR( fa->g );
-  CHECKPT( p, 1 );
+  CHECKPT_KOKKOS( p );
   CHECKPT_ALIGNED( p->mc, p->n_mc, 128 );
   checkpt_field_advance_kernels( fa->kernel );
+  CHECKPT_VIEW( "k_fields",      fa->k_f_d,  fa->k_f_d.extent(0) );
+  CHECKPT_VIEW( "k_field_edges", fa->k_fe_d, fa->k_fe_d.extent(0) );
 }
 
 // FIXME: Use same new/delete/checkpt/restore structure as found in emitter
@@ -198,6 +218,7 @@ field_array_t *
 restore_standard_field_array( void ) {
   field_array_t * fa;
   sfa_params_t * p;
+  int xyz_sz, yzx_sz, zxy_sz;
   RESTORE( fa );
   RESTORE_ALIGNED( fa->f );
   RESTORE_PTR( fa->g );
@@ -205,6 +226,15 @@ restore_standard_field_array( void ) {
   RESTORE_ALIGNED( p->mc );
   fa->params = p;
   restore_field_advance_kernels( fa->kernel );
+
+  // The views were checkpointed empty, so they can simply be allocated
+  field_buffer_sizes( fa->g, &xyz_sz, &yzx_sz, &zxy_sz );
+  fa->init_kokkos_fields( fa->g->nv, xyz_sz, yzx_sz, zxy_sz );
+  RESTORE_VIEW( "k_fields",      fa->k_f_d,  fa->g->nv );
+  RESTORE_VIEW( "k_field_edges", fa->k_fe_d, fa->g->nv );
+  fa->last_copied = -1; // The host array is not restored
+  p->init_kokkos_sfa_params( p->n_materials );
+  p->populate_kokkos_data();
   return fa;
 }
 
@@ -215,12 +245,8 @@ new_standard_field_array( grid_t           * RESTRICT g,
   field_array_t * fa;
   if( !g || !m_list || damp<0 ) ERROR(( "Bad args" ));
 
-  int nx = g->nx;
-  int ny = g->ny;
-  int nz = g->nz;
-  int xyz_sz = 2*ny*(nz+1) + 2*nz*(ny+1) + ny*nz;
-  int yzx_sz = 2*nz*(nx+1) + 2*nx*(nz+1) + nz*nx;
-  int zxy_sz = 2*nx*(ny+1) + 2*ny*(nx+1) + nx*ny;
+  int xyz_sz, yzx_sz, zxy_sz;
+  field_buffer_sizes( g, &xyz_sz, &yzx_sz, &zxy_sz );
 
   //MALLOC( fa, 1 );
   fa = new field_array_t(g->nv, xyz_sz, yzx_sz, zxy_sz);
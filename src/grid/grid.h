@@ -171,6 +171,13 @@ typedef struct grid {
       //      k_mpi_h = Kokkos::create_mirror_view(k_mpi_d);
   }
 
+  // Used by CHECKPT_KOKKOS
+  template<class F>
+  void for_each_kokkos_view(F f)
+  {
+      f(k_neighbor_d); f(k_neighbor_h);
+  }
+
 
 } grid_t;
 
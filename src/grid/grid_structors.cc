@@ -9,13 +9,14 @@
  */
 
 #include "grid.h"
+#include "../util/checkpt/checkpt_kokkos.h"
 
 /* Though these functions are not part of grid's public API, they must
    not be declared as static */
 
 void
 checkpt_grid( const grid_t * g ) {
-  CHECKPT( g, 1 );
+  CHECKPT_KOKKOS( g );
   if( g->range    ) CHECKPT_ALIGNED( g->range, world_size+1, 16 );
   if( g->neighbor ) CHECKPT_ALIGNED( g->neighbor, 6*g->nv, 128 );
   CHECKPT_PTR( g->mp );
@@ -30,6 +31,7 @@ restore_grid( void ) {
   if( g->neighbor ) RESTORE_ALIGNED( g->neighbor );
   RESTORE_PTR( g->mp );
   RESTORE_PTR( g->mp_k );
+  if( g->neighbor ) g->init_kokkos_grid( 6*g->nv ); // Also copies neighbor
   return g;
 }
 
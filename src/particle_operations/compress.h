@@ -251,6 +251,106 @@ struct DefaultCompress {
 
 };
 
+/**
+ * @brief Backfill the gaps left by the movers using the tail flags that
+ * advance_p records as it creates each mover.
+ *
+ * Only gaps below the new end of the array (np-nm) need filling, and they are
+ * filled from the particles in the tail [np-nm, np) which are not gaps
+ * themselves. There are exactly as many of one as of the other, so two O(nm)
+ * scans give us a list of each and we can pair them up without a data race.
+ * Nothing here needs to come back to the host.
+ *
+ * @param k_particles The array to compact
+ * @param k_particle_movers The array holding the packing mask
+ * @param nm Num movers
+ * @param np Num particles
+ * @param sp Species operating on
+ */
+struct FusedCompress {
+    static void compress(
+            k_particles_t particles,
+            k_particles_i_t particles_i,
+            k_particle_i_movers_t particle_movers_i,
+            const int32_t nm,
+            const int32_t np,
+            species_t* sp
+            )
+    {
+        Kokkos::View<int*> tail_hole = sp->tail_hole;
+
+        // If someone added particles or movers since advance_p (host
+        // injection), the tail flags no longer line up. Do it the slow way.
+        if( np != sp->tail_hole_np || nm != sp->tail_hole_nm )
+        {
+            DefaultCompress::compress(particles, particles_i, particle_movers_i, nm, np, sp);
+            if( sp->tail_hole_nm ) Kokkos::deep_copy(tail_hole, 0);
+            sp->tail_hole_np = sp->tail_hole_nm = 0;
+            return;
+        }
+
+        if( nm == 0 ) return;
+
+        Kokkos::View<int> fill_count = sp->fill_count;
+        Kokkos::View<int*> fill_from = sp->fill_from;
+        Kokkos::View<int*> fill_to = sp->fill_to;
+
+        const int max_nm = tail_hole.extent(0);
+        const int new_np = np - nm;
+
+        // Walk the tail from the last particle back, which gives a pull
+        // order consistent with VPIC's serial algorithm. Anything not
+        // flagged by advance_p is a donor.
+        Kokkos::parallel_scan("particle compress donors", Kokkos::RangePolicy <
+        Kokkos::DefaultExecutionSpace > (0, nm), KOKKOS_LAMBDA (const int r, int& offset, const bool final)
+        {
+            const int donor = !tail_hole(r);
+            if( final && donor ) fill_from(offset) = (np-1) - r;
+            offset += donor;
+        });
+
+        // Gaps in the tail vanish when np shrinks, so only keep the ones
+        // below the cut.
+        Kokkos::parallel_scan("particle compress gaps", Kokkos::RangePolicy <
+        Kokkos::DefaultExecutionSpace > (0, nm), KOKKOS_LAMBDA (const int n, int& offset, const bool final)
+        {
+            const int write_to = particle_movers_i(nm-n-1);
+            const int gap = write_to < new_np;
+            if( final )
+            {
+                if( gap ) fill_to(offset) = write_to;
+                if( n == nm-1 ) fill_count() = offset + gap;
+            }
+            offset += gap;
+        });
+
+        Kokkos::parallel_for("particle compress backfill", Kokkos::RangePolicy <
+        Kokkos::DefaultExecutionSpace > (0, nm), KOKKOS_LAMBDA (const int n)
+        {
+            // Clear the flag this mover set so the view is clean for the
+            // next step
+            const int r = (np-1) - particle_movers_i(n);
+            if( r < max_nm ) tail_hole(r) = 0;
+
+            if( n >= fill_count() ) return;
+
+            const int write_to = fill_to(n);
+            const int pull_from = fill_from(n);
+
+            particles(write_to, particle_var::dx) = particles(pull_from, particle_var::dx);
+            particles(write_to, particle_var::dy) = particles(pull_from, particle_var::dy);
+            particles(write_to, particle_var::dz) = particles(pull_from, particle_var::dz);
+            particles(write_to, particle_var::ux) = particles(pull_from, particle_var::ux);
+            particles(write_to, particle_var::uy) = particles(pull_from, particle_var::uy);
+            particles(write_to, particle_var::uz) = particles(pull_from, particle_var::uz);
+            particles(write_to, particle_var::w)  = particles(pull_from, particle_var::w);
+            particles_i(write_to) = particles_i(pull_from);
+        });
+
+        sp->tail_hole_np = sp->tail_hole_nm = 0;
+    }
+};
+
 /*
 struct SortCompress {
     static void compress(
@@ -266,9 +366,24 @@ struct SortCompress {
 };
 */
 
-template <typename Policy = DefaultCompress>
+template <typename Policy = FusedCompress>
 struct ParticleCompressor : private Policy {
-    using Policy::compress;
+    /**
+     * @brief Back fill the nm gaps left by the movers with the policy. This
+     * reorders the particles, so the cell offsets of sp are invalidated.
+     */
+    void compress(
+            k_particles_t particles,
+            k_particles_i_t particles_i,
+            k_particle_i_movers_t particle_movers_i,
+            const int32_t nm,
+            const int32_t np,
+            species_t* sp
+            )
+    {
+        if( nm ) sp->invalidate_partition();
+        Policy::compress(particles, particles_i, particle_movers_i, nm, np, sp);
+    }
 //    using Policy::test_compress;
 };
 
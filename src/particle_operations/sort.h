@@ -5,6 +5,8 @@
 #include <Kokkos_DualView.hpp>
 #include "../vpic/kokkos_helpers.h"
 #include "../vpic/kokkos_tuning.hpp"
+#include "../vpic/workspace.h"
+#include "../species_advance/species_advance.h"
 
 struct min_max_functor {
   typedef Kokkos::MinMaxScalar<Kokkos::View<int*>::non_const_value_type> minmax_scalar;
@@ -58,8 +60,8 @@ struct DefaultSort {
         Kokkos::BinSort<key_type, Comparator> bin_sort(keys, 0, np, comp, sort_within_bins );
         bin_sort.create_permute_vector();
         // Sort particle data. 
-        // If using LayoutLeft we can save memory by sorting each particle variable separately.
-	if(std::is_same<Kokkos::LayoutLeft, k_particles_t::array_layout>::value) {
+        // If using SoA we can save memory by sorting each particle variable separately.
+	if constexpr(k_particles_soa) {
 		for(int i=0; i<PARTICLE_VAR_COUNT; i++) {
 			auto sub_view = Kokkos::subview(particles, Kokkos::ALL, i);
 			bin_sort.sort(sub_view);
@@ -80,13 +82,13 @@ struct DefaultSort {
     {
         // Create permute view by taking index view and adding offsets such that we get
         // 1,2,3,1,2,3,1,2,3 instead of 1,1,1,2,2,2,3,3,3 
-	Kokkos::View<uint64_t*> keys("Temp keys", particles_i.extent(0));
+        auto keys = workspace_view<uint64_t*>(workspace_sort_keys, np);
         Kokkos::MinMaxScalar<Kokkos::View<int*>::non_const_value_type> result;
         Kokkos::MinMax<Kokkos::View<int*>::non_const_value_type> reducer(result);
         // Find max and min particle index
-        Kokkos::parallel_reduce("Get min/max bin", Kokkos::RangePolicy<>(0,particles_i.extent(0)), 
+        Kokkos::parallel_reduce("Get min/max bin", Kokkos::RangePolicy<>(0,np), 
           min_max_functor(particles_i), reducer);
-        Kokkos::View<int*> bin_counter("Counter for updating keys", num_bins);
+        auto bin_counter = workspace_view<int*>(workspace_sort_counter, num_bins);
         Kokkos::deep_copy(bin_counter, 0);
         // Count number of particles in each cell and add an offset 
         // (current number of particles in cell multiplied by the largest index)
@@ -98,7 +100,7 @@ struct DefaultSort {
         // Get the new max index
         Kokkos::MinMaxScalar<Kokkos::View<uint64_t*>::non_const_value_type> result_u64;
         Kokkos::MinMax<Kokkos::View<uint64_t*>::non_const_value_type> reducer_u64(result_u64);
-        Kokkos::parallel_reduce("Get min/max bin", Kokkos::RangePolicy<>(0,particles_i.extent(0)), 
+        Kokkos::parallel_reduce("Get min/max bin", Kokkos::RangePolicy<>(0,np), 
           min_max_functor_u64(keys), reducer_u64);
 
         // Create Comparator(number of bins, lowest val, highest val)
@@ -112,8 +114,8 @@ struct DefaultSort {
         bin_sort.create_permute_vector();
 
         // Sort particle data. 
-        // If using LayoutLeft we can save memory by sorting each particle variable separately.
-	if(std::is_same<Kokkos::LayoutLeft, k_particles_t::array_layout>::value) {
+        // If using SoA we can save memory by sorting each particle variable separately.
+	if constexpr(k_particles_soa) {
 		for(int i=0; i<PARTICLE_VAR_COUNT; i++) {
 			auto sub_view = Kokkos::subview(particles, Kokkos::ALL, i);
 			bin_sort.sort(sub_view);
@@ -137,12 +139,12 @@ struct DefaultSort {
         // 1,1,2,2,3,3,1,1,2,2,3,3 
         Kokkos::MinMaxScalar<Kokkos::View<int*>::non_const_value_type> result;
         Kokkos::MinMax<Kokkos::View<int*>::non_const_value_type> reducer(result);
-        Kokkos::View<int*> key_view("sorting keys", particles_i.extent(0));
-        Kokkos::View<int*> bin_counter("Counter for updating keys", num_bins);
-        Kokkos::deep_copy(key_view, particles_i);
+        auto key_view = workspace_view<int*>(workspace_sort_keys, np);
+        auto bin_counter = workspace_view<int*>(workspace_sort_counter, num_bins);
+        Kokkos::deep_copy(key_view, Kokkos::subview(particles_i, std::make_pair(0, np)));
         Kokkos::deep_copy(bin_counter, 0);
         // Find max and min particle index
-        Kokkos::parallel_reduce("Get min/max bin", Kokkos::RangePolicy<>(0,particles_i.extent(0)), 
+        Kokkos::parallel_reduce("Get min/max bin", Kokkos::RangePolicy<>(0,np), 
           min_max_functor(particles_i), reducer);
         // Count number of particles in each cell and add an offset 
         Kokkos::parallel_for("Update keys", Kokkos::RangePolicy<>(0, np), KOKKOS_LAMBDA(const int i) {
@@ -150,7 +152,7 @@ struct DefaultSort {
           key_view(i) += (result.max_val+1)*(count/tile_size);
         });
         // Get the new max index
-        Kokkos::parallel_reduce("Get min/max bin post update", Kokkos::RangePolicy<>(0,particles_i.extent(0)), 
+        Kokkos::parallel_reduce("Get min/max bin post update", Kokkos::RangePolicy<>(0,np), 
           min_max_functor(key_view), reducer);
         auto keys = key_view;
 
@@ -165,8 +167,8 @@ struct DefaultSort {
         bin_sort.create_permute_vector();
 
         // Sort particle data. 
-        // If using LayoutLeft we can save memory by sorting each particle variable separately.
-		if(std::is_same<Kokkos::LayoutLeft, k_particles_t::array_layout>::value) {
+        // If using SoA we can save memory by sorting each particle variable separately.
+		if constexpr(k_particles_soa) {
 			for(int i=0; i<PARTICLE_VAR_COUNT; i++) {
 				auto sub_view = Kokkos::subview(particles, Kokkos::ALL, i);
 				bin_sort.sort(sub_view);
@@ -192,12 +194,12 @@ struct DefaultSort {
         Kokkos::MinMaxScalar<Kokkos::View<int*>::non_const_value_type> nppc_result;
         Kokkos::MinMax<Kokkos::View<int*>::non_const_value_type> reducer(result);
         Kokkos::MinMax<Kokkos::View<int*>::non_const_value_type> nppc_reducer(nppc_result);
-        Kokkos::View<int*> key_view("sorting keys", particles_i.extent(0));
-        Kokkos::View<int*> bin_counter("Counter for updating keys", num_bins);
+        auto key_view = workspace_view<int*>(workspace_sort_keys, np);
+        auto bin_counter = workspace_view<int*>(workspace_sort_counter, num_bins);
         // Find max and min particle index
-        Kokkos::parallel_reduce("Get min/max bin", Kokkos::RangePolicy<>(0,particles_i.extent(0)), 
+        Kokkos::parallel_reduce("Get min/max bin", Kokkos::RangePolicy<>(0,np), 
           min_max_functor(particles_i), reducer);
-        Kokkos::deep_copy(key_view, particles_i);
+        Kokkos::deep_copy(key_view, Kokkos::subview(particles_i, std::make_pair(0, np)));
         Kokkos::deep_copy(bin_counter, 0);
         // Count number of particles in each cell
         Kokkos::parallel_for("get max nppc", Kokkos::RangePolicy<>(0, np), KOKKOS_LAMBDA(const int i) {
@@ -218,7 +220,7 @@ struct DefaultSort {
           key_view(i) += chunk*chunk_size + offset - min_idx + 1;
         });
         // Find smallest and largest index
-        Kokkos::parallel_reduce("Get min/max bin", Kokkos::RangePolicy<>(0,particles_i.extent(0)), 
+        Kokkos::parallel_reduce("Get min/max bin", Kokkos::RangePolicy<>(0,np), 
           min_max_functor(key_view), reducer);
         auto keys = key_view;
 
@@ -233,8 +235,8 @@ struct DefaultSort {
         bin_sort.create_permute_vector();
 
         // Sort particle data. 
-        // If using LayoutLeft we can save memory by sorting each particle variable separately.
-		if(std::is_same<Kokkos::LayoutLeft, k_particles_t::array_layout>::value) {
+        // If using SoA we can save memory by sorting each particle variable separately.
+		if constexpr(k_particles_soa) {
 			for(int i=0; i<PARTICLE_VAR_COUNT; i++) {
 				auto sub_view = Kokkos::subview(particles, Kokkos::ALL, i);
 				bin_sort.sort(sub_view);
@@ -245,6 +247,227 @@ struct DefaultSort {
         // Sort particle indices
         bin_sort.sort(particles_i);
     }
+
+    /**
+     * @brief Find the cell whose range in partition holds slot i, i.e.
+     * partition(c) <= i < partition(c+1). Empty cells are skipped.
+     */
+    KOKKOS_INLINE_FUNCTION
+    static int owner_cell(const Kokkos::View<int*>& partition, const int num_bins, const int i)
+    {
+        int lo = 0, hi = num_bins;
+        while( hi - lo > 1 ) {
+            const int mid = (lo + hi) / 2;
+            if( partition(mid) <= i ) lo = mid;
+            else                      hi = mid;
+        }
+        return lo;
+    }
+
+    /**
+     * @brief Counting sort that only relocates particles which are not in
+     * their cell's range, then lays out the cell table of sp with spare
+     * slots after each cell's particles (see species_t::k_partition_d).
+     * This is the full rebuild behind incremental_sort.
+     */
+    static void rebuild_cells(
+            k_particles_t particles,
+            k_particles_i_t particles_i,
+            const int32_t np,
+            const int32_t num_bins,
+            species_t* sp
+    )
+    {
+        auto first = sp->k_sort_first_d;
+        auto count = sp->k_sort_count_d;
+        auto offset = sp->k_sort_offset_d;
+        auto cursor = sp->k_sort_cursor_d;
+
+        // Count particles per cell and build the offsets of the sorted array
+        Kokkos::deep_copy(count, 0);
+        Kokkos::parallel_for("incremental sort count", Kokkos::RangePolicy<>(0, np),
+        KOKKOS_LAMBDA(const int i) {
+            Kokkos::atomic_increment(&count(particles_i(i)));
+        });
+        Kokkos::parallel_scan("incremental sort first", Kokkos::RangePolicy<>(0, num_bins),
+        KOKKOS_LAMBDA(const int c, int& update, const bool final) {
+            const int n = count(c);
+            if(final) {
+                first(c) = update;
+                if(c == num_bins-1) first(num_bins) = update + n;
+            }
+            update += n;
+        });
+
+        // Count the slots holding a particle of another cell, per owning cell.
+        // Each cell receives as many particles as it gives away, so the same
+        // count serves both the slots to fill and the particles to move.
+        Kokkos::deep_copy(count, 0);
+        Kokkos::parallel_for("incremental sort misplaced", Kokkos::RangePolicy<>(0, np),
+        KOKKOS_LAMBDA(const int i) {
+            const int c = particles_i(i);
+            if( i < first(c) || i >= first(c+1) )
+                Kokkos::atomic_increment(&count(owner_cell(first, num_bins, i)));
+        });
+        int n_move = 0;
+        Kokkos::parallel_scan("incremental sort offsets", Kokkos::RangePolicy<>(0, num_bins),
+        KOKKOS_LAMBDA(const int c, int& update, const bool final) {
+            const int n = count(c);
+            if(final) offset(c) = update;
+            update += n;
+        }, n_move);
+
+        if( n_move ) {
+            sp->resize_kokkos_sort(n_move);
+            auto slot = sp->k_sort_slot_d;
+            auto src = sp->k_sort_src_d;
+            auto copy = sp->k_sort_copy_d;
+            auto copy_i = sp->k_sort_copy_i_d;
+
+            // Slots are grouped by the cell owning them, particles by the cell
+            // they belong to, so the k-th entry of both lists match up.
+            Kokkos::deep_copy(cursor, 0);
+            Kokkos::parallel_for("incremental sort lists", Kokkos::RangePolicy<>(0, np),
+            KOKKOS_LAMBDA(const int i) {
+                const int c = particles_i(i);
+                if( i < first(c) || i >= first(c+1) ) {
+                    const int owner = owner_cell(first, num_bins, i);
+                    slot(offset(owner) + Kokkos::atomic_fetch_add(&cursor(owner), 1)) = i;
+                    src(offset(c) + Kokkos::atomic_fetch_add(&cursor(num_bins + c), 1)) = i;
+                }
+            });
+
+            // Stage the misplaced particles, then drop them into their slots
+            Kokkos::parallel_for("incremental sort gather", Kokkos::RangePolicy<>(0, n_move),
+            KOKKOS_LAMBDA(const int n) {
+                const int from = src(n);
+                for(int j=0; j<PARTICLE_VAR_COUNT; j++) copy(n, j) = particles(from, j);
+                copy_i(n) = particles_i(from);
+            });
+            Kokkos::parallel_for("incremental sort scatter", Kokkos::RangePolicy<>(0, n_move),
+            KOKKOS_LAMBDA(const int n) {
+                const int to = slot(n);
+                for(int j=0; j<PARTICLE_VAR_COUNT; j++) particles(to, j) = copy(n, j);
+                particles_i(to) = copy_i(n);
+            });
+        }
+
+        // Give every cell spare slots after its particles, so particles
+        // entering it can be listed without moving anything
+        auto partition = sp->k_partition_d;
+        auto fill = sp->k_cell_fill_d;
+        auto cell_count = sp->k_cell_count_d;
+        int n_slot = 0;
+        Kokkos::parallel_scan("incremental sort table", Kokkos::RangePolicy<>(0, num_bins),
+        KOKKOS_LAMBDA(const int c, int& update, const bool final) {
+            const int n = first(c+1) - first(c);
+            const int cap = n + n/SORT_SLACK_DIVISOR + SORT_SLACK_MIN;
+            if(final) {
+                partition(c) = update;
+                fill(c) = update + n;
+                cell_count(c) = n;
+                if(c == num_bins-1) partition(num_bins) = update + cap;
+            }
+            update += cap;
+        }, n_slot);
+
+        sp->resize_cell_table(n_slot);
+        auto table = sp->k_cell_slot_d;
+        auto home = sp->k_cell_home_d;
+        Kokkos::deep_copy(Kokkos::subview(table, std::make_pair(0, n_slot)), -1);
+        Kokkos::deep_copy(home, -1);
+        Kokkos::parallel_for("incremental sort list", Kokkos::RangePolicy<>(0, np),
+        KOKKOS_LAMBDA(const int i) {
+            const int c = particles_i(i);
+            const int t = partition(c) + (i - first(c));
+            table(t) = i;
+            home(i) = t;
+        });
+    }
+
+    /**
+     * @brief Bring the cell table of sp up to date without moving any
+     * particle. Only the particles whose slot is not in their cell's range
+     * (they changed cell, or are new at that index) are listed again, in a
+     * spare slot of their cell, and the slots of particles past np are
+     * vacated. The cell offsets themselves do not change. Returns the
+     * number of particles that found their cell full, in which case the
+     * table is inconsistent and has to be rebuilt.
+     */
+    static int update_cells(
+            k_particles_i_t particles_i,
+            const int32_t np,
+            const int32_t num_bins,
+            species_t* sp
+    )
+    {
+        auto partition = sp->k_partition_d;
+        auto fill = sp->k_cell_fill_d;
+        auto cell_count = sp->k_cell_count_d;
+        auto table = sp->k_cell_slot_d;
+        auto home = sp->k_cell_home_d;
+
+        // Slots are only ever taken at the fill cursors, past every listed
+        // particle, so a stale home never points at a slot taken here
+        const int n_scan = np > sp->partition_np ? np : sp->partition_np;
+        int n_full = 0;
+        Kokkos::parallel_reduce("incremental sort update", Kokkos::RangePolicy<>(0, n_scan),
+        KOKKOS_LAMBDA(const int i, int& full) {
+            const int t = home(i);
+            const bool listed = t >= 0 && table(t) == i;
+            if( i >= np ) {
+                if( listed ) {
+                    table(t) = -1;
+                    Kokkos::atomic_decrement(&cell_count(owner_cell(partition, num_bins, t)));
+                }
+                home(i) = -1;
+                return;
+            }
+            const int c = particles_i(i);
+            if( listed ) {
+                if( t >= partition(c) && t < partition(c+1) ) return;
+                table(t) = -1;
+                Kokkos::atomic_decrement(&cell_count(owner_cell(partition, num_bins, t)));
+            }
+            const int to = Kokkos::atomic_fetch_add(&fill(c), 1);
+            if( to >= partition(c+1) ) {
+                home(i) = -1;
+                full++;
+                return;
+            }
+            table(to) = i;
+            home(i) = to;
+            Kokkos::atomic_increment(&cell_count(c));
+        }, n_full);
+        return n_full;
+    }
+
+    /**
+     * @brief Group the particles by cell in the cell table of sp (see
+     * species_t::k_partition_d). Particles move at most a cell per step,
+     * so the table is patched in place (update_cells): the cell offsets
+     * stay as they were and only the particles that changed cell are
+     * listed again. The particle array itself is left alone until a cell
+     * runs out of spare slots; then the particles are sorted and the table
+     * laid out again (rebuild_cells). Uses the persistent scratch in sp
+     * (see species_t::init_kokkos_sort).
+     */
+    static void incremental_sort(
+            k_particles_t particles,
+            k_particles_i_t particles_i,
+            const int32_t np,
+            const int32_t num_bins,
+            species_t* sp
+    )
+    {
+        if( sp->k_cell_home_d.extent(0) < size_t(np) ) {
+            Kokkos::realloc(sp->k_cell_home_d, particles_i.extent(0));
+            sp->partition_np = -1;
+        }
+        if( sp->partition_np < 0 || update_cells(particles_i, np, num_bins, sp) )
+            rebuild_cells(particles, particles_i, np, num_bins, sp);
+        sp->partition_np = np;
+    }
 };
 
 template <typename Policy = DefaultSort>
@@ -253,12 +476,89 @@ struct ParticleSorter : private Policy {
   using Policy::strided_sort;
   using Policy::tiled_sort;
   using Policy::tiled_strided_sort;
-  void sort(k_particles_t particles, k_particles_i_t particles_i, const int32_t np, const int num_bins) {
-#ifdef SORT_TILE_SIZE // strided_tiled_sort or tiled_strided_sort
-    SORT(particles, particles_i, np, num_bins, SORT_TILE_SIZE);
-#else // standard_sort or strided_sort
-    SORT(particles, particles_i, np, num_bins);
-#endif
+  using Policy::incremental_sort;
+
+  /**
+   * @brief Sort the species with the given strategy. The automatic strategy
+   * must already have been resolved, see select.
+   */
+  void sort(species_t* sp, const int strategy, const int num_bins) {
+    // Only the incremental sort keeps the cell table, the others reorder
+    // the particles under it
+    if( strategy != sort_strategy::incremental ) sp->discard_partition();
+    switch( strategy ) {
+      case sort_strategy::standard:
+        standard_sort(sp->k_p_d, sp->k_p_i_d, sp->np, num_bins);
+        break;
+      case sort_strategy::strided:
+        strided_sort(sp->k_p_d, sp->k_p_i_d, sp->np, num_bins);
+        break;
+      case sort_strategy::tiled:
+        tiled_sort(sp->k_p_d, sp->k_p_i_d, sp->np, num_bins, sp->sort_tile_size);
+        break;
+      case sort_strategy::tiled_strided:
+        tiled_strided_sort(sp->k_p_d, sp->k_p_i_d, sp->np, num_bins, sp->sort_tile_size);
+        break;
+      case sort_strategy::incremental:
+        incremental_sort(sp->k_p_d, sp->k_p_i_d, sp->np, num_bins, sp);
+        sp->partition_valid = 1;
+        break;
+      default:
+        ERROR(( "Unknown sort strategy %i for species \"%s\"", strategy, sp->name ));
+    }
+  }
+
+  /**
+   * @brief Make sure the particles of sp are grouped by cell in its cell
+   * table (see species_t::k_partition_d). Only sorts (incrementally) if
+   * the particles were changed since the table was last brought up to
+   * date, see species_t::invalidate_partition.
+   */
+  void partition(species_t* sp, const int num_bins) {
+    if( sp->partition_valid ) return;
+    incremental_sort(sp->k_p_d, sp->k_p_i_d, sp->np, num_bins, sp);
+    sp->partition_valid = 1;
+  }
+
+  /**
+   * @brief Strategy to use for this sort of sp. For sort_strategy::automatic
+   * this hands out each strategy in turn for SORT_AUTO_TRIALS sort intervals
+   * and then settles sp->sort_method on the one with the least time recorded
+   * in sp->sort_auto_time. Sets sp->sort_auto_current to the strategy being
+   * timed, or -1 when there is nothing left to time.
+   */
+  int select(species_t* sp) {
+    sp->sort_auto_current = -1;
+    if( sp->sort_method != sort_strategy::automatic ) return sp->sort_method;
+
+    const int trial = sp->sort_auto_trial++;
+    if( trial < SORT_AUTO_TRIALS*sort_strategy::count ) {
+      sp->sort_auto_current = trial % sort_strategy::count;
+      return sp->sort_auto_current;
+    }
+
+    int best = sort_strategy::standard;
+    for( int s=0; s<sort_strategy::count; s++ )
+      if( sp->sort_auto_time[s] < sp->sort_auto_time[best] ) best = s;
+    sp->sort_method = best;
+    if( !world_rank ) MESSAGE(( "Selected sort strategy %i for \"%s\"", best, sp->name ));
+    return best;
+  }
+
+  /**
+   * @brief Grow the workspace slots the sort strategy of sp borrows so
+   * sorting the species up to sp->max_np particles does not allocate.
+   */
+  void reserve(species_t* sp, const int num_bins) {
+    const int s = sp->sort_method;
+    size_t key_size = 0;
+    if( s == sort_strategy::automatic || s == sort_strategy::strided )
+      key_size = sizeof(uint64_t);
+    else if( s == sort_strategy::tiled || s == sort_strategy::tiled_strided )
+      key_size = sizeof(int);
+    if( key_size == 0 ) return;
+    workspace_reserve(workspace_sort_keys, key_size*sp->max_np);
+    workspace_reserve(workspace_sort_counter, sizeof(int)*num_bins);
   }
 };
 
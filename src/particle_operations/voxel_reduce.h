@@ -0,0 +1,111 @@
+#ifndef PARTICLE_VOXEL_REDUCE_H
+#define PARTICLE_VOXEL_REDUCE_H
+
+#include "../vpic/kokkos_helpers.h"
+#include "../species_advance/species_advance.h"
+#include "sort.h"
+
+// Building blocks for deposits that walk the particles voxel by voxel
+// (k_accumulate_rho_p_sorted, accumulate_hydro_p_kokkos_sorted). The
+// particles of each species are partitioned by voxel and one team takes
+// each occupied voxel, summing its particles into team scratch before
+// anything is written to the grid. The particles of a voxel are found
+// through the species' cell table (see species_t::k_partition_d).
+
+typedef Kokkos::View<float*, Kokkos::DefaultExecutionSpace::scratch_memory_space,
+                     Kokkos::MemoryTraits<Kokkos::Unmanaged> > voxel_scratch_t;
+
+// Species are captured by value, so they go in fixed size batches. S
+// holds whatever the deposit needs of a species plus its cell table in
+// members named partition, slot and count.
+template<class S, int N>
+struct species_batch {
+  S s[N];
+
+  /**
+   * @brief Load up to N species from the head of sp_list, partitioning
+   * each (see ParticleSorter::partition). fill( S&, sp ) sets up the per
+   * species data, the cell table is set here. Returns the number loaded.
+   */
+  template<class Fill>
+  int load( species_t ** sp_list,
+            const int n_species,
+            const grid_t * g,
+            Fill fill ) {
+    ParticleSorter<> sorter;
+    const int ns = n_species < N ? n_species : N;
+    for( int i=0; i<ns; i++ ) {
+      species_t * sp = sp_list[i];
+      if( !sp || sp->g!=g ) ERROR(( "Bad args" ));
+      sorter.partition( sp, g->nv );
+      s[i].partition = sp->k_partition_d;
+      s[i].slot      = sp->k_cell_slot_d;
+      s[i].count     = sp->k_cell_count_d;
+      fill( s[i], sp );
+    }
+    return ns;
+  }
+};
+
+/**
+ * @brief Add x to entry m of a voxel's team scratch sums. Only needs an
+ * atomic when several threads of the team share the sums.
+ */
+KOKKOS_INLINE_FUNCTION void
+voxel_scratch_add( const voxel_scratch_t & acc,
+                   const bool shared,
+                   const int m,
+                   const float x ) {
+  if( shared ) Kokkos::atomic_add( &acc(m), x );
+  else         acc(m) += x;
+}
+
+/**
+ * @brief One team per voxel of the grid. For each occupied voxel v the
+ * team zeroes n_acc sums in scratch, calls particle( S, v, i, acc, shared )
+ * on each particle i of v of every species of the batch (spread over the
+ * team's threads, so it adds with voxel_scratch_add) and then
+ * flush( v, k, acc(k) ) for each sum k.
+ */
+template<class Batch, class Particle, class Flush>
+void
+voxel_team_reduce( const char * name,
+                   const int nv,
+                   const int n_acc,
+                   const Batch & batch,
+                   const int ns,
+                   Particle particle,
+                   Flush flush ) {
+  Kokkos::TeamPolicy<> policy( nv, Kokkos::AUTO );
+  policy.set_scratch_size( 0, Kokkos::PerTeam( voxel_scratch_t::shmem_size( n_acc ) ) );
+
+  Kokkos::parallel_for( name, policy,
+  KOKKOS_LAMBDA( const KOKKOS_TEAM_POLICY_DEVICE::member_type & team ) {
+    const int v = team.league_rank();
+    int n = 0;
+    for( int s=0; s<ns; s++ ) n += batch.s[s].count(v);
+    if( !n ) return;
+
+    voxel_scratch_t acc( team.team_scratch(0), n_acc );
+    Kokkos::parallel_for( Kokkos::TeamThreadRange( team, n_acc ),
+    [&] ( const int k ) { acc(k) = 0; } );
+    team.team_barrier();
+
+    const bool shared = team.team_size()>1;
+    for( int s=0; s<ns; s++ ) {
+      const auto & S = batch.s[s];
+      const int k0 = S.partition(v);
+      Kokkos::parallel_for( Kokkos::TeamThreadRange( team, S.partition(v+1)-k0 ),
+      [&] ( const int k ) {
+        const int i = S.slot(k0+k);
+        if( i>=0 ) particle( S, v, i, acc, shared );
+      } );
+    }
+    team.team_barrier();
+
+    Kokkos::parallel_for( Kokkos::TeamThreadRange( team, n_acc ),
+    [&] ( const int k ) { flush( v, k, acc(k) ); } );
+  });
+}
+
+#endif // PARTICLE_VOXEL_REDUCE_H
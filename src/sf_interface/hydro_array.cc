@@ -9,13 +9,14 @@
  */
 
 #include "sf_interface.h"
+#include "../util/checkpt/checkpt_kokkos.h"
 
 /* Though the checkpt/restore functions are not part of the public
    API, they must not be declared as static. */
 
 void
 checkpt_hydro_array( const hydro_array_t * ha ) {
-  CHECKPT( ha, 1 );
+  CHECKPT_KOKKOS( ha );
   CHECKPT_ALIGNED( ha->h, ha->g->nv, 128 );
   CHECKPT_PTR( ha->g );
 }
@@ -26,6 +27,7 @@ restore_hydro_array( void ) {
   RESTORE( ha );
   RESTORE_ALIGNED( ha->h );
   RESTORE_PTR( ha->g );
+  ha->init_kokkos_hydro( ha->g->nv ); // No need to populate hydro
   return ha;
 }
 
@@ -221,13 +223,108 @@ synchronize_hydro_array( hydro_array_t * ha ) {
 # undef END_SEND
 }
 
-// In my tests it is faster to copy into the legacy hydro arrays and use the
-// old synchronize than use this function, so this is unused unless a deck
-// specifically call for it, and liable to not be kept up to date.
+// Exchanges the hydro on both faces normal to axis a (0, 1, 2 for x, y,
+// z) with the neighbouring processes.  Both faces are packed by one
+// kernel into the persistent staging buffer and both sends are posted
+// before either receive is waited on; both received faces are then
+// applied by one kernel.  The buffer holds, for this axis, the negative
+// and positive send faces followed by the two receive faces, each as
+// the sender's cell width followed by HYDRO_VAR_COUNT values per node.
+
+static void
+k_exchange_hydro_faces( hydro_array_t * ha,
+                        const int a ) {
+  grid_t * g = ha->g;
+  const int b = (a+1)%3, c = (a+2)%3;
+  const int n[3]  = { g->nx, g->ny, g->nz };
+  const int st[3] = { 1, g->sy, g->sz };
+  const float d   = a==0 ? g->dx : ( a==1 ? g->dy : g->dz );
+  const int na = n[a], nb = n[b]+1, nc = n[c]+1;
+  const int sa = st[a], sb = st[b], sc = st[c];
+  const int L  = 1 + HYDRO_VAR_COUNT*nb*nc;
+
+  // Ports in the -a and +a directions, indexed by side 0 and 1
+  int port[2][3] = { { 0, 0, 0 }, { 0, 0, 0 } };
+  port[0][a] = -1; port[1][a] = 1;
+  int has[2];
+  for( int s=0; s<2; s++ ) {
+    const int bc = g->bc[ BOUNDARY( port[s][0], port[s][1], port[s][2] ) ];
+    has[s] = bc>=0 && bc<world_size;
+  }
+  if( !has[0] && !has[1] ) return;
+
+  if( (int)ha->k_sync_d.extent(0) < 4*L ) {
+    ha->k_sync_d = Kokkos::View<float*>( "k_hydro_sync", 4*L );
+    ha->k_sync_h = Kokkos::create_mirror_view( ha->k_sync_d );
+  }
+  const Kokkos::View<float*> buf = ha->k_sync_d;
+  const k_hydro_d_t k_h_d = ha->k_h_d;
+  float * buf_h = ha->k_sync_h.data();
+
+  // Side s sends the face of its own port (1 or na+1)
+  const int send_neg = has[0], send_pos = has[1];
+  Kokkos::parallel_for( "synchronize_hydro pack",
+    Kokkos::MDRangePolicy<Kokkos::Rank<3>>( {0,1,1}, {2,nc+1,nb+1} ),
+    KOKKOS_LAMBDA( const int s, const int w, const int u ) {
+      if( !( s ? send_pos : send_neg ) ) return;
+      const int v = ( s ? na+1 : 1 )*sa + u*sb + w*sc;
+      float * dst = &buf( s*L + 1 + HYDRO_VAR_COUNT*( (w-1)*nb + (u-1) ) );
+      for( int m=0; m<HYDRO_VAR_COUNT; m++ ) dst[m] = k_h_d(v, m);
+    });
+  Kokkos::deep_copy( Kokkos::subview( ha->k_sync_h, std::make_pair( 0, 2*L ) ),
+                     Kokkos::subview( ha->k_sync_d, std::make_pair( 0, 2*L ) ) );
+  buf_h[0] = d;
+  buf_h[L] = d;
+
+  const int size = L*sizeof(float);
+  for( int s=0; s<2; s++ )
+    begin_recv_port_k( port[s][0], port[s][1], port[s][2], size, g,
+                       reinterpret_cast<char*>( buf_h + (2+s)*L ) );
+  for( int s=0; s<2; s++ )
+    begin_send_port_k( port[s][0], port[s][1], port[s][2], size, g,
+                       reinterpret_cast<char*>( buf_h + s*L ) );
+
+  // What arrives on side s was sent by the neighbour on the other side,
+  // so it updates the face opposite to the port (twice weighted sum)
+  float lw[2] = { 0, 0 }, rw[2] = { 0, 0 };
+  int recv[2];
+  for( int s=0; s<2; s++ ) {
+    recv[s] = end_recv_port_k( port[s][0], port[s][1], port[s][2], g )!=NULL;
+    if( !recv[s] ) continue;
+    rw[s]  = buf_h[ (2+s)*L ];       // Remote cell width
+    lw[s]  = rw[s] + d;
+    rw[s] /= lw[s];
+    lw[s]  = d/lw[s];
+    lw[s] += lw[s];
+    rw[s] += rw[s];
+  }
+
+  if( recv[0] || recv[1] ) {
+    Kokkos::deep_copy( Kokkos::subview( ha->k_sync_d, std::make_pair( 2*L, 4*L ) ),
+                       Kokkos::subview( ha->k_sync_h, std::make_pair( 2*L, 4*L ) ) );
+    const int recv_neg = recv[0], recv_pos = recv[1];
+    const float lw0 = lw[0], lw1 = lw[1], rw0 = rw[0], rw1 = rw[1];
+    Kokkos::parallel_for( "synchronize_hydro unpack",
+      Kokkos::MDRangePolicy<Kokkos::Rank<3>>( {0,1,1}, {2,nc+1,nb+1} ),
+      KOKKOS_LAMBDA( const int s, const int w, const int u ) {
+        if( !( s ? recv_pos : recv_neg ) ) return;
+        const float l = s ? lw1 : lw0, r = s ? rw1 : rw0;
+        const int v = ( s ? 1 : na+1 )*sa + u*sb + w*sc;
+        const float * src = &buf( (2+s)*L + 1 + HYDRO_VAR_COUNT*( (w-1)*nb + (u-1) ) );
+        for( int m=0; m<HYDRO_VAR_COUNT; m++ ) k_h_d(v, m) = l*k_h_d(v, m) + r*src[m];
+      });
+  }
+
+  for( int s=0; s<2; s++ ) end_send_port_k( port[s][0], port[s][1], port[s][2], g );
+}
+
+// Device version of synchronize_hydro_array.  The axes are exchanged in
+// turn, as in the host version, so that nodes on edges and corners pick
+// up the contributions of diagonal neighbours through two (or three)
+// exchanges.
 void
 synchronize_hydro_array_kokkos( hydro_array_t * ha ) {
-  int size, face, bc, nx, ny, nz;
-  float *p, lw, rw;
+  int face, bc, nx, ny, nz;
   grid_t * g;
 
   if( !ha ) ERROR(( "NULL hydro array" ));
@@ -256,24 +353,12 @@ synchronize_hydro_array_kokkos( hydro_array_t * ha ) {
       Kokkos::parallel_for("Adjust hydro",                      \
       X##_node_policy(face),                                    \
       KOKKOS_LAMBDA(const int x, const int y, const int z) {    \
-        k_h_d(VOXEL(x,y,z,nx,ny,nz), hydro_var::jx) *= 2;       \
-        k_h_d(VOXEL(x,y,z,nx,ny,nz), hydro_var::jy) *= 2;       \
-        k_h_d(VOXEL(x,y,z,nx,ny,nz), hydro_var::jz) *= 2;       \
-        k_h_d(VOXEL(x,y,z,nx,ny,nz), hydro_var::rho) *= 2;      \
-        k_h_d(VOXEL(x,y,z,nx,ny,nz), hydro_var::px) *= 2;       \
-        k_h_d(VOXEL(x,y,z,nx,ny,nz), hydro_var::py) *= 2;       \
-        k_h_d(VOXEL(x,y,z,nx,ny,nz), hydro_var::pz) *= 2;       \
-        k_h_d(VOXEL(x,y,z,nx,ny,nz), hydro_var::ke) *= 2;       \
-        k_h_d(VOXEL(x,y,z,nx,ny,nz), hydro_var::txx) *= 2;      \
-        k_h_d(VOXEL(x,y,z,nx,ny,nz), hydro_var::tyy) *= 2;      \
-        k_h_d(VOXEL(x,y,z,nx,ny,nz), hydro_var::tzz) *= 2;      \
-        k_h_d(VOXEL(x,y,z,nx,ny,nz), hydro_var::tyz) *= 2;      \
-        k_h_d(VOXEL(x,y,z,nx,ny,nz), hydro_var::tzx) *= 2;      \
-        k_h_d(VOXEL(x,y,z,nx,ny,nz), hydro_var::txy) *= 2;      \
-      });                                       \
-    }                                           \
+        for( int m=0; m<HYDRO_VAR_COUNT; m++ )                  \
+          k_h_d(VOXEL(x,y,z,nx,ny,nz), m) *= 2;                 \
+      });                                                       \
+    }                                                           \
   } while(0)
-  
+
   ADJUST_HYDRO(-1, 0, 0,x,y,z);
   ADJUST_HYDRO( 0,-1, 0,y,z,x);
   ADJUST_HYDRO( 0, 0,-1,z,x,y);
@@ -282,234 +367,13 @@ synchronize_hydro_array_kokkos( hydro_array_t * ha ) {
   ADJUST_HYDRO( 0, 0, 1,z,x,y);
 
 # undef ADJUST_HYDRO
-  
-# define BEGIN_RECV(i,j,k,X,Y,Z) \
-  begin_recv_port(i,j,k,( 1 + 14*(n##Y+1)*(n##Z+1) )*sizeof(float),g)
-
-#define BEGIN_RECV_KOKKOS(i,j,k,X,Y,Z,recv_buff_h) \
-  begin_recv_port_k(i,j,k,(1 + 14*(n##Y+1)*(n##Z+1))*sizeof(float),g,reinterpret_cast<char*>(recv_buff_h.data()));
-
-# define BEGIN_SEND(i,j,k,X,Y,Z) BEGIN_PRIMITIVE {      \
-    size = ( 1 + 14*(n##Y+1)*(n##Z+1) )*sizeof(float);  \
-    p = (float *)size_send_port( i, j, k, size, g );    \
-    if( p ) {                                           \
-      (*(p++)) = g->d##X;                               \
-      face = (i+j+k)<0 ? 1 : n##X+1;                    \
-      X##_NODE_LOOP(face) {                             \
-        h = &hydro(x,y,z);                              \
-        (*(p++)) = h->jx;                               \
-        (*(p++)) = h->jy;                               \
-        (*(p++)) = h->jz;                               \
-        (*(p++)) = h->rho;                              \
-        (*(p++)) = h->px;                               \
-        (*(p++)) = h->py;                               \
-        (*(p++)) = h->pz;                               \
-        (*(p++)) = h->ke;                               \
-        (*(p++)) = h->txx;                              \
-        (*(p++)) = h->tyy;                              \
-        (*(p++)) = h->tzz;                              \
-        (*(p++)) = h->tyz;                              \
-        (*(p++)) = h->tzx;                              \
-        (*(p++)) = h->txy;                              \
-      }                                                 \
-      begin_send_port( i, j, k, size, g );              \
-    }                                                   \
-  } END_PRIMITIVE
+# undef x_node_policy
+# undef y_node_policy
+# undef z_node_policy
 
-# define BEGIN_SEND_KOKKOS(i,j,k,X,Y,Z,send_buff_d,send_buff_h) BEGIN_PRIMITIVE {      \
-    size = ( 1 + 14*(n##Y+1)*(n##Z+1) )*sizeof(float);  \
-    face = (i+j+k)<0 ? 1 : n##X+1;                      \
-    Kokkos::parallel_for("load vals", X##_node_policy(face), \
-    KOKKOS_LAMBDA(const int x, const int y, const int z) { \
-      send_buff_d(1+14*((Z-1)*(n##Y)+(Y-1)) + 0) = k_h_d(VOXEL(x,y,z,nx,ny,nz), hydro_var::jx); \
-      send_buff_d(1+14*((Z-1)*(n##Y)+(Y-1)) + 1) = k_h_d(VOXEL(x,y,z,nx,ny,nz), hydro_var::jy); \
-      send_buff_d(1+14*((Z-1)*(n##Y)+(Y-1)) + 2) = k_h_d(VOXEL(x,y,z,nx,ny,nz), hydro_var::jz); \
-      send_buff_d(1+14*((Z-1)*(n##Y)+(Y-1)) + 3) = k_h_d(VOXEL(x,y,z,nx,ny,nz), hydro_var::rho); \
-      send_buff_d(1+14*((Z-1)*(n##Y)+(Y-1)) + 4) = k_h_d(VOXEL(x,y,z,nx,ny,nz), hydro_var::px); \
-      send_buff_d(1+14*((Z-1)*(n##Y)+(Y-1)) + 5) = k_h_d(VOXEL(x,y,z,nx,ny,nz), hydro_var::py); \
-      send_buff_d(1+14*((Z-1)*(n##Y)+(Y-1)) + 6) = k_h_d(VOXEL(x,y,z,nx,ny,nz), hydro_var::pz); \
-      send_buff_d(1+14*((Z-1)*(n##Y)+(Y-1)) + 7) = k_h_d(VOXEL(x,y,z,nx,ny,nz), hydro_var::ke); \
-      send_buff_d(1+14*((Z-1)*(n##Y)+(Y-1)) + 8) = k_h_d(VOXEL(x,y,z,nx,ny,nz), hydro_var::txx); \
-      send_buff_d(1+14*((Z-1)*(n##Y)+(Y-1)) + 9) = k_h_d(VOXEL(x,y,z,nx,ny,nz), hydro_var::tyy); \
-      send_buff_d(1+14*((Z-1)*(n##Y)+(Y-1)) + 10) = k_h_d(VOXEL(x,y,z,nx,ny,nz), hydro_var::tzz); \
-      send_buff_d(1+14*((Z-1)*(n##Y)+(Y-1)) + 11) = k_h_d(VOXEL(x,y,z,nx,ny,nz), hydro_var::tyz); \
-      send_buff_d(1+14*((Z-1)*(n##Y)+(Y-1)) + 12) = k_h_d(VOXEL(x,y,z,nx,ny,nz), hydro_var::tzx); \
-      send_buff_d(1+14*((Z-1)*(n##Y)+(Y-1)) + 13) = k_h_d(VOXEL(x,y,z,nx,ny,nz), hydro_var::txy); \
-    }); \
-    Kokkos::deep_copy(send_buff_h, send_buff_d); \
-    send_buff_h(0) = size; \
-    begin_send_port_k(i,j,k,size,g, reinterpret_cast<char*>(send_buff_h.data())); \
-  } END_PRIMITIVE
-
-# define END_RECV(i,j,k,X,Y,Z) BEGIN_PRIMITIVE {                \
-    p = (float *)end_recv_port(i,j,k,g);                        \
-    if( p ) {                                                   \
-      rw = (*(p++));                 /* Remote g->d##X */       \
-      lw = rw + g->d##X;                                        \
-      rw /= lw;                                                 \
-      lw = g->d##X/lw;                                          \
-      lw += lw;                                                 \
-      rw += rw;                                                 \
-      face = (i+j+k)<0 ? n##X+1 : 1; /* Twice weighted sum */   \
-      X##_NODE_LOOP(face) {                                     \
-        h = &hydro(x,y,z);                                      \
-        h->jx  = lw*h->jx  + rw*(*(p++));                       \
-        h->jy  = lw*h->jy  + rw*(*(p++));                       \
-        h->jz  = lw*h->jz  + rw*(*(p++));                       \
-        h->rho = lw*h->rho + rw*(*(p++));                       \
-        h->px  = lw*h->px  + rw*(*(p++));                       \
-        h->py  = lw*h->py  + rw*(*(p++));                       \
-        h->pz  = lw*h->pz  + rw*(*(p++));                       \
-        h->ke  = lw*h->ke  + rw*(*(p++));                       \
-        h->txx = lw*h->txx + rw*(*(p++));                       \
-        h->tyy = lw*h->tyy + rw*(*(p++));                       \
-        h->tzz = lw*h->tzz + rw*(*(p++));                       \
-        h->tyz = lw*h->tyz + rw*(*(p++));                       \
-        h->tzx = lw*h->tzx + rw*(*(p++));                       \
-        h->txy = lw*h->txy + rw*(*(p++));                       \
-      }                                                         \
-    }                                                           \
-  } END_PRIMITIVE
-
-#define END_RECV_KOKKOS(i,j,k,X,Y,Z,recv_buff_d, recv_buff_h)                                           \
-BEGIN_PRIMITIVE {                                                                                       \
-  p = reinterpret_cast<float*> (end_recv_port_k(i,j,k,g));                                              \
-  if(p) {                                                                                               \
-    rw = recv_buff_h(0);                                                                                \
-    lw = rw + g->d##X;                                                                                  \
-    rw /= lw;                                                                                           \
-    lw = g->d##X/lw;                                                                                    \
-    lw += lw;                                                                                           \
-    rw += rw;                                                                                           \
-    face = (i+j+k)<0 ? n##X+1 : 1;                                                                      \
-    Kokkos::deep_copy(recv_buff_d, recv_buff_h);                                                        \
-    Kokkos::parallel_for("load vals", X##_node_policy(face),                                            \
-    KOKKOS_LAMBDA(const int x, const int y, const int z) {                                              \
-      k_h_d(VOXEL(x,y,z,nx,ny,nz), hydro_var::jx) = lw*k_h_d(VOXEL(x,y,z,nx,ny,nz), hydro_var::jx)      \
-                                                  + rw*recv_buff_d(1+14*((Z-1)*(n##Y)+(Y-1))+0);    \
-      k_h_d(VOXEL(x,y,z,nx,ny,nz), hydro_var::jy) = lw*k_h_d(VOXEL(x,y,z,nx,ny,nz), hydro_var::jy)      \
-                                                  + rw*recv_buff_d(1+14*((Z-1)*(n##Y)+(Y-1))+1);    \
-      k_h_d(VOXEL(x,y,z,nx,ny,nz), hydro_var::jz) = lw*k_h_d(VOXEL(x,y,z,nx,ny,nz), hydro_var::jz)      \
-                                                  + rw*recv_buff_d(1+14*((Z-1)*(n##Y)+(Y-1))+2);    \
-      k_h_d(VOXEL(x,y,z,nx,ny,nz), hydro_var::rho) = lw*k_h_d(VOXEL(x,y,z,nx,ny,nz), hydro_var::rho)    \
-                                                  + rw*recv_buff_d(1+14*((Z-1)*(n##Y)+(Y-1))+3);    \
-      k_h_d(VOXEL(x,y,z,nx,ny,nz), hydro_var::px) = lw*k_h_d(VOXEL(x,y,z,nx,ny,nz), hydro_var::px)      \
-                                                  + rw*recv_buff_d(1+14*((Z-1)*(n##Y)+(Y-1))+4);    \
-      k_h_d(VOXEL(x,y,z,nx,ny,nz), hydro_var::py) = lw*k_h_d(VOXEL(x,y,z,nx,ny,nz), hydro_var::py)      \
-                                                  + rw*recv_buff_d(1+14*((Z-1)*(n##Y)+(Y-1))+5);    \
-      k_h_d(VOXEL(x,y,z,nx,ny,nz), hydro_var::pz) = lw*k_h_d(VOXEL(x,y,z,nx,ny,nz), hydro_var::pz)      \
-                                                  + rw*recv_buff_d(1+14*((Z-1)*(n##Y)+(Y-1))+6);    \
-      k_h_d(VOXEL(x,y,z,nx,ny,nz), hydro_var::ke) = lw*k_h_d(VOXEL(x,y,z,nx,ny,nz), hydro_var::ke)      \
-                                                  + rw*recv_buff_d(1+14*((Z-1)*(n##Y)+(Y-1))+7);    \
-      k_h_d(VOXEL(x,y,z,nx,ny,nz), hydro_var::txx) = lw*k_h_d(VOXEL(x,y,z,nx,ny,nz), hydro_var::txx)    \
-                                                  + rw*recv_buff_d(1+14*((Z-1)*(n##Y)+(Y-1))+8);    \
-      k_h_d(VOXEL(x,y,z,nx,ny,nz), hydro_var::tyy) = lw*k_h_d(VOXEL(x,y,z,nx,ny,nz), hydro_var::tyy)    \
-                                                  + rw*recv_buff_d(1+14*((Z-1)*(n##Y)+(Y-1))+9);    \
-      k_h_d(VOXEL(x,y,z,nx,ny,nz), hydro_var::tzz) = lw*k_h_d(VOXEL(x,y,z,nx,ny,nz), hydro_var::tzz)    \
-                                                  + rw*recv_buff_d(1+14*((Z-1)*(n##Y)+(Y-1))+10);   \
-      k_h_d(VOXEL(x,y,z,nx,ny,nz), hydro_var::tyz) = lw*k_h_d(VOXEL(x,y,z,nx,ny,nz), hydro_var::tyz)    \
-                                                  + rw*recv_buff_d(1+14*((Z-1)*(n##Y)+(Y-1))+11);   \
-      k_h_d(VOXEL(x,y,z,nx,ny,nz), hydro_var::tzx) = lw*k_h_d(VOXEL(x,y,z,nx,ny,nz), hydro_var::tzx)    \
-                                                  + rw*recv_buff_d(1+14*((Z-1)*(n##Y)+(Y-1))+12);   \
-      k_h_d(VOXEL(x,y,z,nx,ny,nz), hydro_var::txy) = lw*k_h_d(VOXEL(x,y,z,nx,ny,nz), hydro_var::txy)    \
-                                                  + rw*recv_buff_d(1+14*((Z-1)*(n##Y)+(Y-1))+13);   \
-    });                                                                                                 \
-  }                                                                                                     \
-} END_PRIMITIVE
-
-# define END_SEND(i,j,k,X,Y,Z) end_send_port( i, j, k, g )
-
-#define END_SEND_KOKKOS(i,j,k,X,Y,Z) end_send_port_k(i,j,k,g);
-
-  Kokkos::View<float*> sbuf_pos_d("Send buffer pos", 1+14*(ny+1)*(nz+1));
-  Kokkos::View<float*> sbuf_neg_d("Send buffer neg", 1+14*(ny+1)*(nz+1));
-  Kokkos::View<float*> rbuf_pos_d("Recv buffer pos", 1+14*(ny+1)*(nz+1));
-  Kokkos::View<float*> rbuf_neg_d("Recv buffer neg", 1+14*(ny+1)*(nz+1));
-  Kokkos::View<float*>::HostMirror sbuf_pos_h = Kokkos::create_mirror_view(sbuf_pos_d);
-  Kokkos::View<float*>::HostMirror sbuf_neg_h = Kokkos::create_mirror_view(sbuf_neg_d);
-  Kokkos::View<float*>::HostMirror rbuf_pos_h = Kokkos::create_mirror_view(rbuf_pos_d);
-  Kokkos::View<float*>::HostMirror rbuf_neg_h = Kokkos::create_mirror_view(rbuf_neg_d);
-  BEGIN_SEND_KOKKOS(-1, 0, 0,x,y,z,sbuf_neg_d, sbuf_neg_h);
-  BEGIN_SEND_KOKKOS( 1, 0, 0,x,y,z,sbuf_pos_d, sbuf_pos_h);
-  BEGIN_RECV_KOKKOS(-1, 0, 0,x,y,z,rbuf_neg_h);
-  BEGIN_RECV_KOKKOS( 1, 0, 0,x,y,z,rbuf_pos_h);
-  END_RECV_KOKKOS(-1, 0, 0,x,y,z,rbuf_neg_d, rbuf_neg_h);
-  END_RECV_KOKKOS( 1, 0, 0,x,y,z,rbuf_pos_d, rbuf_pos_h);
-  END_SEND_KOKKOS(-1, 0, 0,x,y,z);
-  END_SEND_KOKKOS( 1, 0, 0,x,y,z);
-
-  Kokkos::resize(sbuf_pos_d, 1+14*(nz+1)*(nx+1));
-  Kokkos::resize(sbuf_neg_d, 1+14*(nz+1)*(nx+1));
-  Kokkos::resize(rbuf_pos_d, 1+14*(nz+1)*(nx+1));
-  Kokkos::resize(rbuf_neg_d, 1+14*(nz+1)*(nx+1));
-  sbuf_pos_h = Kokkos::create_mirror_view(sbuf_pos_d);
-  sbuf_neg_h = Kokkos::create_mirror_view(sbuf_neg_d);
-  rbuf_pos_h = Kokkos::create_mirror_view(rbuf_pos_d);
-  rbuf_neg_h = Kokkos::create_mirror_view(rbuf_neg_d);
-  BEGIN_SEND_KOKKOS( 0,-1, 0,y,z,x,sbuf_neg_d, sbuf_neg_h);
-  BEGIN_SEND_KOKKOS( 0, 1, 0,y,z,x,sbuf_pos_d, sbuf_pos_h);
-  BEGIN_RECV_KOKKOS( 0,-1, 0,y,z,x,rbuf_neg_h);
-  BEGIN_RECV_KOKKOS( 0, 1, 0,y,z,x,rbuf_pos_h);
-  END_RECV_KOKKOS( 0,-1, 0,y,z,x,rbuf_neg_d, rbuf_neg_h);
-  END_RECV_KOKKOS( 0, 1, 0,y,z,x,rbuf_pos_d, rbuf_pos_h);
-  END_SEND_KOKKOS( 0,-1, 0,y,z,x);
-  END_SEND_KOKKOS( 0, 1, 0,y,z,x);
-
-  Kokkos::resize(sbuf_pos_d, 1+14*(nx+1)*(ny+1));
-  Kokkos::resize(sbuf_neg_d, 1+14*(nx+1)*(ny+1));
-  Kokkos::resize(rbuf_pos_d, 1+14*(nx+1)*(ny+1));
-  Kokkos::resize(rbuf_neg_d, 1+14*(nx+1)*(ny+1));
-  sbuf_pos_h = Kokkos::create_mirror_view(sbuf_pos_d);
-  sbuf_neg_h = Kokkos::create_mirror_view(sbuf_neg_d);
-  rbuf_pos_h = Kokkos::create_mirror_view(rbuf_pos_d);
-  rbuf_neg_h = Kokkos::create_mirror_view(rbuf_neg_d);
-  BEGIN_SEND_KOKKOS( 0, 0,-1,z,x,y,sbuf_neg_d, sbuf_neg_h);
-  BEGIN_SEND_KOKKOS( 0, 0, 1,z,x,y,sbuf_pos_d, sbuf_pos_h);
-  BEGIN_RECV_KOKKOS( 0, 0,-1,z,x,y,rbuf_neg_h);
-  BEGIN_RECV_KOKKOS( 0, 0, 1,z,x,y,rbuf_pos_h);
-  END_RECV_KOKKOS( 0, 0,-1,z,x,y,rbuf_neg_d, rbuf_neg_h);
-  END_RECV_KOKKOS( 0, 0, 1,z,x,y,rbuf_pos_d, rbuf_pos_h);
-  END_SEND_KOKKOS( 0, 0,-1,z,x,y);
-  END_SEND_KOKKOS( 0, 0, 1,z,x,y);
-
-//  // Exchange x-faces
-//  BEGIN_SEND(-1, 0, 0,x,y,z);
-//  BEGIN_SEND( 1, 0, 0,x,y,z);
-//  BEGIN_RECV(-1, 0, 0,x,y,z);
-//  BEGIN_RECV( 1, 0, 0,x,y,z);
-//  END_RECV(-1, 0, 0,x,y,z);
-//  END_RECV( 1, 0, 0,x,y,z);
-//  END_SEND(-1, 0, 0,x,y,z);
-//  END_SEND( 1, 0, 0,x,y,z);
-//
-//  // Exchange y-faces
-//  BEGIN_SEND( 0,-1, 0,y,z,x);
-//  BEGIN_SEND( 0, 1, 0,y,z,x);
-//  BEGIN_RECV( 0,-1, 0,y,z,x);
-//  BEGIN_RECV( 0, 1, 0,y,z,x);
-//  END_RECV( 0,-1, 0,y,z,x);
-//  END_RECV( 0, 1, 0,y,z,x);
-//  END_SEND( 0,-1, 0,y,z,x);
-//  END_SEND( 0, 1, 0,y,z,x);
-//
-//  // Exchange z-faces
-//  BEGIN_SEND( 0, 0,-1,z,x,y);
-//  BEGIN_SEND( 0, 0, 1,z,x,y);
-//  BEGIN_RECV( 0, 0,-1,z,x,y);
-//  BEGIN_RECV( 0, 0, 1,z,x,y);
-//  END_RECV( 0, 0,-1,z,x,y);
-//  END_RECV( 0, 0, 1,z,x,y);
-//  END_SEND( 0, 0,-1,z,x,y);
-//  END_SEND( 0, 0, 1,z,x,y);
-
-# undef BEGIN_RECV
-# undef BEGIN_SEND
-# undef END_RECV
-# undef END_SEND
-# undef BEGIN_RECV_KOKKOS
-# undef BEGIN_SENV_KOKKOS
-# undef END_RECV_KOKKOS
-# undef END_SEND_KOKKOS
+  k_exchange_hydro_faces( ha, 0 );
+  k_exchange_hydro_faces( ha, 1 );
+  k_exchange_hydro_faces( ha, 2 );
 }
 
 void
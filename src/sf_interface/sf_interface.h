@@ -30,13 +30,24 @@ typedef struct interpolator {
   float _pad[2];  // 16-byte align
 } interpolator_t;
 
+// When interpolating on the fly, the particle push computes the
+// coefficients of a voxel from the fields as it needs them (see
+// interpolate_fields) and load_interpolator_array only notes which
+// fields are current.  The stored coefficients are then only loaded
+// (and allocated) by refresh_interpolator_array, which every other user
+// of k_i_d calls first.
+
 typedef struct interpolator_array {
   interpolator_t * ALIGNED(128) i;
   grid_t * g;
   k_interpolator_t k_i_d;
   k_interpolator_t::HostMirror k_i_h;
 
-  interpolator_array(int nv)
+  const field_array_t * fa; // Fields last loaded from
+  int on_the_fly;           // Interpolate from fa in the particle push
+  int stale;                // k_i_d not loaded from fa yet
+
+  interpolator_array(int nv) : fa(NULL), on_the_fly(0), stale(0)
   {
       init_kokkos_interp(nv);
   }
@@ -47,6 +58,13 @@ typedef struct interpolator_array {
     k_i_h = Kokkos::create_mirror_view(k_i_d);
   }
 
+  // Used by CHECKPT_KOKKOS
+  template<class F>
+  void for_each_kokkos_view(F f)
+  {
+    f(k_i_d); f(k_i_h);
+  }
+
   /**
    * @brief Copies the interpolator data to the host.
    */
@@ -78,6 +96,76 @@ void
 load_interpolator_array( /**/  interpolator_array_t * RESTRICT ia,
                          const field_array_t        * RESTRICT fa );
 
+// Switch ia to (from) interpolating on the fly.  Switching on frees the
+// stored coefficients until they are next needed.
+
+void
+set_interpolator_array_on_the_fly( interpolator_array_t * ia,
+                                   int on_the_fly );
+
+// Make sure k_i_d holds the coefficients of the fields last loaded.
+// A no-op unless interpolating on the fly.
+
+void
+refresh_interpolator_array( const interpolator_array_t * ia );
+
+// Interpolation coefficients of voxel v, indexed by interpolator_var,
+// computed from the fields.  sy and sz are the voxel strides in y and z.
+
+KOKKOS_INLINE_FUNCTION void
+interpolate_fields( const k_field_t & f,
+                    const int v,
+                    const int sy,
+                    const int sz,
+                    float * fi ) {
+  const float fourth = 0.25;
+  const float half   = 0.5;
+  const int vx = v + 1, vy = v + sy, vz = v + sz;
+  float w0, w1, w2, w3;
+
+  w0 = f(v,      field_var::ex);
+  w1 = f(vy,     field_var::ex);
+  w2 = f(vz,     field_var::ex);
+  w3 = f(vy+sz,  field_var::ex);
+  fi[interpolator_var::ex]       = fourth*( (w3 + w0) + (w1 + w2) );
+  fi[interpolator_var::dexdy]    = fourth*( (w3 - w0) + (w1 - w2) );
+  fi[interpolator_var::dexdz]    = fourth*( (w3 - w0) - (w1 - w2) );
+  fi[interpolator_var::d2exdydz] = fourth*( (w3 + w0) - (w1 + w2) );
+
+  w0 = f(v,      field_var::ey);
+  w1 = f(vz,     field_var::ey);
+  w2 = f(vx,     field_var::ey);
+  w3 = f(vz+1,   field_var::ey);
+  fi[interpolator_var::ey]       = fourth*( (w3 + w0) + (w1 + w2) );
+  fi[interpolator_var::deydz]    = fourth*( (w3 - w0) + (w1 - w2) );
+  fi[interpolator_var::deydx]    = fourth*( (w3 - w0) - (w1 - w2) );
+  fi[interpolator_var::d2eydzdx] = fourth*( (w3 + w0) - (w1 + w2) );
+
+  w0 = f(v,      field_var::ez);
+  w1 = f(vx,     field_var::ez);
+  w2 = f(vy,     field_var::ez);
+  w3 = f(vy+1,   field_var::ez);
+  fi[interpolator_var::ez]       = fourth*( (w3 + w0) + (w1 + w2) );
+  fi[interpolator_var::dezdx]    = fourth*( (w3 - w0) + (w1 - w2) );
+  fi[interpolator_var::dezdy]    = fourth*( (w3 - w0) - (w1 - w2) );
+  fi[interpolator_var::d2ezdxdy] = fourth*( (w3 + w0) - (w1 + w2) );
+
+  w0 = f(v,      field_var::cbx);
+  w1 = f(vx,     field_var::cbx);
+  fi[interpolator_var::cbx]      = half*( w1 + w0 );
+  fi[interpolator_var::dcbxdx]   = half*( w1 - w0 );
+
+  w0 = f(v,      field_var::cby);
+  w1 = f(vy,     field_var::cby);
+  fi[interpolator_var::cby]      = half*( w1 + w0 );
+  fi[interpolator_var::dcbydy]   = half*( w1 - w0 );
+
+  w0 = f(v,      field_var::cbz);
+  w1 = f(vz,     field_var::cbz);
+  fi[interpolator_var::cbz]      = half*( w1 + w0 );
+  fi[interpolator_var::dcbzdz]   = half*( w1 - w0 );
+}
+
 /*****************************************************************************/
 
 // Accumulator arrays shall be a
@@ -209,13 +297,29 @@ typedef struct hydro_array {
   k_hydro_d_t k_h_d;
   k_hydro_d_t::HostMirror k_h_h;
   grid_t * g;
+
+  // Staging for synchronize_hydro_array_kokkos, grown on demand
+  Kokkos::View<float*> k_sync_d;
+  Kokkos::View<float*>::HostMirror k_sync_h;
   
   hydro_array(int nv)
+  {
+    init_kokkos_hydro(nv);
+  }
+
+  void init_kokkos_hydro(int nv)
   {
     k_h_d = k_hydro_d_t("k_hydro", nv);
     k_h_h = Kokkos::create_mirror_view(k_h_d);
   }
 
+  // Used by CHECKPT_KOKKOS
+  template<class F>
+  void for_each_kokkos_view(F f)
+  {
+    f(k_h_d); f(k_h_h); f(k_sync_d); f(k_sync_h);
+  }
+
   /**
     * @brief Copies the hydro data to host legacy array
     */
@@ -249,6 +353,9 @@ clear_hydro_array( hydro_array_t * ha );
 void
 synchronize_hydro_array( hydro_array_t * ha );
 
+// As above, on the device copy (k_h_d).  Only the exchanged faces go
+// through the host.
+
 void
 synchronize_hydro_array_kokkos( hydro_array_t * ha );
 
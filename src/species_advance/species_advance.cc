@@ -10,24 +10,31 @@
 
 #include "species_advance.h"
 #include "../boundary/boundary.h"
+#include "../vpic/kokkos_tuning.hpp"
+#include "../util/checkpt/checkpt_kokkos.h"
 
 /* Private interface *********************************************************/
 
+// The particles and movers are checkpointed as sections straight from
+// the device (see checkpt_kokkos.h); only the storage of the legacy host
+// arrays is checkpointed. They are refilled by restore_kokkos.
+
 void
 checkpt_species( const species_t * sp ) {
-    //std::cout << "checkpintg " << sp->name << " with nm = " << sp->nm << std::endl;
-  CHECKPT( sp, 1 );
+  Kokkos::deep_copy( sp->k_nm_h, sp->k_nm_d );
+  const int nm = sp->k_nm_h(0);
+  CHECKPT_KOKKOS( sp );
   CHECKPT_STR( sp->name );
-  checkpt_data( sp->p,
-                sp->np    *sizeof(particle_t),
-                sp->max_np*sizeof(particle_t), 1, 1, 128 );
-  checkpt_data( sp->pm,
-                sp->nm    *sizeof(particle_mover_t),
-                sp->max_nm*sizeof(particle_mover_t), 1, 1, 128 );
+  checkpt_data( sp->p,  0, sp->max_np*sizeof(particle_t),       1, 1, 128 );
+  checkpt_data( sp->pm, 0, sp->max_nm*sizeof(particle_mover_t), 1, 1, 128 );
   CHECKPT_ALIGNED( sp->partition, sp->g->nv+1, 128 );
   CHECKPT_PTR( sp->g );
   CHECKPT_PTR( sp->next );
   CHECKPT_PTR( sp->pb_diag );
+  CHECKPT_VIEW( "k_particles",          sp->k_p_d,    sp->np );
+  CHECKPT_VIEW( "k_particles_i",        sp->k_p_i_d,  sp->np );
+  CHECKPT_VIEW( "k_particle_movers",    sp->k_pm_d,   nm );
+  CHECKPT_VIEW( "k_particle_movers_i",  sp->k_pm_i_d, nm );
 }
 
 species_t *
@@ -41,6 +48,19 @@ restore_species( void ) {
   RESTORE_PTR( sp->g );
   RESTORE_PTR( sp->next );
   RESTORE_PTR( sp->pb_diag );
+
+  // The views were checkpointed empty, so they can simply be allocated
+  sp->init_kokkos_particles();
+  sp->init_kokkos_sort( sp->g->nv );
+  sp->invalidate_partition();
+  sp->np = RESTORE_VIEW( "k_particles",   sp->k_p_d,   sp->max_np );
+  if( RESTORE_VIEW( "k_particles_i", sp->k_p_i_d, sp->max_np )!=size_t(sp->np) )
+    ERROR(( "Malformed checkpt (particle sections of \"%s\" differ)", sp->name ));
+  sp->nm = RESTORE_VIEW( "k_particle_movers", sp->k_pm_d, sp->max_nm );
+  RESTORE_VIEW( "k_particle_movers_i", sp->k_pm_i_d, sp->max_nm );
+  sp->k_nm_h(0) = sp->nm;
+  Kokkos::deep_copy( sp->k_nm_d, sp->k_nm_h );
+  sp->last_copied = -1; // The host arrays are not restored
   return sp;
 }
 
@@ -145,10 +165,19 @@ species( const char * name,
   sp->last_sorted       = INT64_MIN;
   sp->sort_interval     = sort_interval;
   sp->sort_out_of_place = sort_out_of_place;
+  sp->sort_method       = SORT_STRATEGY;
+  sp->sort_tile_size    = SORT_TILE_SIZE;
+  sp->sort_auto_trial   = 0;
+  sp->sort_auto_current = -1;
+  for( int s=0; s<sort_strategy::count; s++ ) sp->sort_auto_time[s] = 0;
+  sp->partition_valid   = 0;
+  sp->partition_np      = -1;
   MALLOC_ALIGNED( sp->partition, g->nv+1, 128 );
 
   sp->g = g;
 
+  sp->init_kokkos_sort(g->nv);
+
   sp->pb_diag = init_pb_diagnostic();
   REGISTER_OBJECT( sp->pb_diag, checkpt_pbd, restore_pbd, NULL);
 
@@ -217,6 +246,7 @@ species_t::copy_to_device()
 {
 
   k_nm_h(0) = nm;
+  invalidate_partition();
 
   // Avoid capturing this
   auto& k_particle_h = k_p_h;
@@ -284,6 +314,15 @@ species_t::copy_outbound_to_host()
   Kokkos::deep_copy(pm_h_dispz, pm_d_dispz);
   Kokkos::deep_copy(pm_i_h_subview, pm_i_d_subview);
 
+  // And the copies of the particles that made them, for boundary_p_kokkos
+  auto pc_d_subview = Kokkos::subview(k_pc_d, std::make_pair(0, nm), Kokkos::ALL);
+  auto pci_d_subview = Kokkos::subview(k_pc_i_d, std::make_pair(0, nm));
+  auto pc_h_subview = Kokkos::subview(k_pc_h, std::make_pair(0, nm), Kokkos::ALL);
+  auto pci_h_subview = Kokkos::subview(k_pc_i_h, std::make_pair(0, nm));
+
+  Kokkos::deep_copy(pc_h_subview, pc_d_subview);
+  Kokkos::deep_copy(pci_h_subview, pci_d_subview);
+
   // Avoid capturing this
   auto& k_particle_movers_h = k_pm_h;
   auto& k_particle_i_movers_h = k_pm_i_h;
@@ -305,43 +344,44 @@ void
 species_t::copy_inbound_to_device()
 {
 
-  // TODO: Why do we need particle_copy as an intermediate?
-  // currently the recv particles are in particles_recv, not particle_copy
+  // The received particles are in particles_recv on the host. Stage them
+  // in the device receive buffer and append from there
   auto pr_h_subview  = Kokkos::subview(k_pr_h,   std::make_pair(0, num_to_copy), Kokkos::ALL);
-  auto pc_h_subview  = Kokkos::subview(k_pc_h,   std::make_pair(0, num_to_copy), Kokkos::ALL);
   auto pri_h_subview = Kokkos::subview(k_pr_i_h, std::make_pair(0, num_to_copy));
-  auto pci_h_subview = Kokkos::subview(k_pc_i_h, std::make_pair(0, num_to_copy));
-  Kokkos::deep_copy(pc_h_subview, pr_h_subview);
-  Kokkos::deep_copy(pci_h_subview, pri_h_subview);
+  auto pr_d_subview  = Kokkos::subview(k_pr_d,   std::make_pair(0, num_to_copy), Kokkos::ALL);
+  auto pri_d_subview = Kokkos::subview(k_pr_i_d, std::make_pair(0, num_to_copy));
+  Kokkos::deep_copy(pr_d_subview, pr_h_subview);
+  Kokkos::deep_copy(pri_d_subview, pri_h_subview);
 
+  append_inbound_on_device();
 
-  auto pc_d_subview  = Kokkos::subview(k_pc_d,   std::make_pair(0, num_to_copy), Kokkos::ALL);
-  auto pci_d_subview = Kokkos::subview(k_pc_i_d, std::make_pair(0, num_to_copy));
-  Kokkos::deep_copy(pc_d_subview, pc_h_subview);
-  Kokkos::deep_copy(pci_d_subview, pci_h_subview);
+}
 
-  // Append it to the particles
+void
+species_t::append_inbound_on_device()
+{
 
   // Avoid capturing this
-  auto& particle_copy = k_pc_d;
-  auto& particle_copy_i = k_pc_i_d;
+  auto& particle_recv = k_pr_d;
+  auto& particle_recv_i = k_pr_i_d;
   auto& particles = k_p_d;
   auto& particles_i = k_p_i_d;
   const int npart = np;
+  if( num_to_copy ) invalidate_partition();
 
   Kokkos::parallel_for("append moved particles",
     Kokkos::RangePolicy <Kokkos::DefaultExecutionSpace> (0, num_to_copy),
     KOKKOS_LAMBDA (int i) {
 
       int npi = npart+i; // i goes from 0..n so no need for -1
-      particles(npi, particle_var::dx) = particle_copy(i, particle_var::dx);
-      particles(npi, particle_var::dy) = particle_copy(i, particle_var::dy);
-      particles(npi, particle_var::dz) = particle_copy(i, particle_var::dz);
-      particles(npi, particle_var::ux) = particle_copy(i, particle_var::ux);
-      particles(npi, particle_var::uy) = particle_copy(i, particle_var::uy);
-      particles(npi, particle_var::uz) = particle_copy(i, particle_var::uz);
-      particles(npi, particle_var::w)  = particle_copy(i, particle_var::w);
-      particles_i(npi) = particle_copy_i(i);
+      particles(npi, particle_var::dx) = particle_recv(i, particle_var::dx);
+      particles(npi, particle_var::dy) = particle_recv(i, particle_var::dy);
+      particles(npi, particle_var::dz) = particle_recv(i, particle_var::dz);
+      particles(npi, particle_var::ux) = particle_recv(i, particle_var::ux);
+      particles(npi, particle_var::uy) = particle_recv(i, particle_var::uy);
+      particles(npi, particle_var::uz) = particle_recv(i, particle_var::uz);
+      particles(npi, particle_var::w)  = particle_recv(i, particle_var::w);
+      particles_i(npi) = particle_recv_i(i);
 
     });
 
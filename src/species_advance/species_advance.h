@@ -19,6 +19,22 @@
 
 typedef int32_t species_id; // Must be 32-bit wide for particle_injector_t
 
+// Kokkos particle sort strategies. Picked per species at run time through
+// species_t::sort_method; automatic times each of the others over the first
+// few sort intervals (sort plus the advance_p calls until the next sort) and
+// keeps the fastest.
+namespace sort_strategy {
+  enum s_s {
+    automatic = -1,
+    standard = 0,   // Bin sort by voxel
+    strided,        // Interleave the particles of neighbouring voxels
+    tiled,          // Bin sort by tiles of sort_tile_size voxels
+    tiled_strided,  // Interleave voxels within each tile
+    incremental,    // Only relocate particles that left their voxel
+    count
+  };
+}
+
 // FIXME: Eventually particle_t (definitely) and ther other formats
 // (maybe) should be opaque and specific to a particular
 // species_advance implementation
@@ -56,6 +72,8 @@ typedef struct particle_injector {
   species_id sp_id;          // Species of particle
 } particle_injector_t;
 
+using k_particle_injectors_t = Kokkos::View<particle_injector_t*>;
+
 // Seems like this belongs in boundary.h
 class species_t;
 typedef struct pb_diagnostic {
@@ -104,6 +122,17 @@ class species_t {
         // sorted.
         int sort_interval;                  // How often to sort the species
         int sort_out_of_place;              // Sort method
+        int sort_method;                    // Kokkos sort, see sort_strategy
+        int sort_tile_size;                 // Voxels per tile for tiled sorts
+        int sort_auto_trial;                // Intervals timed by automatic
+        int sort_auto_current;              // Strategy being timed, or -1
+        double sort_auto_time[sort_strategy::count]; // Time spent per strategy
+        int partition_valid;                // The cell table matches the
+        /**/                                // particles (see
+        /**/                                // invalidate_partition)
+        int partition_np;                   // np the cell table was last
+        /**/                                // updated for, or -1 if it has
+        /**/                                // to be rebuilt
         int * ALIGNED(128) partition;       // Static array indexed 0:
         /**/                                // (nx+2)*(ny+2)*(nz+2).  Each value
         /**/                                // corresponds to the associated particle
@@ -153,6 +182,25 @@ class species_t {
         k_particle_copy_t::HostMirror k_pr_h;      // kokkos particles copy for received particles
         k_particle_i_copy_t::HostMirror k_pr_i_h;  // kokkos particles i copy for received particles
 
+        // Device boundary exchange (boundary_p_kokkos_device). Outbound
+        // movers are packed into max_nm injectors per face of k_pi_send_d,
+        // inbound ones arrive in k_pi_recv_d (grown on demand) and the
+        // received particles that stay local wait in k_pr_d until the
+        // compress has run. k_exchange_count_d holds the per face send
+        // counts, then the absorbed, dropped and staged (kept) counts.
+        k_particle_injectors_t k_pi_send_d;
+        k_particle_injectors_t::HostMirror k_pi_send_h;
+        k_particle_injectors_t k_pi_recv_d;
+        k_particle_injectors_t::HostMirror k_pi_recv_h;
+        k_particle_copy_t k_pr_d;
+        k_particle_i_copy_t k_pr_i_d;
+        Kokkos::View<int*> k_exchange_count_d;
+        Kokkos::View<int*>::HostMirror k_exchange_count_h;
+
+        // Staging for vpic_simulation::inject_particles (grown on demand)
+        k_particle_injectors_t k_inject_d;
+        k_particle_injectors_t::HostMirror k_inject_h;
+
         k_particle_movers_t k_pm_d;         // kokkos particle movers on device
         k_particle_i_movers_t k_pm_i_d;         // kokkos particle movers on device
 
@@ -188,6 +236,43 @@ class species_t {
         Kokkos::View<int*> clean_up_from;
         Kokkos::View<int*> clean_up_to;
 
+        // Static allocations for the fused compressor. advance_p flags each
+        // mover that lands in the last max_nm slots of the particle array
+        // (reverse indexed, 0 is the last particle), so the compressor can
+        // find its donors without another pass over the movers.
+        Kokkos::View<int*> tail_hole;
+        Kokkos::View<int> fill_count;
+        Kokkos::View<int*> fill_from;
+        Kokkos::View<int*> fill_to;
+
+        // np and nm seen by advance_p when tail_hole was filled in. If
+        // anything changes them before the compress (e.g. host particle
+        // injection) the flags are stale and we fall back.
+        int tail_hole_np = 0;
+        int tail_hole_nm = 0;
+
+        // Cell table of the incremental sort (see
+        // DefaultSort::incremental_sort), plus persistent scratch for its
+        // rebuilds. Sized once in init_kokkos_sort so that sorting does not
+        // allocate in the step loop. Voxel v owns the slots
+        // [k_partition_d(v), k_partition_d(v+1)) of k_cell_slot_d, which
+        // hold the indices of its k_cell_count_d(v) particles and -1 in the
+        // unused (spare or vacated) slots. k_cell_home_d(i) is the slot
+        // listing particle i, or -1. Valid while partition_valid is set.
+        Kokkos::View<int*> k_partition_d;      // nv+1 first slot per voxel
+        Kokkos::View<int*> k_cell_slot_d;      // particle index per slot
+        Kokkos::View<int*> k_cell_fill_d;      // nv next unused slot
+        Kokkos::View<int*> k_cell_count_d;     // nv particles listed
+        Kokkos::View<int*> k_cell_home_d;      // max_np slot per particle
+        Kokkos::View<int*> k_sort_first_d;     // nv+1 tight cell offsets
+        Kokkos::View<int*> k_sort_count_d;     // nv per cell counters
+        Kokkos::View<int*> k_sort_offset_d;    // nv per cell offsets
+        Kokkos::View<int*> k_sort_cursor_d;    // 2*nv fill cursors
+        Kokkos::View<int*> k_sort_slot_d;      // slots needing a new particle
+        Kokkos::View<int*> k_sort_src_d;       // particles needing a new slot
+        k_particle_copy_t k_sort_copy_d;       // staging for relocated particles
+        k_particle_i_copy_t k_sort_copy_i_d;
+
         // Init Kokkos Particle Arrays
         species_t(int n_particles, int n_pmovers)
         {
@@ -206,6 +291,11 @@ class species_t {
             k_pc_i_d = k_particle_i_copy_t("k_particle_copy_for_movers_i", n_pmovers);
             k_pr_h = k_particle_copy_t::HostMirror("k_particle_send_for_movers", n_pmovers);
             k_pr_i_h = k_particle_i_copy_t::HostMirror("k_particle_send_for_movers_i", n_pmovers);
+            k_pr_d = k_particle_copy_t("k_particle_recv_for_movers", n_pmovers);
+            k_pr_i_d = k_particle_i_copy_t("k_particle_recv_for_movers_i", n_pmovers);
+            k_pi_send_d = k_particle_injectors_t("k_particle_injectors_send", 6*n_pmovers);
+            k_pi_recv_d = k_particle_injectors_t("k_particle_injectors_recv", n_pmovers);
+            k_exchange_count_d = Kokkos::View<int*>("k_exchange_count", 9);
             k_pm_d = k_particle_movers_t("k_particle_movers", n_pmovers);
             k_pm_i_d = k_particle_i_movers_t("k_particle_movers_i", n_pmovers);
             k_nm_d = k_counter_t("k_nm"); // size 1 encoded in type
@@ -214,6 +304,10 @@ class species_t {
             clean_up_from_count = Kokkos::View<int>("clean up from count");
             clean_up_from = Kokkos::View<int*>("clean up from", n_pmovers);
             clean_up_to = Kokkos::View<int*>("clean up to", n_pmovers);
+            tail_hole = Kokkos::View<int*>("tail hole", n_pmovers);
+            fill_count = Kokkos::View<int>("fill count");
+            fill_from = Kokkos::View<int*>("fill from", n_pmovers);
+            fill_to = Kokkos::View<int*>("fill to", n_pmovers);
 
             k_p_h = Kokkos::create_mirror_view(k_p_d);
             k_p_i_h = Kokkos::create_mirror_view(k_p_i_d);
@@ -226,9 +320,128 @@ class species_t {
 
             k_nm_h = Kokkos::create_mirror_view(k_nm_d);
 
+            k_pi_send_h = Kokkos::create_mirror_view(k_pi_send_d);
+            k_pi_recv_h = Kokkos::create_mirror_view(k_pi_recv_d);
+            k_exchange_count_h = Kokkos::create_mirror_view(k_exchange_count_d);
+
             clean_up_from_count_h = Kokkos::create_mirror_view(clean_up_from_count);
         }
 
+        /**
+         * @brief Marks the cell table as out of date. Anything that moves
+         * particles between cells, reorders them or changes np on the
+         * device must call this, so the next ParticleSorter::partition
+         * brings the table up to date instead of handing out a stale one.
+         * The update only touches the particles whose slot no longer
+         * matches, see DefaultSort::incremental_sort.
+         */
+        void invalidate_partition()
+        {
+            partition_valid = 0;
+        }
+
+        /**
+         * @brief Like invalidate_partition, for changes that reorder most
+         * of the particles (e.g. the other sort strategies), after which
+         * the table is rebuilt rather than updated.
+         */
+        void discard_partition()
+        {
+            partition_valid = 0;
+            partition_np = -1;
+        }
+
+        /**
+         * @brief Allocates the cell table and the incremental sort scratch.
+         * The slots are allocated by the first rebuild and the relocation
+         * buffers start at max_nm; both grow on demand.
+         *
+         * @param nv Number of voxels (sort bins) in the grid
+         */
+        void init_kokkos_sort(int nv)
+        {
+            k_partition_d = Kokkos::View<int*>("k_partition", nv+1);
+            k_cell_fill_d = Kokkos::View<int*>("cell fill", nv);
+            k_cell_count_d = Kokkos::View<int*>("cell count", nv);
+            k_cell_home_d = Kokkos::View<int*>("cell home", k_p_i_d.extent(0));
+            k_sort_first_d = Kokkos::View<int*>("sort first", nv+1);
+            k_sort_count_d = Kokkos::View<int*>("sort count", nv);
+            k_sort_offset_d = Kokkos::View<int*>("sort offset", nv);
+            k_sort_cursor_d = Kokkos::View<int*>("sort cursor", 2*nv);
+            resize_kokkos_sort(max_nm);
+            discard_partition();
+        }
+
+        /**
+         * @brief Calls f on every Kokkos view of the species. Used by
+         * CHECKPT_KOKKOS (see checkpt_kokkos.h), so keep it in sync with
+         * the members above.
+         */
+        template<class F>
+        void for_each_kokkos_view(F f)
+        {
+            f(k_p_d); f(k_p_i_d); f(k_p_h); f(k_p_i_h);
+            f(k_pc_d); f(k_pc_i_d); f(k_pc_h); f(k_pc_i_h);
+            f(k_pr_h); f(k_pr_i_h);
+            f(k_pi_send_d); f(k_pi_send_h); f(k_pi_recv_d); f(k_pi_recv_h);
+            f(k_pr_d); f(k_pr_i_d);
+            f(k_exchange_count_d); f(k_exchange_count_h);
+            f(k_inject_d); f(k_inject_h);
+            f(k_pm_d); f(k_pm_i_d); f(k_pm_h); f(k_pm_i_h);
+            f(k_nm_d); f(k_nm_h);
+            f(unsafe_index); f(clean_up_to_count); f(clean_up_from_count);
+            f(clean_up_from_count_h); f(clean_up_from); f(clean_up_to);
+            f(tail_hole); f(fill_count); f(fill_from); f(fill_to);
+            f(k_partition_d); f(k_cell_slot_d); f(k_cell_fill_d);
+            f(k_cell_count_d); f(k_cell_home_d); f(k_sort_first_d);
+            f(k_sort_count_d); f(k_sort_offset_d);
+            f(k_sort_cursor_d); f(k_sort_slot_d); f(k_sort_src_d);
+            f(k_sort_copy_d); f(k_sort_copy_i_d);
+        }
+
+        /**
+         * @brief Makes sure the incremental sort can relocate n particles
+         */
+        void resize_kokkos_sort(int n)
+        {
+            if( k_sort_slot_d.extent(0) >= size_t(n) ) return;
+            Kokkos::realloc(k_sort_slot_d, n);
+            Kokkos::realloc(k_sort_src_d, n);
+            Kokkos::realloc(k_sort_copy_d, n);
+            Kokkos::realloc(k_sort_copy_i_d, n);
+        }
+
+        /**
+         * @brief Makes sure the cell table has n slots. Grows with some
+         * headroom, as the table follows np.
+         */
+        void resize_cell_table(int n)
+        {
+            if( k_cell_slot_d.extent(0) >= size_t(n) ) return;
+            Kokkos::realloc(k_cell_slot_d, n + n/8);
+        }
+
+        /**
+         * @brief Makes sure n injectors can be received by the device
+         * boundary exchange.
+         */
+        void resize_exchange_recv(int n)
+        {
+            if( k_pi_recv_d.extent(0) >= size_t(n) ) return;
+            Kokkos::realloc(k_pi_recv_d, n);
+            k_pi_recv_h = Kokkos::create_mirror_view(k_pi_recv_d);
+        }
+
+        /**
+         * @brief Makes sure n particles can be staged for injection.
+         */
+        void resize_injection(int n)
+        {
+            if( k_inject_d.extent(0) >= size_t(n) ) return;
+            Kokkos::realloc(k_inject_d, n);
+            k_inject_h = Kokkos::create_mirror_view(k_inject_d);
+        }
+
         /**
          * @brief Copies all the outbound particles and movers to the host.
          */
@@ -249,6 +462,12 @@ class species_t {
          */
         void copy_inbound_to_device();
 
+        /**
+         * @brief Appends the inbound particles staged on the device by
+         * boundary_p_kokkos_device.
+         */
+        void append_inbound_on_device();
+
 };
 
 // In species_advance.c
@@ -292,10 +511,17 @@ sort_p( species_t * RESTRICT sp );
 
 // In advance_p.cxx
 
+// With tiled, the particles are first partitioned by voxel (see
+// ParticleSorter::partition, this may reorder them) and pushed a tile of
+// voxels at a time with the interpolators and current of the tile in
+// team scratch. The partition runs every step (the previous push moved
+// particles between voxels) and is timed as part of the push.
+
 void
 advance_p( /**/  species_t            * RESTRICT sp,
                  interpolator_array_t * RESTRICT ia,
-                 field_array_t* RESTRICT fa );
+                 field_array_t* RESTRICT fa,
+                 int tiled = 0 );
 
 // In center_p.cxx
 
@@ -308,6 +534,17 @@ void
 center_p( /**/  species_t            * RESTRICT sp,
           const interpolator_array_t * RESTRICT ia );
 
+// Device version of center_p used by the particle dump.  Particles
+// [first,first+n) are centered with the device interpolators and written
+// to out(0:n-1) in particle_t layout; the species itself is not modified.
+
+void
+center_p_kokkos( const species_t            * RESTRICT sp,
+                 const interpolator_array_t * RESTRICT ia,
+                 int first,
+                 int n,
+                 Kokkos::View<particle_t*> & out );
+
 // In uncenter_p.cxx
 
 // This is the inverse of center_p.  Thus, particles with r and u at
@@ -347,6 +584,18 @@ void
 k_accumulate_rho_p( /**/  field_array_t * RESTRICT fa,
                   const species_t     * RESTRICT sp );
 
+// Deposits the charge of n_species species in one pass, summing per
+// voxel before writing rhof. With deterministic set no atomics are used
+// and the result does not depend on thread scheduling. Partitions (and
+// so may reorder) the particles of each species.
+#define RHO_P_MAX_SPECIES 8
+
+void
+k_accumulate_rho_p_sorted( /**/  field_array_t * RESTRICT fa,
+                           species_t ** sp_list,
+                           int n_species,
+                           int deterministic );
+
 void k_accumulate_rhob(
             k_field_t& kfield,
             k_particles_t& kpart,
@@ -379,6 +628,18 @@ void accumulate_hydro_p_kokkos(
         const species_t            * RESTRICT sp
 );
 
+// Adds the summed moments of n_species species to k_hydro in one pass,
+// reducing per voxel in team scratch instead of through a ScatterView.
+// Partitions (and so may reorder) the particles of each species.
+#define HYDRO_P_MAX_SPECIES 8
+
+void accumulate_hydro_p_kokkos_sorted(
+        k_hydro_d_t k_hydro,
+        species_t ** sp_list,
+        int n_species,
+        k_interpolator_t& k_interp
+);
+
 // In move_p.cxx
 int
 move_p( particle_t       * ALIGNED(128) p0,
@@ -868,35 +1129,29 @@ move_p_kokkos_host_serial(
   return 0; // Return "mover not in use"
 }
 
-// TODO: this bascially duplicates funcitonality in rho_p.cc and should be DRY'd
-template<typename kf_t, typename kp_t, typename kpi_t> // k_field_t, k_particles_t, k_particles_i_t
-void k_accumulate_rhob_single_cpu(
-        kf_t& k_rhob_accum,
-        kp_t& kpart,
-        kpi_t& kpart_i,
-        const int i,
-        const grid_t* g,
-        const float qsp
+// Bound charge of a particle at offset (dx,dy,dz) in voxel v with charge
+// q_8V*w (q_8V = qsp*r8V), split over the 8 nodes of the voxel in the
+// order v, v+1, v+sy, v+sy+1, v+sz, v+sz+1, v+sz+sy, v+sz+sy+1. Nodes on
+// the local domain surface get double the charge (see rho_p.cc).
+KOKKOS_INLINE_FUNCTION
+void k_rhob_node_weights(
+        float wn[8],
+        float dx,
+        float dy,
+        float dz,
+        float w,
+        int v,
+        const float q_8V,
+        const int nx,
+        const int ny,
+        const int nz,
+        const int sy,
+        const int sz
 )
 {
-    // Extract grid vars
-    const float r8V = g->r8V;
-    const int nx = g->nx;
-    const int ny = g->ny;
-    const int nz = g->nz;
-    const int sy = g->sy;
-    const int sz = g->sz;
-
-    // Kernel
-    //float w0 = p->dx, w1 = p->dy, w2, w3, w4, w5, w6, w7, dz = p->dz;
-    //int v = p->i, x, y, z, sy = g->sy, sz = g->sz;
-    //w7 = (qsp*g->r8V)*p->w;
-    float w0 = kpart(i, particle_var::dx);
-    float w1 = kpart(i, particle_var::dy);
-    float w7 = (qsp * r8V) * kpart(i, particle_var::w);
-    float dz = kpart(i, particle_var::dz);
-    int v = kpart_i(i);
-    //printf("\n Vars are %g, %g, %g %g\n", w0, w1, w7, dz);
+    float w0 = dx;
+    float w1 = dy;
+    float w7 = q_8V * w;
 
     float w6 = w7 - w0 * w7;
     w7 = w7 + w0 * w7;
@@ -915,56 +1170,85 @@ void k_accumulate_rhob_single_cpu(
 
     int x = v;
     int z = x/sz;
-    if(z == 1) {
-        w0 += w0;
-        w1 += w1;
-        w2 += w2;
-        w3 += w3;
-    }
-    if(z == nz) {
-        w4 += w4;
-        w5 += w5;
-        w6 += w6;
-        w7 += w7;
-    }
+    if(z == 1)  { w0 += w0; w1 += w1; w2 += w2; w3 += w3; }
+    if(z == nz) { w4 += w4; w5 += w5; w6 += w6; w7 += w7; }
     x -= sz * z;
     int y = x/sy;
-    if(y == 1) {
-        w0 += w0;
-        w1 += w1;
-        w4 += w4;
-        w5 += w5;
-    }
-    if(y == ny) {
-        w2 += w2;
-        w3 += w3;
-        w6 += w6;
-        w7 += w7;
-    }
+    if(y == 1)  { w0 += w0; w1 += w1; w4 += w4; w5 += w5; }
+    if(y == ny) { w2 += w2; w3 += w3; w6 += w6; w7 += w7; }
     x -= sy * y;
-    if(x == 1) {
-        w0 += w0;
-        w2 += w2;
-        w4 += w4;
-        w6 += w6;
-    }
-    if(x == nx) {
-        w1 += w1;
-        w3 += w3;
-        w5 += w5;
-        w7 += w7;
-    }
-    //printf("Absorbing %d into %d for %e %e %e %e %e %e %e %e \n", i, v, w0, w1, w2, w3, w4, w5, w6, w7);
+    if(x == 1)  { w0 += w0; w2 += w2; w4 += w4; w6 += w6; }
+    if(x == nx) { w1 += w1; w3 += w3; w5 += w5; w7 += w7; }
+
+    wn[0] = w0; wn[1] = w1; wn[2] = w2; wn[3] = w3;
+    wn[4] = w4; wn[5] = w5; wn[6] = w6; wn[7] = w7;
+}
+
+// TODO: this bascially duplicates funcitonality in rho_p.cc and should be DRY'd
+template<typename kf_t, typename kp_t, typename kpi_t> // k_field_t, k_particles_t, k_particles_i_t
+void k_accumulate_rhob_single_cpu(
+        kf_t& k_rhob_accum,
+        kp_t& kpart,
+        kpi_t& kpart_i,
+        const int i,
+        const grid_t* g,
+        const float qsp
+)
+{
+    const int sy = g->sy;
+    const int sz = g->sz;
+    const int v = kpart_i(i);
+
+    float w[8];
+    k_rhob_node_weights( w, kpart(i, particle_var::dx), kpart(i, particle_var::dy),
+                         kpart(i, particle_var::dz), kpart(i, particle_var::w), v,
+                         qsp * g->r8V, g->nx, g->ny, g->nz, sy, sz );
+
     // Save the bound charge to an accumulator array to be added to rhob on the
     // device later
-    k_rhob_accum(v) += w0;
-    k_rhob_accum(v+1) += w1;
-    k_rhob_accum(v+sy) += w2;
-    k_rhob_accum(v+sy+1) += w3;
-    k_rhob_accum(v+sz) += w4;
-    k_rhob_accum(v+sz+1) += w5;
-    k_rhob_accum(v+sz+sy) += w6;
-    k_rhob_accum(v+sz+sy+1) += w7;
+    k_rhob_accum(v) += w[0];
+    k_rhob_accum(v+1) += w[1];
+    k_rhob_accum(v+sy) += w[2];
+    k_rhob_accum(v+sy+1) += w[3];
+    k_rhob_accum(v+sz) += w[4];
+    k_rhob_accum(v+sz+1) += w[5];
+    k_rhob_accum(v+sz+sy) += w[6];
+    k_rhob_accum(v+sz+sy+1) += w[7];
+}
+
+// Device version of k_accumulate_rhob_single_cpu. Adds the bound charge of
+// particle i straight into rhob with atomics, so it can be called from many
+// threads at once.
+template<typename kf_t, typename kp_t, typename kpi_t> // k_field_t, particle views
+KOKKOS_INLINE_FUNCTION
+void k_accumulate_rhob_single(
+        const kf_t& k_field,
+        const kp_t& kpart,
+        const kpi_t& kpart_i,
+        const int i,
+        const float q_8V,
+        const int nx,
+        const int ny,
+        const int nz,
+        const int sy,
+        const int sz
+)
+{
+    const int v = kpart_i(i);
+
+    float w[8];
+    k_rhob_node_weights( w, kpart(i, particle_var::dx), kpart(i, particle_var::dy),
+                         kpart(i, particle_var::dz), kpart(i, particle_var::w), v,
+                         q_8V, nx, ny, nz, sy, sz );
+
+    Kokkos::atomic_add(&k_field(v,         field_var::rhob), w[0]);
+    Kokkos::atomic_add(&k_field(v+1,       field_var::rhob), w[1]);
+    Kokkos::atomic_add(&k_field(v+sy,      field_var::rhob), w[2]);
+    Kokkos::atomic_add(&k_field(v+sy+1,    field_var::rhob), w[3]);
+    Kokkos::atomic_add(&k_field(v+sz,      field_var::rhob), w[4]);
+    Kokkos::atomic_add(&k_field(v+sz+1,    field_var::rhob), w[5]);
+    Kokkos::atomic_add(&k_field(v+sz+sy,   field_var::rhob), w[6]);
+    Kokkos::atomic_add(&k_field(v+sz+sy+1, field_var::rhob), w[7]);
 }
 
 #endif // _species_advance_h_
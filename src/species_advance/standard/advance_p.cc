@@ -7,6 +7,8 @@
 #include "spa_private.h"
 #include "../../vpic/kokkos_helpers.h"
 #include "../../vpic/kokkos_tuning.hpp"
+#include "../../vpic/workspace.h"
+#include "../../particle_operations/sort.h"
 
 // Write current values to either an accumulator or directly to the fields
 template<class CurrentScatterAccess>
@@ -333,6 +335,67 @@ void load_interpolators(
 #endif
 }
 
+// Compute the interpolators of cells ii from the fields instead of
+// loading them (see interpolate_fields), once if all particles are in the
+// same cell
+template<int NumLanes>
+KOKKOS_INLINE_FUNCTION
+void compute_interpolators(
+                        float* fex,
+                        float* fdexdy,
+                        float* fdexdz,
+                        float* fd2exdydz,
+                        float* fey,
+                        float* fdeydz,
+                        float* fdeydx,
+                        float* fd2eydzdx,
+                        float* fez,
+                        float* fdezdx,
+                        float* fdezdy,
+                        float* fd2ezdxdy,
+                        float* fcbx,
+                        float* fdcbxdx,
+                        float* fcby,
+                        float* fdcbydy,
+                        float* fcbz,
+                        float* fdcbzdz,
+                        const int* ii,
+                        const int num_part,
+                        const k_field_t& k_field,
+                        const int sy,
+                        const int sz
+                        ) {
+  float vals[INTERPOLATOR_VAR_COUNT];
+  int cell = -1;
+  for(int i=0; i<num_part; i++) {
+    if(ii[i] != cell) {
+      cell = ii[i];
+      interpolate_fields(k_field, cell, sy, sz, vals);
+    }
+    fex[i]       = vals[interpolator_var::ex];
+    fdexdy[i]    = vals[interpolator_var::dexdy];
+    fdexdz[i]    = vals[interpolator_var::dexdz];
+    fd2exdydz[i] = vals[interpolator_var::d2exdydz];
+    fey[i]       = vals[interpolator_var::ey];
+    fdeydz[i]    = vals[interpolator_var::deydz];
+    fdeydx[i]    = vals[interpolator_var::deydx];
+    fd2eydzdx[i] = vals[interpolator_var::d2eydzdx];
+    fez[i]       = vals[interpolator_var::ez];
+    fdezdx[i]    = vals[interpolator_var::dezdx];
+    fdezdy[i]    = vals[interpolator_var::dezdy];
+    fd2ezdxdy[i] = vals[interpolator_var::d2ezdxdy];
+    fcbx[i]      = vals[interpolator_var::cbx];
+    fdcbxdx[i]   = vals[interpolator_var::dcbxdx];
+    fcby[i]      = vals[interpolator_var::cby];
+    fdcbydy[i]   = vals[interpolator_var::dcbydy];
+    fcbz[i]      = vals[interpolator_var::cbz];
+    fdcbzdz[i]   = vals[interpolator_var::dcbzdz];
+  }
+}
+
+// With interpolate_on_the_fly the interpolators are computed from the
+// fields (see interpolator_array_t) and k_interp is not read
+template<bool interpolate_on_the_fly>
 void
 advance_p_kokkos_unified(
         k_particles_t& k_particles,
@@ -341,6 +404,7 @@ advance_p_kokkos_unified(
         k_particle_i_copy_t& k_particle_i_copy,
         k_particle_movers_t& k_particle_movers,
         k_particle_i_movers_t& k_particle_movers_i,
+        Kokkos::View<int*>& k_tail_hole,
         k_field_sa_t k_f_sa,
         k_interpolator_t& k_interp,
         //k_particle_movers_t k_local_particle_movers,
@@ -365,6 +429,7 @@ advance_p_kokkos_unified(
   constexpr float two_fifteenths = 2./15.;
 
   k_field_t k_field = fa->k_f_d;
+  const int sy = g->sy, sz = g->sz;
   float cx = 0.25 * g->rdy * g->rdz / g->dt;
   float cy = 0.25 * g->rdz * g->rdx / g->dt;
   float cz = 0.25 * g->rdx * g->rdy / g->dt;
@@ -408,12 +473,16 @@ advance_p_kokkos_unified(
   Kokkos::deep_copy(k_nm, 0);
 
 // Determine whether to use accumulators
+// Both are persistent: the accumulators are borrowed from the workspace and
+// the field scatter view is the one of the field array. Duplicated scatter
+// views are reset once their contributions are in.
 #if defined( VPIC_ENABLE_ACCUMULATORS )
-  Kokkos::View<float*[12]> accumulator("Accumulator", k_field.extent(0));
+  k_current_accumulator_t accumulator;
+  k_current_accumulator_sa_t current_sv;
+  workspace_accumulator(k_field.extent(0), accumulator, current_sv);
   Kokkos::deep_copy(accumulator, 0);
-  auto current_sv = Kokkos::Experimental::create_scatter_view(accumulator);
 #else
-  k_field_sa_t current_sv = Kokkos::Experimental::create_scatter_view<>(k_field);;
+  k_field_sa_t current_sv = k_f_sa;
 #endif
 
 // Setting up work distribution settings
@@ -526,13 +595,22 @@ advance_p_kokkos_unified(
         ii[LANE] = pii;
       } END_VECTOR_BLOCK;
 
-      load_interpolators<num_lanes>( fex, fdexdy, fdexdz, fd2exdydz,
-                                     fey, fdeydz, fdeydx, fd2eydzdx,
-                                     fez, fdezdx, fdezdy, fd2ezdxdy,
-                                     fcbx, fdcbxdx,
-                                     fcby, fdcbydy,
-                                     fcbz, fdcbzdz,
-                                     ii, num_particles, k_interp);
+      if constexpr( interpolate_on_the_fly )
+        compute_interpolators<num_lanes>( fex, fdexdy, fdexdz, fd2exdydz,
+                                          fey, fdeydz, fdeydx, fd2eydzdx,
+                                          fez, fdezdx, fdezdy, fd2ezdxdy,
+                                          fcbx, fdcbxdx,
+                                          fcby, fdcbydy,
+                                          fcbz, fdcbzdz,
+                                          ii, num_particles, k_field, sy, sz);
+      else
+        load_interpolators<num_lanes>( fex, fdexdy, fdexdz, fd2exdydz,
+                                       fey, fdeydz, fdeydx, fd2eydzdx,
+                                       fez, fdezdx, fdezdy, fd2ezdxdy,
+                                       fcbx, fdcbxdx,
+                                       fcby, fdcbydy,
+                                       fcbz, fdcbzdz,
+                                       ii, num_particles, k_interp);
 
       BEGIN_VECTOR_BLOCK {
         // Interpolate E
@@ -701,6 +779,10 @@ advance_p_kokkos_unified(
               k_particle_copy(nm, particle_var::uz) = p_uz;
               k_particle_copy(nm, particle_var::w) = p_w;
               k_particle_i_copy(nm) = pii;
+
+              // Flag the gap for the compressor if it is near the end
+              const int r = (np-1) - static_cast<int>(p_index);
+              if( r < max_nm ) k_tail_hole(r) = 1;
             }
           }
         }
@@ -712,6 +794,7 @@ advance_p_kokkos_unified(
 
 #if defined( VPIC_ENABLE_ACCUMULATORS )
   Kokkos::Experimental::contribute(accumulator, current_sv);
+  current_sv.reset_except(accumulator);
   Kokkos::MDRangePolicy<Kokkos::Rank<3>> unload_policy({1, 1, 1}, {nz+2, ny+2, nx+2});
   Kokkos::parallel_for("unload accumulator array", unload_policy, 
   KOKKOS_LAMBDA(const int z, const int y, const int x) {
@@ -738,6 +821,7 @@ advance_p_kokkos_unified(
   });
 #else
   Kokkos::Experimental::contribute(k_field, current_sv);
+  current_sv.reset_except(k_field);
 #endif
 
 #undef p_dx
@@ -773,6 +857,7 @@ advance_p_kokkos_unified(
 #undef f_dcbzdz  
 }
 
+template<bool interpolate_on_the_fly>
 void
 advance_p_kokkos_gpu(
         k_particles_t& k_particles,
@@ -781,6 +866,7 @@ advance_p_kokkos_gpu(
         k_particle_i_copy_t& k_particle_i_copy,
         k_particle_movers_t& k_particle_movers,
         k_particle_i_movers_t& k_particle_movers_i,
+        Kokkos::View<int*>& k_tail_hole,
         k_field_sa_t k_f_sa,
         k_interpolator_t& k_interp,
         k_counter_t& k_nm,
@@ -803,7 +889,8 @@ advance_p_kokkos_gpu(
   constexpr float one_third      = 1./3.;
   constexpr float two_fifteenths = 2./15.;
   k_field_t k_field = fa->k_f_d;
-  k_field_sa_t k_f_sv = Kokkos::Experimental::create_scatter_view<>(k_field);
+  k_field_sa_t k_f_sv = k_f_sa;
+  const int sy = g->sy, sz = g->sz;
   float cx = 0.25 * g->rdy * g->rdz / g->dt;
   float cy = 0.25 * g->rdz * g->rdx / g->dt;
   float cz = 0.25 * g->rdx * g->rdy / g->dt;
@@ -819,28 +906,32 @@ advance_p_kokkos_gpu(
   #define p_w     k_particles(p_index, particle_var::w)
   #define pii     k_particles_i(p_index)
 
-  #define f_cbx k_interp(ii, interpolator_var::cbx)
-  #define f_cby k_interp(ii, interpolator_var::cby)
-  #define f_cbz k_interp(ii, interpolator_var::cbz)
-  #define f_ex  k_interp(ii, interpolator_var::ex)
-  #define f_ey  k_interp(ii, interpolator_var::ey)
-  #define f_ez  k_interp(ii, interpolator_var::ez)
+  // Interpolator of cell ii, computed into fi when interpolating on the fly
+  #define f_interp(v) ( interpolate_on_the_fly ? fi[interpolator_var::v] : \
+                                                 k_interp(ii, interpolator_var::v) )
+
+  #define f_cbx f_interp(cbx)
+  #define f_cby f_interp(cby)
+  #define f_cbz f_interp(cbz)
+  #define f_ex  f_interp(ex)
+  #define f_ey  f_interp(ey)
+  #define f_ez  f_interp(ez)
 
-  #define f_dexdy    k_interp(ii, interpolator_var::dexdy)
-  #define f_dexdz    k_interp(ii, interpolator_var::dexdz)
+  #define f_dexdy    f_interp(dexdy)
+  #define f_dexdz    f_interp(dexdz)
 
-  #define f_d2exdydz k_interp(ii, interpolator_var::d2exdydz)
-  #define f_deydx    k_interp(ii, interpolator_var::deydx)
-  #define f_deydz    k_interp(ii, interpolator_var::deydz)
+  #define f_d2exdydz f_interp(d2exdydz)
+  #define f_deydx    f_interp(deydx)
+  #define f_deydz    f_interp(deydz)
 
-  #define f_d2eydzdx k_interp(ii, interpolator_var::d2eydzdx)
-  #define f_dezdx    k_interp(ii, interpolator_var::dezdx)
-  #define f_dezdy    k_interp(ii, interpolator_var::dezdy)
+  #define f_d2eydzdx f_interp(d2eydzdx)
+  #define f_dezdx    f_interp(dezdx)
+  #define f_dezdy    f_interp(dezdy)
 
-  #define f_d2ezdxdy k_interp(ii, interpolator_var::d2ezdxdy)
-  #define f_dcbxdx   k_interp(ii, interpolator_var::dcbxdx)
-  #define f_dcbydy   k_interp(ii, interpolator_var::dcbydy)
-  #define f_dcbzdz   k_interp(ii, interpolator_var::dcbzdz)
+  #define f_d2ezdxdy f_interp(d2ezdxdy)
+  #define f_dcbxdx   f_interp(dcbxdx)
+  #define f_dcbydy   f_interp(dcbydy)
+  #define f_dcbzdz   f_interp(dcbzdz)
 
   // copy local memmbers from grid
   //auto nfaces_per_voxel = 6;
@@ -877,6 +968,8 @@ advance_p_kokkos_gpu(
     float dy   = p_dy;
     float dz   = p_dz;
     int   ii   = pii;
+    float fi[INTERPOLATOR_VAR_COUNT];
+    if constexpr( interpolate_on_the_fly ) interpolate_fields(k_field, ii, sy, sz, fi);
     float hax  = qdt_2mc*(    ( f_ex    + dy*f_dexdy    ) +
                            dz*( f_dexdz + dy*f_d2exdydz ) );
     float hay  = qdt_2mc*(    ( f_ey    + dz*f_deydz    ) +
@@ -1079,6 +1172,10 @@ advance_p_kokkos_gpu(
             k_particle_copy(nm, particle_var::w) = p_w;
             k_particle_i_copy(nm) = pii;
 
+            // Flag the gap for the compressor if it is near the end
+            const int r = (np-1) - static_cast<int>(p_index);
+            if( r < max_nm ) k_tail_hole(r) = 1;
+
             // Tag this one as having left
             //k_particles(p_index, particle_var::pi) = 999999;
 
@@ -1098,6 +1195,7 @@ advance_p_kokkos_gpu(
 #endif
   });
   Kokkos::Experimental::contribute(k_field, k_f_sv);
+  k_f_sv.reset_except(k_field);
 
 
   // TODO: abstract this manual data copy
@@ -1112,11 +1210,278 @@ advance_p_kokkos_gpu(
 
 }
 
+// Scratch of the tiled push: interpolators and current accumulators (in
+// the accumulate_current layout) of the voxels of a tile
+typedef Kokkos::View<float*[INTERPOLATOR_VAR_COUNT], Kokkos::LayoutRight,
+                     Kokkos::DefaultExecutionSpace::scratch_memory_space,
+                     Kokkos::MemoryTraits<Kokkos::Unmanaged> > tile_interpolator_t;
+typedef Kokkos::View<float*[12], Kokkos::LayoutRight,
+                     Kokkos::DefaultExecutionSpace::scratch_memory_space,
+                     Kokkos::MemoryTraits<Kokkos::Unmanaged> > tile_current_t;
+
+// Push for particles grouped by voxel (partition, cell_slot and
+// cell_count are the species' cell table, see ParticleSorter::partition).
+// Each team takes a tile of
+// ADVANCE_P_TILE_SIZE consecutive voxels, stages the interpolators of its
+// occupied voxels and a current accumulator per voxel in team scratch,
+// pushes all particles of the tile and flushes the accumulators into the
+// fields once. Particles leaving their voxel still deposit through
+// move_p_kokkos.
+template<bool interpolate_on_the_fly>
+void
+advance_p_kokkos_tiled(
+        k_particles_t& k_particles,
+        k_particles_i_t& k_particles_i,
+        k_particle_copy_t& k_particle_copy,
+        k_particle_i_copy_t& k_particle_i_copy,
+        k_particle_movers_t& k_particle_movers,
+        k_particle_i_movers_t& k_particle_movers_i,
+        Kokkos::View<int*>& k_tail_hole,
+        k_field_sa_t k_f_sa,
+        k_interpolator_t& k_interp,
+        k_counter_t& k_nm,
+        k_neighbor_t& k_neighbors,
+        const Kokkos::View<int*>& partition,
+        const Kokkos::View<int*>& cell_slot,
+        const Kokkos::View<int*>& cell_count,
+        field_array_t* RESTRICT fa,
+        const grid_t *g,
+        const float qdt_2mc,
+        const float cdt_dx,
+        const float cdt_dy,
+        const float cdt_dz,
+        const float qsp,
+        const int np,
+        const int max_nm,
+        const int nx,
+        const int ny,
+        const int nz)
+{
+
+  constexpr float one            = 1.;
+  constexpr float one_third      = 1./3.;
+  constexpr float two_fifteenths = 2./15.;
+  k_field_t k_field = fa->k_f_d;
+  k_field_sa_t k_f_sv = k_f_sa;
+  const int nv = g->nv, sy = g->sy, sz = g->sz;
+  const float cx = 0.25 * g->rdy * g->rdz / g->dt;
+  const float cy = 0.25 * g->rdz * g->rdx / g->dt;
+  const float cz = 0.25 * g->rdx * g->rdy / g->dt;
+  auto rangel = g->rangel;
+  auto rangeh = g->rangeh;
+
+  const int tile = ADVANCE_P_TILE_SIZE;
+  const int n_tile = (nv + tile - 1)/tile;
+
+  Kokkos::deep_copy(k_nm, 0);
+
+  KOKKOS_TEAM_POLICY_DEVICE policy(n_tile, Kokkos::AUTO);
+  policy.set_scratch_size(0, Kokkos::PerTeam(tile_interpolator_t::shmem_size(tile) +
+                                             tile_current_t::shmem_size(tile)));
+
+  Kokkos::parallel_for("advance_p_tiled", policy,
+  KOKKOS_LAMBDA(const KOKKOS_TEAM_POLICY_DEVICE::member_type& team) {
+    const int c0 = team.league_rank()*tile;
+    const int nc = nv-c0 < tile ? nv-c0 : tile;
+    const int p0 = partition(c0);
+    const int p1 = partition(c0+nc);
+    int n_listed = 0;
+    for(int c=0; c<nc; c++) n_listed += cell_count(c0+c);
+    if( n_listed == 0 ) return;
+
+    tile_interpolator_t fi(team.team_scratch(0), tile);
+    tile_current_t acc(team.team_scratch(0), tile);
+
+    // Stage the interpolators of the occupied voxels (ghost voxels never
+    // are, so interpolating on the fly stays inside the fields)
+    Kokkos::parallel_for(Kokkos::TeamThreadRange(team, nc), [&] (const int c) {
+      for(int j=0; j<12; j++) acc(c, j) = 0;
+      if( cell_count(c0+c) == 0 ) return;
+      if constexpr( interpolate_on_the_fly ) {
+        float f[INTERPOLATOR_VAR_COUNT];
+        interpolate_fields(k_field, c0+c, sy, sz, f);
+        for(int j=0; j<INTERPOLATOR_VAR_COUNT; j++) fi(c, j) = f[j];
+      } else {
+        for(int j=0; j<INTERPOLATOR_VAR_COUNT; j++) fi(c, j) = k_interp(c0+c, j);
+      }
+    });
+    team.team_barrier();
+
+    const bool shared = team.team_size() > 1;
+    auto k_field_scatter_access = k_f_sv.access();
+
+    // The tile's slots of the cell table, spare ones hold -1
+    Kokkos::parallel_for(Kokkos::TeamThreadRange(team, p1-p0), [&] (const int k) {
+      const int p_index = cell_slot(p0 + k);
+      if( p_index < 0 ) return;
+      // The scratch below is indexed by the particles' voxels, so a table
+      // that does not match the particles would corrupt it
+      if( p_index >= np ) Kokkos::abort("advance_p_tiled: stale cell table");
+      float v0, v1, v2, v3, v4, v5;
+
+      float dx = k_particles(p_index, particle_var::dx);   // Load position
+      float dy = k_particles(p_index, particle_var::dy);
+      float dz = k_particles(p_index, particle_var::dz);
+      const int c = k_particles_i(p_index) - c0;
+      if( c < 0 || c >= nc ) Kokkos::abort("advance_p_tiled: particle outside its tile");
+
+      #define tile_f(v) fi(c, interpolator_var::v)
+      float hax  = qdt_2mc*(    ( tile_f(ex)    + dy*tile_f(dexdy)    ) +
+                             dz*( tile_f(dexdz) + dy*tile_f(d2exdydz) ) );
+      float hay  = qdt_2mc*(    ( tile_f(ey)    + dz*tile_f(deydz)    ) +
+                             dx*( tile_f(deydx) + dz*tile_f(d2eydzdx) ) );
+      float haz  = qdt_2mc*(    ( tile_f(ez)    + dx*tile_f(dezdx)    ) +
+                             dy*( tile_f(dezdy) + dx*tile_f(d2ezdxdy) ) );
+      float cbx  = tile_f(cbx) + dx*tile_f(dcbxdx);     // Interpolate B
+      float cby  = tile_f(cby) + dy*tile_f(dcbydy);
+      float cbz  = tile_f(cbz) + dz*tile_f(dcbzdz);
+      #undef tile_f
+
+      float ux   = k_particles(p_index, particle_var::ux);   // Load momentum
+      float uy   = k_particles(p_index, particle_var::uy);
+      float uz   = k_particles(p_index, particle_var::uz);
+      float q    = k_particles(p_index, particle_var::w);
+      ux  += hax;                               // Half advance E
+      uy  += hay;
+      uz  += haz;
+      v0   = qdt_2mc/sqrtf(one + (ux*ux + (uy*uy + uz*uz)));
+      /**/                                      // Boris - scalars
+      v1   = cbx*cbx + (cby*cby + cbz*cbz);
+      v2   = (v0*v0)*v1;
+      v3   = v0*(one+v2*(one_third+v2*two_fifteenths));
+      v4   = v3/(one+v1*(v3*v3));
+      v4  += v4;
+      v0   = ux + v3*( uy*cbz - uz*cby );       // Boris - uprime
+      v1   = uy + v3*( uz*cbx - ux*cbz );
+      v2   = uz + v3*( ux*cby - uy*cbx );
+      ux  += v4*( v1*cbz - v2*cby );            // Boris - rotation
+      uy  += v4*( v2*cbx - v0*cbz );
+      uz  += v4*( v0*cby - v1*cbx );
+      ux  += hax;                               // Half advance E
+      uy  += hay;
+      uz  += haz;
+      k_particles(p_index, particle_var::ux) = ux;   // Store momentum
+      k_particles(p_index, particle_var::uy) = uy;
+      k_particles(p_index, particle_var::uz) = uz;
+
+      v0   = one/sqrtf(one + (ux*ux+ (uy*uy + uz*uz)));
+      /**/                                      // Get norm displacement
+      ux  *= cdt_dx;
+      uy  *= cdt_dy;
+      uz  *= cdt_dz;
+      ux  *= v0;
+      uy  *= v0;
+      uz  *= v0;
+      v0   = dx + ux;                           // Streak midpoint (inbnds)
+      v1   = dy + uy;
+      v2   = dz + uz;
+      v3   = v0 + ux;                           // New position
+      v4   = v1 + uy;
+      v5   = v2 + uz;
+
+      if(  v3<=one &&  v4<=one &&  v5<=one &&   // Check if inbnds
+          -v3<=one && -v4<=one && -v5<=one ) {
+
+        q *= qsp;
+        k_particles(p_index, particle_var::dx) = v3;   // Store new position
+        k_particles(p_index, particle_var::dy) = v4;
+        k_particles(p_index, particle_var::dz) = v5;
+        dx = v0;                                // Streak midpoint
+        dy = v1;
+        dz = v2;
+        v5 = q*ux*uy*uz*one_third;              // Compute correction
+
+#       define ACCUMULATE_J(X,Y,Z,offset)                              \
+        v4  = q*u##X;   /* v2 = q ux                            */  \
+        v1  = v4*d##Y;  /* v1 = q ux dy                         */  \
+        v0  = v4-v1;    /* v0 = q ux (1-dy)                     */  \
+        v1 += v4;       /* v1 = q ux (1+dy)                     */  \
+        v4  = one+d##Z; /* v4 = 1+dz                            */  \
+        v2  = v0*v4;    /* v2 = q ux (1-dy)(1+dz)               */  \
+        v3  = v1*v4;    /* v3 = q ux (1+dy)(1+dz)               */  \
+        v4  = one-d##Z; /* v4 = 1-dz                            */  \
+        v0 *= v4;       /* v0 = q ux (1-dy)(1-dz)               */  \
+        v1 *= v4;       /* v1 = q ux (1+dy)(1-dz)               */  \
+        v0 += v5;       /* v0 = q ux [ (1-dy)(1-dz) + uy*uz/3 ] */  \
+        v1 -= v5;       /* v1 = q ux [ (1+dy)(1-dz) - uy*uz/3 ] */  \
+        v2 -= v5;       /* v2 = q ux [ (1-dy)(1+dz) - uy*uz/3 ] */  \
+        v3 += v5;       /* v3 = q ux [ (1+dy)(1+dz) + uy*uz/3 ] */  \
+        if( shared ) {                                              \
+          Kokkos::atomic_add(&acc(c, offset),   v0);                \
+          Kokkos::atomic_add(&acc(c, offset+1), v1);                \
+          Kokkos::atomic_add(&acc(c, offset+2), v2);                \
+          Kokkos::atomic_add(&acc(c, offset+3), v3);                \
+        } else {                                                    \
+          acc(c, offset) += v0; acc(c, offset+1) += v1;             \
+          acc(c, offset+2) += v2; acc(c, offset+3) += v3;           \
+        }
+
+        ACCUMULATE_J( x,y,z, 0 );
+        ACCUMULATE_J( y,z,x, 4 );
+        ACCUMULATE_J( z,x,y, 8 );
+
+#       undef ACCUMULATE_J
+      } else {
+        DECLARE_ALIGNED_ARRAY( particle_mover_t, 16, local_pm, 1 );
+        local_pm->dispx = ux;
+        local_pm->dispy = uy;
+        local_pm->dispz = uz;
+        local_pm->i     = p_index;
+
+        if( move_p_kokkos( k_particles, k_particles_i, local_pm, // Unlikely
+                           k_f_sv, g, k_neighbors, rangel, rangeh, qsp, cx, cy, cz, nx, ny, nz ) )
+        {
+          if( k_nm(0) < max_nm )
+          {
+            const int nm = Kokkos::atomic_fetch_add( &k_nm(0), 1 );
+            if (nm >= max_nm) Kokkos::abort("overran max_nm");
+
+            k_particle_movers(nm, particle_mover_var::dispx) = local_pm->dispx;
+            k_particle_movers(nm, particle_mover_var::dispy) = local_pm->dispy;
+            k_particle_movers(nm, particle_mover_var::dispz) = local_pm->dispz;
+            k_particle_movers_i(nm)   = local_pm->i;
+
+            for(int j=0; j<PARTICLE_VAR_COUNT; j++)
+              k_particle_copy(nm, j) = k_particles(p_index, j);
+            k_particle_i_copy(nm) = k_particles_i(p_index);
+
+            // Flag the gap for the compressor if it is near the end
+            const int r = (np-1) - p_index;
+            if( r < max_nm ) k_tail_hole(r) = 1;
+          }
+        }
+      }
+    });
+    team.team_barrier();
+
+    // Flush the current of the tile, once per occupied voxel
+    Kokkos::parallel_for(Kokkos::TeamThreadRange(team, nc), [&] (const int c) {
+      const int v = c0 + c;
+      if( cell_count(v) == 0 ) return;
+      k_field_scatter_access(v,         field_var::jfx) += cx*acc(c, 0);
+      k_field_scatter_access(v+sy,      field_var::jfx) += cx*acc(c, 1);
+      k_field_scatter_access(v+sz,      field_var::jfx) += cx*acc(c, 2);
+      k_field_scatter_access(v+sy+sz,   field_var::jfx) += cx*acc(c, 3);
+      k_field_scatter_access(v,         field_var::jfy) += cy*acc(c, 4);
+      k_field_scatter_access(v+sz,      field_var::jfy) += cy*acc(c, 5);
+      k_field_scatter_access(v+1,       field_var::jfy) += cy*acc(c, 6);
+      k_field_scatter_access(v+1+sz,    field_var::jfy) += cy*acc(c, 7);
+      k_field_scatter_access(v,         field_var::jfz) += cz*acc(c, 8);
+      k_field_scatter_access(v+1,       field_var::jfz) += cz*acc(c, 9);
+      k_field_scatter_access(v+sy,      field_var::jfz) += cz*acc(c, 10);
+      k_field_scatter_access(v+1+sy,    field_var::jfz) += cz*acc(c, 11);
+    });
+  });
+  Kokkos::Experimental::contribute(k_field, k_f_sv);
+  k_f_sv.reset_except(k_field);
+}
+
 void
 advance_p( /**/  species_t            * RESTRICT sp,
 //           accumulator_array_t * RESTRICT aa,
            interpolator_array_t * RESTRICT ia,
-           field_array_t* RESTRICT fa ) {
+           field_array_t* RESTRICT fa,
+           int tiled ) {
   //DECLARE_ALIGNED_ARRAY( advance_p_pipeline_args_t, 128, args, 1 );
   //DECLARE_ALIGNED_ARRAY( particle_mover_seg_t, 128, seg, MAX_PIPELINE+1 );
   //int rank;
@@ -1147,32 +1512,83 @@ advance_p( /**/  species_t            * RESTRICT sp,
     // Portable kernel with additional vectorization options
     #define ADVANCE_P advance_p_kokkos_unified
   #endif
+  // Instantiate the push for where the interpolators come from
+  auto advance = [&]( auto interpolate_on_the_fly ) {
+    if( tiled ) {
+      advance_p_kokkos_tiled<decltype(interpolate_on_the_fly)::value>(
+            sp->k_p_d,
+            sp->k_p_i_d,
+            sp->k_pc_d,
+            sp->k_pc_i_d,
+            sp->k_pm_d,
+            sp->k_pm_i_d,
+            sp->tail_hole,
+            fa->k_field_sa_d,
+            ia->k_i_d,
+            sp->k_nm_d,
+            sp->g->k_neighbor_d,
+            sp->k_partition_d,
+            sp->k_cell_slot_d,
+            sp->k_cell_count_d,
+            fa,
+            sp->g,
+            qdt_2mc,
+            cdt_dx,
+            cdt_dy,
+            cdt_dz,
+            sp->q,
+            sp->np,
+            sp->max_nm,
+            sp->g->nx,
+            sp->g->ny,
+            sp->g->nz
+      );
+      return;
+    }
+    ADVANCE_P<decltype(interpolate_on_the_fly)::value>(
+            sp->k_p_d,
+            sp->k_p_i_d,
+            sp->k_pc_d,
+            sp->k_pc_i_d,
+            sp->k_pm_d,
+            sp->k_pm_i_d,
+            sp->tail_hole,
+            fa->k_field_sa_d,
+            ia->k_i_d,
+            sp->k_nm_d,
+            sp->g->k_neighbor_d,
+            fa,
+            sp->g,
+            qdt_2mc,
+            cdt_dx,
+            cdt_dy,
+            cdt_dz,
+            sp->q,
+            sp->np,
+            sp->max_nm,
+            sp->g->nx,
+            sp->g->ny,
+            sp->g->nz
+    );
+  };
   KOKKOS_TIC();
-  ADVANCE_P(
-          sp->k_p_d,
-          sp->k_p_i_d,
-          sp->k_pc_d,
-          sp->k_pc_i_d,
-          sp->k_pm_d,
-          sp->k_pm_i_d,
-          fa->k_field_sa_d,
-          ia->k_i_d,
-          sp->k_nm_d,
-          sp->g->k_neighbor_d,
-          fa,
-          sp->g,
-          qdt_2mc,
-          cdt_dx,
-          cdt_dy,
-          cdt_dz,
-          sp->q,
-          sp->np,
-          sp->max_nm,
-          sp->g->nx,
-          sp->g->ny,
-          sp->g->nz
-  );
+  // The tiled push works through the particles voxel by voxel. The push
+  // left the cell table stale last step, so this is an (incremental) sort
+  // every step whatever the sort interval; it is part of the cost of the
+  // tiled push and timed with it.
+  if( tiled ) {
+    ParticleSorter<> sorter;
+    sorter.partition( sp, sp->g->nv );
+  }
+  if( ia->on_the_fly ) advance( std::true_type() );
+  else                 advance( std::false_type() );
   KOKKOS_TOC( advance_p, 1);
+  // The push moves particles between cells
+  sp->invalidate_partition();
+  // The particle stream alone: each particle is read (7 floats and the
+  // voxel index) and its position and momentum written back. Interpolator
+  // and current traffic depend on the sort order and are not counted.
+  PROFILE_WORK( advance_p, (sizeof(particle_t)+6.*sizeof(float))*sp->np, sp->np );
 
   KOKKOS_TIC();
   // I need to know the number of movers that got populated so I can call the
@@ -1180,21 +1596,12 @@ advance_p( /**/  species_t            * RESTRICT sp,
   Kokkos::deep_copy(sp->k_nm_h, sp->k_nm_d);
   // TODO: which way round should this copy be?
 
-  //  int nm = sp->k_nm_h(0);
-
-  //  printf("nm = %d \n", nm);
-
-  // Copy particle mirror movers back so we have their data safe. Ready for
-  // boundary_p_kokkos
-  auto pc_d_subview = Kokkos::subview(sp->k_pc_d, std::make_pair(0, sp->k_nm_h(0)), Kokkos::ALL);
-  auto pci_d_subview = Kokkos::subview(sp->k_pc_i_d, std::make_pair(0, sp->k_nm_h(0)));
-  auto pc_h_subview = Kokkos::subview(sp->k_pc_h, std::make_pair(0, sp->k_nm_h(0)), Kokkos::ALL);
-  auto pci_h_subview = Kokkos::subview(sp->k_pc_i_h, std::make_pair(0, sp->k_nm_h(0)));
+  // Remember what the tail flags were built against
+  sp->tail_hole_np = sp->np;
+  sp->tail_hole_nm = sp->k_nm_h(0);
 
-  Kokkos::deep_copy(pc_h_subview, pc_d_subview);
-  Kokkos::deep_copy(pci_h_subview, pci_d_subview);
-  //  Kokkos::deep_copy(sp->k_pc_h, sp->k_pc_d);
-  //  Kokkos::deep_copy(sp->k_pc_i_h, sp->k_pc_i_d);
+  // The mover particle copies are left on the device. Whoever processes the
+  // boundaries pulls them over if needed (see copy_outbound_to_host)
 
   KOKKOS_TOC( PARTICLE_DATA_MOVEMENT, 1);
 }
@@ -164,3 +164,77 @@ center_p( /**/  species_t            * RESTRICT sp,
   EXEC_PIPELINES( center_p, args, 0 );
   WAIT_PIPELINES();
 }
+
+void
+center_p_kokkos( const species_t            * RESTRICT sp,
+                 const interpolator_array_t * RESTRICT ia,
+                 int first,
+                 int n,
+                 Kokkos::View<particle_t*> & out ) {
+
+  if( !sp || !ia || sp->g!=ia->g || first<0 || n<0 || first+n>sp->np ||
+      n>int(out.extent(0)) ) ERROR(( "Bad args" ));
+  refresh_interpolator_array( ia );
+
+  const k_particles_t & k_particles     = sp->k_p_d;
+  const k_particles_i_t & k_particles_i = sp->k_p_i_d;
+  const k_interpolator_t & k_interp     = ia->k_i_d;
+
+  const float qdt_2mc        = (sp->q*sp->g->dt)/(2*sp->m*sp->g->cvac);
+  const float qdt_4mc        = 0.5*qdt_2mc; // For half Boris rotate
+  const float one            = 1.;
+  const float one_third      = 1./3.;
+  const float two_fifteenths = 2./15.;
+
+  Kokkos::parallel_for("center p", Kokkos::RangePolicy < Kokkos::DefaultExecutionSpace >
+      (0, n), KOKKOS_LAMBDA (int j) {
+
+    const int p_index = first + j;
+    const int ii = k_particles_i(p_index);
+
+    const float dx = k_particles(p_index, particle_var::dx);
+    const float dy = k_particles(p_index, particle_var::dy);
+    const float dz = k_particles(p_index, particle_var::dz);
+    float ux = k_particles(p_index, particle_var::ux);
+    float uy = k_particles(p_index, particle_var::uy);
+    float uz = k_particles(p_index, particle_var::uz);
+
+    const float hax = qdt_2mc*(    ( k_interp(ii, interpolator_var::ex)    + dy*k_interp(ii, interpolator_var::dexdy)    ) +
+                                dz*( k_interp(ii, interpolator_var::dexdz) + dy*k_interp(ii, interpolator_var::d2exdydz) ) );
+    const float hay = qdt_2mc*(    ( k_interp(ii, interpolator_var::ey)    + dz*k_interp(ii, interpolator_var::deydz)    ) +
+                                dx*( k_interp(ii, interpolator_var::deydx) + dz*k_interp(ii, interpolator_var::d2eydzdx) ) );
+    const float haz = qdt_2mc*(    ( k_interp(ii, interpolator_var::ez)    + dx*k_interp(ii, interpolator_var::dezdx)    ) +
+                                dy*( k_interp(ii, interpolator_var::dezdy) + dx*k_interp(ii, interpolator_var::d2ezdxdy) ) );
+    const float cbx = k_interp(ii, interpolator_var::cbx) + dx*k_interp(ii, interpolator_var::dcbxdx); // Interpolate B
+    const float cby = k_interp(ii, interpolator_var::cby) + dy*k_interp(ii, interpolator_var::dcbydy);
+    const float cbz = k_interp(ii, interpolator_var::cbz) + dz*k_interp(ii, interpolator_var::dcbzdz);
+    float v0, v1, v2, v3, v4;
+
+    ux  += hax;                              // Half advance E
+    uy  += hay;
+    uz  += haz;
+    v0   = qdt_4mc/(float)sqrt(one + (ux*ux + (uy*uy + uz*uz)));
+    /**/                                     // Boris - scalars
+    v1   = cbx*cbx + (cby*cby + cbz*cbz);
+    v2   = (v0*v0)*v1;
+    v3   = v0*(one+v2*(one_third+v2*two_fifteenths));
+    v4   = v3/(one+v1*(v3*v3));
+    v4  += v4;
+    v0   = ux + v3*( uy*cbz - uz*cby );      // Boris - uprime
+    v1   = uy + v3*( uz*cbx - ux*cbz );
+    v2   = uz + v3*( ux*cby - uy*cbx );
+    ux  += v4*( v1*cbz - v2*cby );           // Boris - rotation
+    uy  += v4*( v2*cbx - v0*cbz );
+    uz  += v4*( v0*cby - v1*cbx );
+
+    particle_t & q = out(j);
+    q.dx = dx;
+    q.dy = dy;
+    q.dz = dz;
+    q.i  = ii;
+    q.ux = ux;
+    q.uy = uy;
+    q.uz = uz;
+    q.w  = k_particles(p_index, particle_var::w);
+  });
+}
@@ -210,6 +210,7 @@ energy_p_kokkos(const species_t* RESTRICT sp,
     double local, global;
 
     if(!sp || !ia || sp->g != ia->g) ERROR(("Bad args"));
+    refresh_interpolator_array(ia);
 
     float qdt_2mc = (sp->q*sp->g->dt)/(2*sp->m*sp->g->cvac);
 
@@ -13,6 +13,7 @@
 
 #define IN_spa
 #include "spa_private.h"
+#include "../../particle_operations/voxel_reduce.h"
 
 // accumulate_hydro_p adds the hydrodynamic fields associated with the
 // supplied particle_list to the hydro array.  Trilinear interpolation
@@ -165,63 +166,20 @@ accumulate_hydro_p( hydro_array_t              * RESTRICT ha,
   }
 }
 
-void
-accumulate_hydro_p_kokkos(
-        //hydro_array_t              * RESTRICT ha,
-        k_particles_t& k_particles,
-        k_particles_i_t& k_particles_i,
-        k_hydro_d_t k_hydro,
-        //k_hydro_sv_t k_hydro_sv, // don't need, can do locally
-        k_interpolator_t& k_interp,
-        const species_t            * RESTRICT sp
-)
-{
-  k_hydro_sv_t k_hydro_sv = Kokkos::Experimental::create_scatter_view(k_hydro);
-
-  float c, qsp, mspc, qdt_2mc, qdt_4mc2, r8V;
-
-  //int np, stride_10, stride_21, stride_43;
-
-  //float dx, dy, dz, ux, uy, uz, w, vx, vy, vz, ke_mc;
-  //float w0, w1, w2, w3, w4, w5, w6, w7, t;
-  //int i, n;
-  //
-  int nv = sp->g->nv; // TODO: delete
-
-  if( !sp ) {
-    ERROR(( "Bad args" ));
-  }
-
-  c        = sp->g->cvac;
-  qsp      = sp->q;
-  mspc     = sp->m*c;
-  qdt_2mc  = (qsp*sp->g->dt)/(2*mspc);
-  qdt_4mc2 = qdt_2mc / (2*c);
-  r8V      = sp->g->r8V;
-
-  const int np        = sp->np;
-  const int stride_10 = VOXEL(1,0,0, sp->g->nx,sp->g->ny,sp->g->nz) -
-                        VOXEL(0,0,0, sp->g->nx,sp->g->ny,sp->g->nz);
-  const int stride_21 = VOXEL(0,1,0, sp->g->nx,sp->g->ny,sp->g->nz) -
-                        VOXEL(1,0,0, sp->g->nx,sp->g->ny,sp->g->nz);
-  const int stride_43 = VOXEL(0,0,1, sp->g->nx,sp->g->ny,sp->g->nz) -
-                        VOXEL(1,1,0, sp->g->nx,sp->g->ny,sp->g->nz);
-
-  //for( n=0; n<np; n++ ) {
-  Kokkos::parallel_for("advance_p", Kokkos::RangePolicy < Kokkos::DefaultExecutionSpace > (0, np),
-    KOKKOS_LAMBDA (size_t p_index)
-    {
-
-    // Load the particle
-    float dx = k_particles(p_index, particle_var::dx);
-    float dy = k_particles(p_index, particle_var::dy);
-    float dz = k_particles(p_index, particle_var::dz);
-    float ux = k_particles(p_index, particle_var::ux);
-    float uy = k_particles(p_index, particle_var::uy);
-    float uz = k_particles(p_index, particle_var::uz);
-    float w  = k_particles(p_index, particle_var::w);
-    int ii = k_particles_i(p_index);
-
+// Half advances a particle's momentum as in advance_p and returns its
+// physical velocity, c*(gamma-1) and the (w/V) trilinear weights of the
+// eight nodes of its voxel, in the order i, i+x, i+y, i+x+y, i+z, ...
+
+KOKKOS_INLINE_FUNCTION void
+hydro_p_particle( const k_interpolator_t & k_interp,
+                  const int ii,
+                  float dx, float dy, float dz,
+                  float & ux, float & uy, float & uz,
+                  const float w,
+                  const float c, const float qdt_2mc, const float qdt_4mc2,
+                  const float r8V,
+                  float & vx, float & vy, float & vz, float & ke_mc,
+                  float * wn ) {
     const float cbx = k_interp(ii, interpolator_var::cbx);
     const float cby = k_interp(ii, interpolator_var::cby);
     const float cbz = k_interp(ii, interpolator_var::cbz);
@@ -259,8 +217,8 @@ accumulate_hydro_p_kokkos(
     // Boris rotation - curl scalars (0.5 in v0 for half rotate) and
     // kinetic energy computation. Note: gamma-1 = |u|^2 / (gamma+1)
     // is the numerically accurate way to compute gamma-1
-    float ke_mc = ux*ux + uy*uy + uz*uz; // ke_mc = |u|^2 (invariant)
-    float vz = sqrt(1.0+ke_mc);            // vz = gamma    (invariant)
+    ke_mc = ux*ux + uy*uy + uz*uz; // ke_mc = |u|^2 (invariant)
+    vz = sqrt(1.0+ke_mc);            // vz = gamma    (invariant)
     ke_mc *= c/(vz+1.0);             // ke_mc = c|u|^2/(gamma+1) = c*(gamma-1)
     vz = c/vz;                     // vz = c/gamma
     float w0 = qdt_4mc2*vz;
@@ -280,8 +238,8 @@ accumulate_hydro_p_kokkos(
     uz += w4*( w0*w6 - w1*w5 );
 
     // Compute physical velocities
-    float vx  = ux*vz;
-    float vy  = uy*vz;
+    vx  = ux*vz;
+    vy  = uy*vz;
     vz *= uz;
 
     // Compute the trilinear coefficients
@@ -296,15 +254,69 @@ accumulate_hydro_p_kokkos(
     w0 *= dy;       // w0 = (1/8)(w/V)(1-x)(1-y)
     w1 *= dy;       // w1 = (1/8)(w/V)(1+x)(1-y)
     w7  = 1.0+dz;     // w7 = 1+z
-    w4  = w0*w7;    // w4 = (1/8)(w/V)(1-x)(1-y)(1+z) = (w/V) trilin_0 *Done
-    w5  = w1*w7;    // w5 = (1/8)(w/V)(1+x)(1-y)(1+z) = (w/V) trilin_1 *Done
-    w6  = w2*w7;    // w6 = (1/8)(w/V)(1-x)(1+y)(1+z) = (w/V) trilin_2 *Done
-    w7 *= w3;       // w7 = (1/8)(w/V)(1+x)(1+y)(1+z) = (w/V) trilin_3 *Done
+    wn[4] = w0*w7;  // (1/8)(w/V)(1-x)(1-y)(1+z) = (w/V) trilin_0 *Done
+    wn[5] = w1*w7;  // (1/8)(w/V)(1+x)(1-y)(1+z) = (w/V) trilin_1 *Done
+    wn[6] = w2*w7;  // (1/8)(w/V)(1-x)(1+y)(1+z) = (w/V) trilin_2 *Done
+    wn[7] = w3*w7;  // (1/8)(w/V)(1+x)(1+y)(1+z) = (w/V) trilin_3 *Done
     dz  = 1.0-dz;     // dz = 1-z
-    w0 *= dz;       // w0 = (1/8)(w/V)(1-x)(1-y)(1-z) = (w/V) trilin_4 *Done
-    w1 *= dz;       // w1 = (1/8)(w/V)(1+x)(1-y)(1-z) = (w/V) trilin_5 *Done
-    w2 *= dz;       // w2 = (1/8)(w/V)(1-x)(1+y)(1-z) = (w/V) trilin_6 *Done
-    w3 *= dz;       // w3 = (1/8)(w/V)(1+x)(1+y)(1-z) = (w/V) trilin_7 *Done
+    wn[0] = w0*dz;  // (1/8)(w/V)(1-x)(1-y)(1-z) = (w/V) trilin_4 *Done
+    wn[1] = w1*dz;  // (1/8)(w/V)(1+x)(1-y)(1-z) = (w/V) trilin_5 *Done
+    wn[2] = w2*dz;  // (1/8)(w/V)(1-x)(1+y)(1-z) = (w/V) trilin_6 *Done
+    wn[3] = w3*dz;  // (1/8)(w/V)(1+x)(1+y)(1-z) = (w/V) trilin_7 *Done
+}
+
+void
+accumulate_hydro_p_kokkos(
+        //hydro_array_t              * RESTRICT ha,
+        k_particles_t& k_particles,
+        k_particles_i_t& k_particles_i,
+        k_hydro_d_t k_hydro,
+        //k_hydro_sv_t k_hydro_sv, // don't need, can do locally
+        k_interpolator_t& k_interp,
+        const species_t            * RESTRICT sp
+)
+{
+  k_hydro_sv_t k_hydro_sv = Kokkos::Experimental::create_scatter_view(k_hydro);
+
+  float c, qsp, mspc, qdt_2mc, qdt_4mc2, r8V;
+
+  if( !sp ) {
+    ERROR(( "Bad args" ));
+  }
+
+  c        = sp->g->cvac;
+  qsp      = sp->q;
+  mspc     = sp->m*c;
+  qdt_2mc  = (qsp*sp->g->dt)/(2*mspc);
+  qdt_4mc2 = qdt_2mc / (2*c);
+  r8V      = sp->g->r8V;
+
+  const int np        = sp->np;
+  const int stride_10 = VOXEL(1,0,0, sp->g->nx,sp->g->ny,sp->g->nz) -
+                        VOXEL(0,0,0, sp->g->nx,sp->g->ny,sp->g->nz);
+  const int stride_21 = VOXEL(0,1,0, sp->g->nx,sp->g->ny,sp->g->nz) -
+                        VOXEL(1,0,0, sp->g->nx,sp->g->ny,sp->g->nz);
+  const int stride_43 = VOXEL(0,0,1, sp->g->nx,sp->g->ny,sp->g->nz) -
+                        VOXEL(1,1,0, sp->g->nx,sp->g->ny,sp->g->nz);
+
+  //for( n=0; n<np; n++ ) {
+  Kokkos::parallel_for("advance_p", Kokkos::RangePolicy < Kokkos::DefaultExecutionSpace > (0, np),
+    KOKKOS_LAMBDA (size_t p_index)
+    {
+
+    // Load the particle
+    float dx = k_particles(p_index, particle_var::dx);
+    float dy = k_particles(p_index, particle_var::dy);
+    float dz = k_particles(p_index, particle_var::dz);
+    float ux = k_particles(p_index, particle_var::ux);
+    float uy = k_particles(p_index, particle_var::uy);
+    float uz = k_particles(p_index, particle_var::uz);
+    float w  = k_particles(p_index, particle_var::w);
+    int ii = k_particles_i(p_index);
+
+    float vx, vy, vz, ke_mc, wn[8];
+    hydro_p_particle( k_interp, ii, dx, dy, dz, ux, uy, uz, w,
+                      c, qdt_2mc, qdt_4mc2, r8V, vx, vy, vz, ke_mc, wn );
 
     // TODO: This could easily be a loop?
 
@@ -334,30 +346,29 @@ accumulate_hydro_p_kokkos(
     k_hydro_access(i, hydro_var::txy) += dx*vy;
 
     // TODO: this serial adding to try and save adds is a bit sad
-    // TODO: This is somehow going out of bounds right now
     const int i0 = ii;
-    ACCUM_HYDRO(w0, i0); // Cell i,j,k
+    ACCUM_HYDRO(wn[0], i0); // Cell i,j,k
 
     const int i1 = i0 + stride_10;
-    ACCUM_HYDRO(w1, i1); // Cell i+1,j,k
+    ACCUM_HYDRO(wn[1], i1); // Cell i+1,j,k
 
     const int i2 = i1 + stride_21;
-    ACCUM_HYDRO(w2, i2); // Cell i,j+1,k
+    ACCUM_HYDRO(wn[2], i2); // Cell i,j+1,k
 
     const int i3 = i2 + stride_10;
-    ACCUM_HYDRO(w3, i3); // Cell i+1,j+1,k
+    ACCUM_HYDRO(wn[3], i3); // Cell i+1,j+1,k
 
     const int i4 = i3 + stride_43;
-    ACCUM_HYDRO(w4, i4); // Cell i,j,k+1
+    ACCUM_HYDRO(wn[4], i4); // Cell i,j,k+1
 
     const int i5 = i4 + stride_10;
-    ACCUM_HYDRO(w5, i5); // Cell i+1,j,k+1
+    ACCUM_HYDRO(wn[5], i5); // Cell i+1,j,k+1
 
     const int i6 = i5 + stride_21;
-    ACCUM_HYDRO(w6, i6); // Cell i,j+1,k+1
+    ACCUM_HYDRO(wn[6], i6); // Cell i,j+1,k+1
 
     const int i7 = i6 + stride_10;
-    ACCUM_HYDRO(w7, i7); // Cell i+1,j+1,k+1
+    ACCUM_HYDRO(wn[7], i7); // Cell i+1,j+1,k+1
 
 #   undef ACCUM_HYDRO
   });
@@ -367,3 +378,88 @@ accumulate_hydro_p_kokkos(
 
   // Perform debug printing
 }
+
+// Sorted variant of accumulate_hydro_p_kokkos that adds the moments of
+// several species into k_hydro in one pass, without a ScatterView (and
+// so without its per thread copies of the hydro array on host
+// backends). The particles are grouped by voxel in the species' cell
+// tables (see ParticleSorter::partition) and one team takes each voxel, so
+// all of a team's particles read the same interpolator. The team sums
+// the contributions of the voxel's particles of every species to the
+// voxel's eight nodes in team scratch, then adds the 8 x HYDRO_VAR_COUNT
+// sums to k_hydro with atomics (neighbouring voxels share nodes).
+
+struct hydro_p_species {
+  k_particles_t p;
+  k_particles_i_t p_i;
+  Kokkos::View<int*> partition, slot, count;
+  float qsp, mspc, qdt_2mc, qdt_4mc2;
+};
+
+void
+accumulate_hydro_p_kokkos_sorted( k_hydro_d_t k_hydro,
+                                  species_t ** sp_list,
+                                  int n_species,
+                                  k_interpolator_t& k_interp ) {
+  if( n_species<0 || ( n_species && !sp_list ) ) ERROR(( "Bad args" ));
+  if( !n_species ) return;
+
+  const grid_t * g = sp_list[0]->g;
+  const float c   = g->cvac;
+  const float r8V = g->r8V;
+  const int sy = g->sy, sz = g->sz;
+
+  auto fill = [&] ( hydro_p_species & S, const species_t * sp ) {
+    S.p        = sp->k_p_d;
+    S.p_i      = sp->k_p_i_d;
+    S.qsp      = sp->q;
+    S.mspc     = sp->m*c;
+    S.qdt_2mc  = (sp->q*g->dt)/(2*sp->m*c);
+    S.qdt_4mc2 = S.qdt_2mc / (2*c);
+  };
+
+  for( int s0=0; s0<n_species; s0+=HYDRO_P_MAX_SPECIES ) {
+    species_batch<hydro_p_species, HYDRO_P_MAX_SPECIES> batch;
+    const int ns = batch.load( sp_list+s0, n_species-s0, g, fill );
+
+    voxel_team_reduce( "accumulate_hydro_p_sorted", g->nv, 8*HYDRO_VAR_COUNT, batch, ns,
+    KOKKOS_LAMBDA( const hydro_p_species & S, const int v, const int i,
+                   const voxel_scratch_t & acc, const bool shared ) {
+      float ux = S.p(i, particle_var::ux);
+      float uy = S.p(i, particle_var::uy);
+      float uz = S.p(i, particle_var::uz);
+      float vx, vy, vz, ke_mc, wn[8];
+      hydro_p_particle( k_interp, v, S.p(i, particle_var::dx),
+                        S.p(i, particle_var::dy), S.p(i, particle_var::dz),
+                        ux, uy, uz, S.p(i, particle_var::w),
+                        c, S.qdt_2mc, S.qdt_4mc2, r8V,
+                        vx, vy, vz, ke_mc, wn );
+      for( int node=0; node<8; node++ ) {
+        float h[HYDRO_VAR_COUNT];
+        float t = S.qsp*wn[node];           // t = (qsp w/V) trilin_n
+        h[hydro_var::jx]  = t*vx;
+        h[hydro_var::jy]  = t*vy;
+        h[hydro_var::jz]  = t*vz;
+        h[hydro_var::rho] = t;
+        t = S.mspc*wn[node];                // t = (msp c w/V) trilin_n
+        h[hydro_var::px]  = t*ux;
+        h[hydro_var::py]  = t*uy;
+        h[hydro_var::pz]  = t*uz;
+        h[hydro_var::ke]  = t*ke_mc;
+        h[hydro_var::txx] = h[hydro_var::px]*vx;
+        h[hydro_var::tyy] = h[hydro_var::py]*vy;
+        h[hydro_var::tzz] = h[hydro_var::pz]*vz;
+        h[hydro_var::tyz] = h[hydro_var::py]*vz;
+        h[hydro_var::tzx] = h[hydro_var::pz]*vx;
+        h[hydro_var::txy] = h[hydro_var::px]*vy;
+        for( int m=0; m<HYDRO_VAR_COUNT; m++ )
+          voxel_scratch_add( acc, shared, node*HYDRO_VAR_COUNT+m, h[m] );
+      }
+    },
+    KOKKOS_LAMBDA( const int v, const int k, const float h ) {
+      const int node = k/HYDRO_VAR_COUNT;
+      const int i = v + (node&1) + ((node>>1)&1)*sy + (node>>2)*sz;
+      Kokkos::atomic_add( &k_hydro(i, k%HYDRO_VAR_COUNT), h );
+    } );
+  }
+}
@@ -92,6 +92,7 @@ uncenter_p( /**/  species_t            * RESTRICT sp,
   //DECLARE_ALIGNED_ARRAY( center_p_pipeline_args_t, 128, args, 1 );
 
   if( !sp || !ia || sp->g!=ia->g ) ERROR(( "Bad args" ));
+  refresh_interpolator_array( ia );
 
   k_particles_t k_particles = sp->k_p_d;
   k_particles_i_t k_particles_i = sp->k_p_i_d;
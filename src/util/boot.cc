@@ -159,13 +159,20 @@ boot_services( int * pargc,
 # else
         std::cout << "# VPIC_ENABLE_ACCUMULATOR: OFF" << std::endl;
 #endif
-        std::cout << "# Using sort method: " << EXPAND_AND_STRINGIFY(SORT) << std::endl;
+#ifdef VPIC_ENABLE_ASYNC_PROFILE
+        std::cout << "# VPIC_ENABLE_ASYNC_PROFILE: ON" << std::endl;
+#else
+        std::cout << "# VPIC_ENABLE_ASYNC_PROFILE: OFF" << std::endl;
+#endif
+        std::cout << "# Default sort method: " << EXPAND_AND_STRINGIFY(SORT_STRATEGY) << std::endl;
+        std::cout << "# Default sort tile size: " << SORT_TILE_SIZE << std::endl;
 
         std::cout << "######### End Build Details ########" << std::endl;
         std::cout << std::endl; // blank line
     }
 
     Kokkos::initialize( *pargc, *pargv );
+    profile_async_initialize();
 }
 
 // This operates in reverse order from boot_services
@@ -10,6 +10,10 @@
 
 #define IN_checkpt
 #include "checkpt_private.h"
+#include "../io/FileIO.h"
+
+#include <string>
+#include <vector>
 
 /* Boolean flag indicating whether or not checkpoint is booted. */
 
@@ -229,8 +233,28 @@ unregister_object( void * obj ) {
   FREE( node );
 }
 
-void
-checkpt_objects( const char * name ) {
+/* Sections (see checkpt_section) of the last full checkpt in the order
+   they were written, so that a delta checkpt can refer back to the ones
+   that did not change since. */
+
+typedef struct section_record {
+  std::string name;
+  uint64_t checksum;
+  size_t n_byte;
+  uint64_t offset;
+} section_record_t;
+
+static std::vector<section_record_t> base_section;
+static std::string base_name;
+static int delta = 0;        /* Writing a delta checkpt */
+static size_t n_section = 0; /* Sections written to the current checkpt */
+static size_t n_ref = 0;     /* Sections of it referring to the base */
+static int base_in_use = 0;  /* The newest checkpt refers to the base */
+
+static void
+checkpt_registry( checkpt_t * stream,
+                  const char * name,
+                  int is_delta ) {
   registry_t * node;
 
   /* Check input args */
@@ -239,9 +263,17 @@ checkpt_objects( const char * name ) {
   if( checkpt ) ERROR(( "currently writing a checkpt" ));
   if( restore ) ERROR(( "currently reading a checkpt" ));
 
-  /* Open the checkpt serialization stream */
+  /* A full checkpt becomes the base of the following delta checkpts */
+
+  checkpt = stream;
+  delta = is_delta;
+  n_section = 0;
+  n_ref = 0;
+  if( !delta ) {
+    base_section.clear();
+    base_name = name;
+  }
 
-  checkpt = checkpt_open_wronly( name );
   CHECKPT_VAL( size_t, next_id );
 
   /* Checkpoint the objects */
@@ -263,6 +295,31 @@ checkpt_objects( const char * name ) {
   CHECKPT_VAL( size_t, 0xBADF00D );
   checkpt_close( checkpt );
   checkpt = NULL;
+  base_in_use = delta && n_ref;
+  delta = 0;
+}
+
+void
+checkpt_objects( const char * name ) {
+  if( !name ) ERROR(( "NULL name" ));
+  checkpt_registry( checkpt_open_wronly( name ), name, 0 );
+}
+
+void
+checkpt_objects_buffered( const char * name,
+                          std::vector<char> & data,
+                          int is_delta ) {
+  if( !name ) ERROR(( "NULL name" ));
+  /* Write a full checkpt if there is no base yet or if the delta would
+     overwrite the base it refers to */
+  if( is_delta && ( base_name.empty() || base_name==name ) ) is_delta = 0;
+  checkpt_registry( checkpt_open_buffer( &data ), name, is_delta );
+}
+
+int
+checkpt_base_in_use( const char * name ) {
+  if( !name ) ERROR(( "NULL name" ));
+  return base_in_use && base_name==name;
 }
 
 void
@@ -368,6 +425,107 @@ restore_raw( void * data,
   if( n_byte ) checkpt_read( restore, data, n_byte );
 }
 
+/* Section checkpt helpers */
+
+#define CHECKPT_SECTION_MAGIC 0x5EC7105E
+
+void
+checkpt_section( const char * name,
+                 const void * data,
+                 size_t n_byte,
+                 uint64_t checksum ) {
+  const size_t s = n_section++;
+  int ref = 0;
+
+  /* Check input args */
+
+  if( !checkpt ) ERROR(( "not writing a checkpt" ));
+  if( !name ) ERROR(( "NULL section name" ));
+  if( !data && n_byte ) ERROR(( "NULL data" ));
+
+  if( delta && s<base_section.size() ) {
+    const section_record_t & b = base_section[s];
+    ref = b.name==name && b.n_byte==n_byte && b.checksum==checksum;
+  }
+
+  CHECKPT_VAL( size_t, CHECKPT_SECTION_MAGIC );
+  CHECKPT_STR( name );
+  CHECKPT_VAL( size_t, n_byte );
+  CHECKPT_VAL( uint64_t, checksum );
+  CHECKPT_VAL( int, ref );
+
+  /* Unchanged sections of a delta checkpt point into the base */
+
+  if( ref ) {
+    n_ref++;
+    CHECKPT_STR( base_name.c_str() );
+    CHECKPT_VAL( uint64_t, base_section[s].offset );
+    return;
+  }
+
+  if( !delta ) {
+    section_record_t b;
+    b.name     = name;
+    b.checksum = checksum;
+    b.n_byte   = n_byte;
+    b.offset   = checkpt_offset( checkpt );
+    base_section.push_back( b );
+  }
+  checkpt_raw( data, n_byte );
+}
+
+uint64_t
+restore_section( const char * name,
+                 void * data,
+                 size_t n_byte ) {
+  size_t magic, stored_n_byte;
+  uint64_t checksum, offset;
+  char * stored, * base;
+  int ref;
+
+  /* Check input args */
+
+  if( !restore ) ERROR(( "not reading a checkpt" ));
+  if( !name ) ERROR(( "NULL section name" ));
+  if( !data && n_byte ) ERROR(( "NULL data" ));
+
+  RESTORE_VAL( size_t, magic );
+  if( magic!=CHECKPT_SECTION_MAGIC )
+    ERROR(( "Malformed checkpt (expected section \"%s\")", name ));
+  RESTORE_STR( stored );
+  if( !stored || strcmp( stored, name ) )
+    ERROR(( "Malformed checkpt (expected section \"%s\", found \"%s\")",
+            name, stored ? stored : "(null)" ));
+  FREE( stored );
+  RESTORE_VAL( size_t, stored_n_byte );
+  if( stored_n_byte!=n_byte )
+    ERROR(( "Section \"%s\" has %lu bytes (expected %lu)", name,
+            (unsigned long)stored_n_byte, (unsigned long)n_byte ));
+  RESTORE_VAL( uint64_t, checksum );
+  RESTORE_VAL( int, ref );
+
+  if( !ref ) {
+    restore_raw( data, n_byte );
+    return checksum;
+  }
+
+  /* The section is in the base checkpt of this delta checkpt */
+
+  RESTORE_STR( base );
+  RESTORE_VAL( uint64_t, offset );
+  if( n_byte ) {
+    FileIO fileIO;
+    if( fileIO.open( base, io_read )!=ok )
+      ERROR(( "Unable to open base checkpt \"%s\" of section \"%s\"", base, name ));
+    fileIO.seek( offset, SEEK_SET );
+    if( fileIO.read( (char *)data, n_byte )!=n_byte )
+      ERROR(( "Could not read section \"%s\" from base checkpt \"%s\"", name, base ));
+    fileIO.close();
+  }
+  FREE( base );
+  return checksum;
+}
+
 /* Composiite checkpt helpers */
 
 void
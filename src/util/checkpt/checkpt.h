@@ -3,6 +3,8 @@
 
 #include "../util_base.h"
 
+#include <vector>
+
 /* A checkpt_func_t serializes an object to a checkpt.  It takes a
    pointer to the object to serialize.  Objects are checkpointed in
    the order they are registered.  A checkpoint_func_t should not
@@ -101,6 +103,27 @@ checkpt_objects( const char * name );
 void
 restore_objects( const char * name );
 
+/* Like checkpt_objects, but serializes the checkpt into data (which the
+   caller then writes to the file name, e.g. from a background thread)
+   instead of writing it.  If delta is set, sections (see below) that
+   are unchanged since the last full checkpt are not stored but refer
+   back to it; the delta checkpt then can only be restored while that
+   checkpt exists.  The first checkpt made is always a full one, as is
+   one written under the name of the last full checkpt. */
+
+void
+checkpt_objects_buffered( const char * name,
+                          std::vector<char> & data,
+                          int delta );
+
+/* Nonzero if name is the full checkpt that the newest (delta) checkpt
+   refers to.  Writing over it in place would leave no checkpt that can
+   be restored until the write is done, so it should be replaced (e.g.
+   written elsewhere and renamed) instead. */
+
+int
+checkpt_base_in_use( const char * name );
+
 /* Call the reanimate functions on all objects.  This is typically
    done after the restore process. */
 
@@ -121,6 +144,24 @@ restore_raw( void * data,
              size_t n_byte );
 
 
+/* Checkpt(restore) a named section of n_byte bytes with the given
+   checksum (computed by the caller).  restore_section checks the name
+   and size and returns the stored checksum for the caller to verify.
+   Sections are the unit of delta checkpts (see checkpt_objects_buffered),
+   so the caller should use them for bulk data that often does not
+   change between checkpts. */
+
+void
+checkpt_section( const char * name,
+                 const void * data,
+                 size_t n_byte,
+                 uint64_t checksum );
+
+uint64_t
+restore_section( const char * name,
+                 void * data,
+                 size_t n_byte );
+
 /*****************************************************************************/
 /* Composite checkpt / restore / reanimate primitives */
 
@@ -12,6 +12,11 @@ checkpt_open_wronly( const char * name ) {
 	return CheckPtIO::checkpt_open_wronly(name);
 }
 
+checkpt_t *
+checkpt_open_buffer( std::vector<char> * buffer ) {
+	return CheckPtIO::checkpt_open_buffer(buffer);
+}
+
 void
 checkpt_close( checkpt_t * checkpt ) {
 	return CheckPtIO::checkpt_close(checkpt);
@@ -30,3 +35,8 @@ checkpt_write( checkpt_t * checkpt,
                size_t sz ) {
 	return CheckPtIO::checkpt_write(checkpt, data, sz);
 }
+
+uint64_t
+checkpt_offset( const checkpt_t * checkpt ) {
+	return checkpt->offset;
+}
@@ -1,9 +1,20 @@
 #ifndef CheckPtIO_h
 #define CheckPtIO_h
 
+#include <vector>
+
 #include "checkpt_private.h"
 #include "../io/FileIO.h"
 
+// A checkpt stream is either a file or, for checkpts written later (see
+// checkpt_objects_buffered), a host buffer.  The offset is the number of
+// bytes read or written so far.
+struct checkpt {
+	FileIO * fileIO;
+	std::vector<char> * buffer;
+	uint64_t offset;
+}; // struct checkpt
+
 struct CheckPtIO {
 
 	static checkpt_t * checkpt_open_rdonly(const char * name) {
@@ -15,7 +26,7 @@ struct CheckPtIO {
   			ERROR(( "Unable to open \"%s\" for checkpt read", name ));
 		} // if
 
-		return reinterpret_cast<checkpt_t *>(fileIO);
+		return new checkpt_t{ fileIO, NULL, 0 };
 	} // checkpt_open_rdonly
 
 	static checkpt_t * checkpt_open_wronly(const char * name) {
@@ -27,40 +38,53 @@ struct CheckPtIO {
   			ERROR(("Unable to open \"%s\" for checkpt read", name));
 		} // if
 
-		return reinterpret_cast<checkpt_t *>(fileIO);
+		return new checkpt_t{ fileIO, NULL, 0 };
 	} // checkpt_open_wronly
 
+	static checkpt_t * checkpt_open_buffer(std::vector<char> * buffer) {
+		if(!buffer) ERROR(("NULL buffer"));
+		buffer->clear();
+		return new checkpt_t{ NULL, buffer, 0 };
+	} // checkpt_open_buffer
+
 	static void checkpt_close(checkpt_t * checkpt) {
-		FileIO * fileIO = reinterpret_cast<FileIO *>(checkpt);
+		if(checkpt->fileIO) {
+			int32_t err = checkpt->fileIO->close();
 
-		int32_t err = fileIO->close();
+			if(err != 0) {
+  				ERROR(("Error closing file (%d)", err));
+			} // if
 
-		if(err != 0) {
-  			ERROR(("Error closing file (%d)", err));
+			delete checkpt->fileIO;
 		} // if
 
-		delete fileIO;
+		delete checkpt;
 	} // checkpt_close
 
 	static void checkpt_read(checkpt_t * checkpt, void * data, size_t sz) {
 		if(!sz) return;
-		if(!checkpt || !data) ERROR(("Invalid checkpt_read request"));
-
-		FileIO * fileIO = reinterpret_cast<FileIO *>(checkpt);
+		if(!checkpt || !checkpt->fileIO || !data)
+			ERROR(("Invalid checkpt_read request"));
 
 		// FIXME: add return values
-		fileIO->read(reinterpret_cast<char *>(data), sz);
+		checkpt->fileIO->read(reinterpret_cast<char *>(data), sz);
+		checkpt->offset += sz;
 	} // checkpt_read
 
 	static void checkpt_write(checkpt_t * checkpt, const void * data,
 		size_t sz) {
 		if(!sz) return;
-		if(!checkpt || !data) ERROR(("Invalid checkpt_read request"));
-
-		FileIO * fileIO = reinterpret_cast<FileIO *>(checkpt);
-
-		// FIXME: add return values
-		fileIO->write(reinterpret_cast<const char *>(data), sz);
+		if(!checkpt || !data) ERROR(("Invalid checkpt_write request"));
+
+		const char * bytes = reinterpret_cast<const char *>(data);
+		if(checkpt->buffer) {
+			checkpt->buffer->insert(checkpt->buffer->end(), bytes, bytes + sz);
+		}
+		else {
+			// FIXME: add return values
+			checkpt->fileIO->write(bytes, sz);
+		} // if
+		checkpt->offset += sz;
 	} // checkpt_write
 
 }; // struct CheckPtIO
@@ -0,0 +1,177 @@
+#ifndef _checkpt_kokkos_h_
+#define _checkpt_kokkos_h_
+
+#include "checkpt.h"
+
+#include <Kokkos_Core.hpp>
+#include <type_traits>
+
+/* Checkpt / restore helpers for objects holding Kokkos views.
+
+   Kokkos views are reference counted handles to memory owned by the
+   Kokkos runtime, so the raw bytes of a view are meaningless in a later
+   process.  An object holding views lists them in a member
+
+     template<class F> void for_each_kokkos_view( F f );
+
+   that calls f on each of them.  CHECKPT_KOKKOS(p) then checkpts *p
+   like CHECKPT(p,1) but with every view replaced by an empty one.  An
+   empty view refers to no memory, so after RESTORE(p) the views of *p
+   are valid empty views and the restore function can allocate them
+   with plain assignments.
+
+   The contents of a view are checkpted as its extents followed by a
+   section (see checkpt_section) with its name, size and checksum.  The
+   data is read from (written to) the view itself, staged through a
+   contiguous LayoutRight copy in device and host memory, so the legacy
+   host arrays do not have to be populated and the format does not
+   depend on the backend layout.  Only the leading n rows can be
+   checkpted (e.g. the np particles in use out of max_np).  A section
+   that does not match the view it is restored into or whose checksum
+   does not match its data is an error. */
+
+/* Hash of n_byte bytes, computed in parallel.  Each 32-bit word is
+   combined with its position and run through a 64-bit mixer (the
+   splitmix64 finalizer) and the results are summed.  Unlike a weighted
+   sum, changes to several words do not cancel out in any structured
+   way, so the hash is also strong enough to decide that a section of a
+   delta checkpt is unchanged (see checkpt_section). */
+
+inline uint64_t
+checkpt_mix( uint64_t x ) {
+  x ^= x >> 30; x *= 0xbf58476d1ce4e5b9ULL;
+  x ^= x >> 27; x *= 0x94d049bb133111ebULL;
+  x ^= x >> 31;
+  return x;
+}
+
+inline uint64_t
+checkpt_checksum( const void * data,
+                  size_t n_byte ) {
+  const uint32_t * w = (const uint32_t *)data;
+  const size_t n_word = n_byte/sizeof(uint32_t);
+  uint64_t sum = 0;
+  Kokkos::parallel_reduce( "checkpt checksum",
+    Kokkos::RangePolicy<Kokkos::DefaultHostExecutionSpace>( 0, n_word ),
+    [=] ( const size_t i, uint64_t & s ) {
+      s += checkpt_mix( ( (uint64_t)i << 32 ) ^ w[i] );
+    }, sum );
+  const unsigned char * b = (const unsigned char *)data;
+  for( size_t i=n_word*sizeof(uint32_t); i<n_byte; i++ )
+    sum += checkpt_mix( ( (uint64_t)i << 32 ) ^ ( 0x100u | b[i] ) );
+  return checkpt_mix( sum ^ n_byte );
+}
+
+template<class V>
+struct checkpt_view_stage {
+  static_assert( V::rank==1 || V::rank==2, "Only rank 1 and 2 views" );
+  typedef Kokkos::View<typename V::non_const_data_type, Kokkos::LayoutRight,
+                       typename V::memory_space> device_t;
+  typedef typename device_t::HostMirror host_t;
+
+  static device_t
+  alloc( size_t n, size_t n1 ) {
+    return device_t( Kokkos::view_alloc( std::string( "checkpt stage" ),
+                                         Kokkos::WithoutInitializing ), n, n1 );
+  }
+
+  static auto
+  rows( const V & v, size_t n ) {
+    if constexpr( V::rank==1 ) return Kokkos::subview( v, std::make_pair( size_t(0), n ) );
+    else return Kokkos::subview( v, std::make_pair( size_t(0), n ), Kokkos::ALL );
+  }
+};
+
+/* Checkpt the first n rows of v as section name */
+
+template<class V>
+void
+checkpt_view( const char * name,
+              const V & v,
+              size_t n ) {
+  typedef checkpt_view_stage<V> stage;
+
+  if( !name ) ERROR(( "NULL section name" ));
+  if( n>v.extent(0) ) ERROR(( "Section \"%s\" has only %lu rows (%lu requested)",
+                              name, (unsigned long)v.extent(0), (unsigned long)n ));
+
+  const size_t n1 = V::rank==2 ? v.extent(1) : KOKKOS_INVALID_INDEX;
+  typename stage::device_t d = stage::alloc( n, n1 );
+  Kokkos::deep_copy( d, stage::rows( v, n ) );
+  typename stage::host_t h = Kokkos::create_mirror_view( d );
+  Kokkos::deep_copy( h, d );
+
+  const size_t n_byte = h.span()*sizeof(typename V::non_const_value_type);
+  CHECKPT_VAL( size_t, V::rank );
+  CHECKPT_VAL( size_t, n );
+  CHECKPT_VAL( size_t, V::rank==2 ? v.extent(1) : 1 );
+  checkpt_section( name, h.data(), n_byte, checkpt_checksum( h.data(), n_byte ) );
+}
+
+template<class V>
+void
+checkpt_view( const char * name,
+              const V & v ) {
+  checkpt_view( name, v, v.extent(0) );
+}
+
+/* Restore section name into the leading rows of v and return the
+   number of rows restored.  If v is not allocated, it is allocated
+   with max( n_alloc, rows in the section ) rows. */
+
+template<class V>
+size_t
+restore_view( const char * name,
+              V & v,
+              size_t n_alloc = 0 ) {
+  typedef checkpt_view_stage<V> stage;
+  size_t rank, n, n1;
+
+  RESTORE_VAL( size_t, rank );
+  RESTORE_VAL( size_t, n );
+  RESTORE_VAL( size_t, n1 );
+  if( rank!=V::rank ) ERROR(( "Section \"%s\" has rank %lu (expected %lu)",
+                              name, (unsigned long)rank, (unsigned long)V::rank ));
+
+  if( !v.is_allocated() ) {
+    const size_t n0 = n>n_alloc ? n : n_alloc;
+    if constexpr( V::rank==1 ) v = V( std::string( name ), n0 );
+    else                       v = V( std::string( name ), n0, n1 );
+  }
+  if( n>v.extent(0) || ( V::rank==2 && n1!=v.extent(1) ) )
+    ERROR(( "Section \"%s\" does not fit its view", name ));
+
+  typename stage::device_t d = stage::alloc( n, V::rank==2 ? n1 : KOKKOS_INVALID_INDEX );
+  typename stage::host_t h = Kokkos::create_mirror_view( d );
+  const size_t n_byte = h.span()*sizeof(typename V::non_const_value_type);
+  if( restore_section( name, h.data(), n_byte )!=checkpt_checksum( h.data(), n_byte ) )
+    ERROR(( "Checksum mismatch in section \"%s\"", name ));
+
+  Kokkos::deep_copy( d, h );
+  Kokkos::deep_copy( stage::rows( v, n ), d );
+  return n;
+}
+
+/* Checkpt *obj with its views replaced by empty ones (see above) */
+
+template<class T>
+void
+checkpt_kokkos_object( const T * obj ) {
+  char * image;
+  MALLOC( image, sizeof(T) );
+  memcpy( image, (const void *)obj, sizeof(T) );
+  const_cast<T *>(obj)->for_each_kokkos_view( [&] ( auto & v ) {
+    typedef typename std::decay<decltype(v)>::type view_t;
+    const view_t empty;
+    memcpy( image + ( (const char *)&v - (const char *)obj ),
+            (const void *)&empty, sizeof(view_t) );
+  } );
+  checkpt_data( image, sizeof(T), sizeof(T), 1, 1, 0 );
+  FREE( image );
+}
+
+#define CHECKPT_KOKKOS(p)        checkpt_kokkos_object( (p) )
+#define CHECKPT_VIEW(name,v,n)   checkpt_view( (name), (v), (n) )
+#define RESTORE_VIEW(name,v,n)   restore_view( (name), (v), (n) )
+
+#endif /* _checkpt_kokkos_h_ */
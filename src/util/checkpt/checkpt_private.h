@@ -7,6 +7,8 @@
 
 #include "checkpt.h"
 
+#include <vector>
+
 struct checkpt;
 typedef struct checkpt checkpt_t;
 
@@ -16,6 +18,9 @@ checkpt_open_rdonly( const char * name );
 checkpt_t *
 checkpt_open_wronly( const char * name );
 
+checkpt_t *
+checkpt_open_buffer( std::vector<char> * buffer );
+
 void
 checkpt_close( checkpt_t * checkpt );
 
@@ -29,4 +34,7 @@ checkpt_write( checkpt_t * checkpt,
                const void * data,
                size_t sz );
 
+uint64_t
+checkpt_offset( const checkpt_t * checkpt );
+
 #endif /* _checkpt_private_h_ */
@@ -0,0 +1,203 @@
+/*
+	Definition of DumpWriter and DumpStream classes
+
+	vim: set ts=3 :
+*/
+
+#ifndef DumpWriter_h
+#define DumpWriter_h
+
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../util_base.h"
+#include "FileIO.h"
+
+/*!
+	\class DumpWriter DumpWriter.h
+	\brief Writes finished dump files from a background thread.
+
+	A dump is staged completely in host memory and handed over with
+	submit().  At most max_pending files are held at once (the one being
+	written plus the ones queued behind it); submit() blocks while that
+	many are outstanding, which bounds the staging memory.  The default of
+	two double buffers the dumps against the time step loop.
+
+	A file submitted with replace set is written next to its final name
+	and renamed over it once complete (see write_file), so the previous
+	contents stay intact until the new ones are on disk.
+*/
+class DumpWriter
+	{
+	public:
+
+		//! Constructor
+		DumpWriter(size_t max_pending = 2)
+			: max_pending_(max_pending ? max_pending : 1), done_(false),
+			thread_(&DumpWriter::run, this) {}
+
+		//! Destructor, finishes every queued file
+		~DumpWriter()
+			{
+				{
+					std::lock_guard<std::mutex> lock(mutex_);
+					done_ = true;
+				}
+				wake_.notify_one();
+				thread_.join();
+			}
+
+		// Takes the contents of data (which is left empty)
+		void submit(const char * filename, std::vector<char> & data,
+			bool replace = false);
+
+		// Writes data to filename, through a temporary file if replace is set
+		static void write_file(const char * filename,
+			const std::vector<char> & data, bool replace);
+
+		// Waits until every submitted file is on disk
+		void flush();
+
+	private:
+
+		struct Job {
+			std::string filename;
+			std::vector<char> data;
+			bool replace;
+		};
+
+		void run();
+
+		size_t max_pending_;
+		bool done_;
+		std::deque<Job> jobs_;
+		std::mutex mutex_;
+		std::condition_variable wake_;
+		std::condition_variable idle_;
+		std::thread thread_;
+
+	}; // class DumpWriter
+
+inline void
+DumpWriter::submit(const char * filename, std::vector<char> & data,
+	bool replace)
+	{
+		std::unique_lock<std::mutex> lock(mutex_);
+		idle_.wait(lock, [this] { return jobs_.size() < max_pending_; });
+		jobs_.emplace_back();
+		jobs_.back().filename = filename;
+		jobs_.back().data.swap(data);
+		jobs_.back().replace = replace;
+		lock.unlock();
+		wake_.notify_one();
+	} // DumpWriter::submit
+
+inline void
+DumpWriter::flush()
+	{
+		std::unique_lock<std::mutex> lock(mutex_);
+		idle_.wait(lock, [this] { return jobs_.empty(); });
+	} // DumpWriter::flush
+
+inline void
+DumpWriter::run()
+	{
+		std::unique_lock<std::mutex> lock(mutex_);
+
+		for(;;) {
+			wake_.wait(lock, [this] { return done_ || !jobs_.empty(); });
+			if(jobs_.empty()) return;
+
+			// The job stays queued while it is written so that it counts
+			// against max_pending.  References to the front of a deque stay
+			// valid while submit() appends to the back.
+			Job & job = jobs_.front();
+			lock.unlock();
+
+			write_file(job.filename.c_str(), job.data, job.replace);
+
+			lock.lock();
+			jobs_.pop_front();
+			idle_.notify_all();
+		} // for
+	} // DumpWriter::run
+
+inline void
+DumpWriter::write_file(const char * filename,
+	const std::vector<char> & data, bool replace)
+	{
+		const std::string target(filename);
+		const std::string name = replace ? target + ".tmp" : target;
+
+		FileIO fileIO;
+		if(fileIO.open(name.c_str(), io_write) == fail)
+			ERROR(("Could not open \"%s\".", name.c_str()));
+		if(fileIO.write(data.data(), data.size()) != data.size())
+			ERROR(("Write failed on \"%s\".", name.c_str()));
+		if(fileIO.close())
+			ERROR(("File close failed on \"%s\".", name.c_str()));
+
+		if(replace && std::rename(name.c_str(), target.c_str()))
+			ERROR(("Could not rename \"%s\" to \"%s\".", name.c_str(),
+				target.c_str()));
+	} // DumpWriter::write_file
+
+/*!
+	\class DumpStream DumpWriter.h
+	\brief Drop-in for FileIO in the binary dump routines.
+
+	Without a writer every call goes straight to FileIO.  With one, writes
+	are appended to a host buffer and close() hands the finished file to
+	the writer, so the caller returns as soon as the data are staged.
+*/
+class DumpStream
+	{
+	public:
+
+		//! Constructor
+		DumpStream(DumpWriter * writer) : writer_(writer) {}
+
+		FileIOStatus open(const char * filename, FileIOMode mode)
+			{
+				if(!writer_) return fileIO_.open(filename, mode);
+				if(mode != io_write) ERROR(("Asynchronous dumps are write only"));
+				filename_ = filename;
+				buffer_.clear();
+				return ok;
+			}
+
+		int32_t close()
+			{
+				if(!writer_) return fileIO_.close();
+				writer_->submit(filename_.c_str(), buffer_);
+				return 0;
+			}
+
+		// Hint for the number of bytes that will be written
+		void reserve(size_t bytes)
+			{ if(writer_) buffer_.reserve(bytes); }
+
+		template<typename T>
+		size_t write(const T * data, size_t elements)
+			{
+				if(!writer_) return fileIO_.write(data, elements);
+				const char * bytes = reinterpret_cast<const char *>(data);
+				buffer_.insert(buffer_.end(), bytes, bytes + elements*sizeof(T));
+				return elements;
+			}
+
+	private:
+
+		DumpWriter * writer_;
+		FileIO fileIO_;
+		std::string filename_;
+		std::vector<char> buffer_;
+
+	}; // class DumpStream
+
+#endif // DumpWriter_h
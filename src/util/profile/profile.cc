@@ -1,6 +1,12 @@
 #include "profile.h"
 #include "sys/time.h"
 
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
 profile_internal_use_only_timer_t profile_internal_use_only[] = {
 # define PROFILE_TIMER_INIT( timer ) { #timer, 0., 0., 0, 0 },
   PROFILE_TIMERS( PROFILE_TIMER_INIT )
@@ -8,16 +14,177 @@ profile_internal_use_only_timer_t profile_internal_use_only[] = {
   { NULL, 0., 0., 0, 0 }
 };
 
+static const char * profile_counter_name[ PROFILE_N_COUNTER ] = {
+  "cycles", "instructions", "cache_misses"
+};
+
+static int profile_counter_fd[ PROFILE_N_COUNTER ] = { -1, -1, -1 };
+static int profile_counters_on = 0;
+
+static FILE * profile_output = NULL;
+static int profile_output_format = profile_format_json;
+static int profile_n_update = 0;
+
+int
+profile_enable_counters( void ) {
+# if defined(__linux__)
+  static const unsigned long long config[ PROFILE_N_COUNTER ] = {
+    PERF_COUNT_HW_CPU_CYCLES,
+    PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_MISSES
+  };
+  struct perf_event_attr pe;
+  int c;
+
+  if( profile_counters_on ) return 1;
+
+  for( c=0; c<PROFILE_N_COUNTER; c++ ) {
+    CLEAR( &pe, 1 );
+    pe.type           = PERF_TYPE_HARDWARE;
+    pe.size           = sizeof(pe);
+    pe.config         = config[c];
+    pe.exclude_kernel = 1;
+    pe.exclude_hv     = 1;
+    profile_counter_fd[c] = (int)syscall( __NR_perf_event_open, &pe, 0, -1, -1, 0 );
+    if( profile_counter_fd[c]<0 ) {
+      WARNING(( "perf_event counter %s unavailable; hardware counters disabled",
+                profile_counter_name[c] ));
+      for( ; c>=0; c-- ) {
+        if( profile_counter_fd[c]>=0 ) close( profile_counter_fd[c] );
+        profile_counter_fd[c] = -1;
+      }
+      return 0;
+    }
+  }
+
+  profile_counters_on = 1;
+# if defined(VPIC_ENABLE_ASYNC_PROFILE)
+  WARNING(( "Asynchronous profiling is on; KOKKOS_TIC / KOKKOS_TOC timers "
+            "will not report hardware counters (TIC / TOC timers still do)" ));
+# endif
+  return 1;
+# else
+  return 0;
+# endif
+}
+
+void
+profile_counters_read( profile_counters_t * ctr ) {
+  int c;
+  for( c=0; c<PROFILE_N_COUNTER; c++ ) ctr->c[c] = 0;
+# if defined(__linux__)
+  if( !profile_counters_on ) return;
+  for( c=0; c<PROFILE_N_COUNTER; c++ ) {
+    unsigned long long v = 0;
+    if( read( profile_counter_fd[c], &v, sizeof(v) )==sizeof(v) ) ctr->c[c] = (double)v;
+  }
+# endif
+}
+
+void
+profile_counters_accumulate( profile_internal_use_only_timer_t * timer,
+                             const profile_counters_t * start ) {
+  profile_counters_t now;
+  int c;
+  if( !profile_counters_on ) return;
+  profile_counters_read( &now );
+  for( c=0; c<PROFILE_N_COUNTER; c++ ) timer->ctr[c] += now.c[c] - start->c[c];
+}
+
+void
+profile_set_output( const char * fbase,
+                    int format ) {
+  char fname[256];
+
+  if( profile_output ) fclose( profile_output );
+  profile_output = NULL;
+  if( !fbase ) return;
+
+  if( format!=profile_format_json && format!=profile_format_csv )
+    ERROR(( "Unknown profile output format %i", format ));
+  profile_output_format = format;
+
+  snprintf( fname, sizeof(fname), "%s.%i.%s", fbase, world_rank,
+            format==profile_format_json ? "json" : "csv" );
+  profile_output = fopen( fname, "w" );
+  if( !profile_output ) ERROR(( "Could not open \"%s\"", fname ));
+
+  if( format==profile_format_csv ) {
+    int c;
+    fprintf( profile_output, "rank,update,timer,t,n,bytes,items,gbps,items_per_s,"
+                             "t_total,n_total,bytes_total,items_total,t_kernel,t_kernel_total" );
+    for( c=0; c<PROFILE_N_COUNTER; c++ )
+      fprintf( profile_output, ",%s,%s_total",
+               profile_counter_name[c], profile_counter_name[c] );
+    fprintf( profile_output, "\n" );
+  }
+}
+
+// Time the PROFILE_WORK of a timer is divided by: the kernel time for
+// asynchronously timed regions (their wall time is only the launches)
+// and the wall time otherwise
+
+static double
+work_time( double t,
+           double t_kernel ) {
+  return t_kernel>0 ? t_kernel : t;
+}
+
+static void
+write_profile_record( const profile_internal_use_only_timer_t * p ) {
+  const double t     = work_time( p->t, p->t_kernel );
+  const double gbps  = t>0 ? 1e-9*p->bytes/t : 0;
+  const double ips   = t>0 ? p->items/t     : 0;
+  int c;
+
+  if( profile_output_format==profile_format_json ) {
+    fprintf( profile_output,
+             "{\"rank\":%i,\"update\":%i,\"timer\":\"%s\",\"t\":%.6e,\"n\":%i,"
+             "\"bytes\":%.6e,\"items\":%.6e,\"gbps\":%.6e,\"items_per_s\":%.6e,"
+             "\"t_total\":%.6e,\"n_total\":%i,\"bytes_total\":%.6e,\"items_total\":%.6e,"
+             "\"t_kernel\":%.6e,\"t_kernel_total\":%.6e",
+             world_rank, profile_n_update, p->name, p->t, p->n,
+             p->bytes, p->items, gbps, ips,
+             p->t_total, p->n_total, p->bytes_total, p->items_total,
+             p->t_kernel, p->t_kernel_total );
+    if( profile_counters_on )
+      for( c=0; c<PROFILE_N_COUNTER; c++ )
+        fprintf( profile_output, ",\"%s\":%.6e,\"%s_total\":%.6e",
+                 profile_counter_name[c], p->ctr[c],
+                 profile_counter_name[c], p->ctr_total[c] );
+    fprintf( profile_output, "}\n" );
+  } else {
+    fprintf( profile_output, "%i,%i,%s,%.6e,%i,%.6e,%.6e,%.6e,%.6e,%.6e,%i,%.6e,%.6e,%.6e,%.6e",
+             world_rank, profile_n_update, p->name, p->t, p->n,
+             p->bytes, p->items, gbps, ips,
+             p->t_total, p->n_total, p->bytes_total, p->items_total,
+             p->t_kernel, p->t_kernel_total );
+    for( c=0; c<PROFILE_N_COUNTER; c++ )
+      fprintf( profile_output, ",%.6e,%.6e", p->ctr[c], p->ctr_total[c] );
+    fprintf( profile_output, "\n" );
+  }
+}
+
 void
 update_profile( int dump ) {
   profile_internal_use_only_timer_t * p;
   double sum = 0, sum_total = 0;
+  int c, has_work = 0, has_kernel = 0;
+
+  // Charge any outstanding asynchronous kernel times first
+  profile_async_resolve();
 
   for( p=profile_internal_use_only; p->name; p++ ) {
-    p->t_total += p->t;
-    p->n_total += p->n;
+    p->t_total     += p->t;
+    p->n_total     += p->n;
+    p->bytes_total += p->bytes;
+    p->items_total += p->items;
+    p->t_kernel_total += p->t_kernel;
+    for( c=0; c<PROFILE_N_COUNTER; c++ ) p->ctr_total[c] += p->ctr[c];
     sum        += p->t;
     sum_total  += p->t_total;
+    if( p->bytes_total>0 || p->items_total>0 ) has_work = 1;
+    if( p->t_kernel_total>0 ) has_kernel = 1;
   }
 
   if( dump ) {
@@ -39,11 +206,62 @@ update_profile( int dump ) {
     }
 
     log_printf( "\n" );
+
+    // Asynchronously timed regions: the times above are host wall time
+    // (mostly kernel launches), the kernels themselves ran for these
+    if( has_kernel ) {
+      log_printf( "                           |  Since Last Update  |  Since Last Restore\n"
+                  "    Operation              | Kernel Time   Per   | Kernel Time   Per\n"
+                  "---------------------------+---------------------+---------------------\n" );
+
+      for( p=profile_internal_use_only; p->name; p++ ) {
+        if( p->t_kernel_total<=0 ) continue;
+        log_printf( "%26.26s |  %.3e  %.1e |  %.3e  %.1e\n",
+                    p->name,
+                    p->t_kernel, p->t_kernel/(DBL_EPSILON+(double)p->n ),
+                    p->t_kernel_total,
+                    p->t_kernel_total/(DBL_EPSILON+(double)p->n_total) );
+      }
+
+      log_printf( "\n" );
+    }
+
+    if( has_work ) {
+      log_printf( "                           |   Since Last Update   |  Since Last Restore\n"
+                  "    Operation              |   GB/s     Items/s    |   GB/s     Items/s\n"
+                  "---------------------------+-----------------------+----------------------\n" );
+
+      for( p=profile_internal_use_only; p->name; p++ ) {
+        if( p->bytes_total<=0 && p->items_total<=0 ) continue;
+        const double t       = work_time( p->t, p->t_kernel );
+        const double t_total = work_time( p->t_total, p->t_kernel_total );
+        log_printf( "%26.26s | %.3e %.3e | %.3e %.3e\n",
+                    p->name,
+                    1e-9*p->bytes/(DBL_EPSILON+t), p->items/(DBL_EPSILON+t),
+                    1e-9*p->bytes_total/(DBL_EPSILON+t_total),
+                    p->items_total/(DBL_EPSILON+t_total) );
+      }
+
+      log_printf( "\n" );
+    }
+  }
+
+  if( profile_output ) {
+    for( p=profile_internal_use_only; p->name; p++ ) {
+      if( p->n==0 && p->n_total==0 ) continue;
+      write_profile_record( p );
+    }
+    fflush( profile_output );
   }
+  profile_n_update++;
 
   for( p=profile_internal_use_only; p->name; p++ ) {
-    p->t = 0;
-    p->n = 0;
+    p->t     = 0;
+    p->n     = 0;
+    p->bytes = 0;
+    p->items = 0;
+    p->t_kernel = 0;
+    for( c=0; c<PROFILE_N_COUNTER; c++ ) p->ctr[c] = 0;
   }
 }
 
@@ -70,6 +70,8 @@ enum profile_internal_use_only_timers {
 #define TIC                                                           \
   do {                                                                \
     double _profile_tic = wallclock();                                \
+    profile_counters_t _profile_ctr;                                  \
+    profile_counters_read( &_profile_ctr );                           \
     do
 
 #define TOC(timer,n_calls)                                            \
@@ -78,15 +80,43 @@ enum profile_internal_use_only_timers {
     wallclock() - _profile_tic;                                       \
     profile_internal_use_only[profile_internal_use_only_##timer].n += \
       (n_calls);                                                      \
+    profile_counters_accumulate(                                      \
+      &profile_internal_use_only[profile_internal_use_only_##timer],  \
+      &_profile_ctr );                                                \
   } while(0);
 
+#if defined(VPIC_ENABLE_ASYNC_PROFILE)
+
+// Asynchronous timing: no fence.  The timer gets the host wall time of
+// the region in t, and the kernels launched between KOKKOS_TIC and
+// KOKKOS_TOC are timed through Kokkos Tools callbacks and charged to its
+// t_kernel (see profile_async.cc).  The kernel times become visible when
+// update_profile is called.
+
+#define KOKKOS_TIC()                                                  \
+  do {                                                                \
+    double _profile_tic = wallclock();                                \
+    profile_async_tic();
+
+#define KOKKOS_TOC_(timer,n_calls, should_barrier)                     \
+    profile_async_toc( profile_internal_use_only_##timer );           \
+    profile_internal_use_only[profile_internal_use_only_##timer].t += \
+      wallclock() - _profile_tic;                                     \
+    profile_internal_use_only[profile_internal_use_only_##timer].n += \
+      (n_calls);                                                      \
+  } while(0);
+
+#else
+
 // TODO: these unsafe macros should be removed, but I didn't want to fight with all the extra while loop and scoping.
 //#define KOKKOS_TIC()
 //  do {
 //    std::chrono::high_resolution_clock::time_point _profile_tic = std::chrono::high_resolution_clock::now();
 #define KOKKOS_TIC()                                                  \
   do {                                                                \
-    double _profile_tic = wallclock();
+    double _profile_tic = wallclock();                                \
+    profile_counters_t _profile_ctr;                                  \
+    profile_counters_read( &_profile_ctr );
 
 // This macro:
 // 1) is more flexible but stronger scoped than the normal TIC
@@ -105,29 +135,107 @@ enum profile_internal_use_only_timers {
       wallclock() - _profile_tic;                                     \
     profile_internal_use_only[profile_internal_use_only_##timer].n += \
       (n_calls);                                                      \
+    profile_counters_accumulate(                                      \
+      &profile_internal_use_only[profile_internal_use_only_##timer],  \
+      &_profile_ctr );                                                \
   } while(0);
 
+#endif // VPIC_ENABLE_ASYNC_PROFILE
+
 #define KOKKOS_TOC(timer,n_calls) KOKKOS_TOC_(timer, n_calls, 1)
 // N for no barrier
 #define KOKKOS_TOCN(timer,n_calls) KOKKOS_TOC_(timer, n_calls, 0)
 
+// PROFILE_WORK records the work done in a timed region so the profile
+// can report achieved bandwidth and throughput.  bytes is the nominal
+// memory traffic and items the number of particles or voxels processed.
+// For example:
+//
+//   KOKKOS_TIC(); push( sp ); KOKKOS_TOC( advance_p, 1 );
+//   PROFILE_WORK( advance_p, 56.*sp->np, sp->np );
+
+#define PROFILE_WORK(timer,n_bytes,n_items) do {                          \
+    profile_internal_use_only[profile_internal_use_only_##timer].bytes += \
+      (double)(n_bytes);                                                  \
+    profile_internal_use_only[profile_internal_use_only_##timer].items += \
+      (double)(n_items);                                                  \
+  } while(0)
+
 // Do not touch these
 
+// Hardware counters read by the timers when profile_enable_counters
+// succeeds: cycles, instructions and last level cache misses.
+
+#define PROFILE_N_COUNTER 3
+
+typedef struct profile_counters {
+  double c[PROFILE_N_COUNTER];
+} profile_counters_t;
 
 typedef struct profile_internal_use_only_timer {
   const char * name;
   double t, t_total;
   int n, n_total;
+  double bytes, bytes_total;
+  double items, items_total;
+  double ctr[PROFILE_N_COUNTER], ctr_total[PROFILE_N_COUNTER];
+  double t_kernel, t_kernel_total; // Asynchronous kernel time
 } profile_internal_use_only_timer_t;
 
 extern profile_internal_use_only_timer_t profile_internal_use_only[];
 
+void
+profile_counters_read( profile_counters_t * ctr );
+
+void
+profile_counters_accumulate( profile_internal_use_only_timer_t * timer,
+                             const profile_counters_t * start );
+
 // Updates the cumulative profile, resets the local profile and, if
 // dump is true, writes the local and cumulative profiles to the log.
 
 void
 update_profile( int dump );
 
+// Machine readable profile output.  Once set, every update_profile call
+// appends one record per active timer to <fbase>.<rank>.json (one JSON
+// object per line) or <fbase>.<rank>.csv on every rank.  Records carry
+// the times, counts, PROFILE_WORK totals, the derived GB/s and items/s,
+// the asynchronous kernel times and any hardware counters.  The rates
+// use the kernel time for timers that have one.  A NULL fbase turns the
+// output off.
+
+enum profile_formats {
+  profile_format_json = 0,
+  profile_format_csv  = 1
+};
+
+void
+profile_set_output( const char * fbase,
+                    int format );
+
+// Starts Linux perf_event counters for the calling thread.  Only work
+// done by that thread is counted (for device builds, the host side of a
+// kernel launch).  Returns 1 on success and 0 if counters are not
+// available, in which case the counter fields stay zero.  With
+// VPIC_ENABLE_ASYNC_PROFILE the KOKKOS_TIC / KOKKOS_TOC timers do not
+// read the counters (the kernels they time run behind the host thread);
+// only TIC / TOC timers report them.
+
+int
+profile_enable_counters( void );
+
+// Asynchronous timing support (profile_async.cc).  These are no-ops unless
+// VPIC_ENABLE_ASYNC_PROFILE is defined.  profile_async_initialize installs
+// the Kokkos Tools callbacks, chaining to any that were already installed
+// (e.g. a tool loaded through KOKKOS_PROFILE_LIBRARY), and is called by
+// boot_services.
+
+void profile_async_initialize( void );
+void profile_async_tic( void );
+void profile_async_toc( int timer );
+void profile_async_resolve( void );
+
 // Returns a local wallclock in seconds.  Only relative values are
 // accurate, and then only within same "short run".
 
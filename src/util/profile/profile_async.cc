@@ -0,0 +1,215 @@
+// Asynchronous (non-fencing) timing for the KOKKOS_TIC / KOKKOS_TOC
+// timers, enabled with VPIC_ENABLE_ASYNC_PROFILE.
+//
+// The timers get the host wall time of the region (without a fence this
+// is mostly launch cost) in t and the time the kernels of the region ran
+// for in t_kernel.  Kernels are timed through Kokkos Tools begin/end
+// callbacks.  On host backends kernels run synchronously so the
+// callbacks can simply read the clock.  On CUDA the callbacks record
+// events on the stream of the execution space instance the kernel was
+// launched on, which does not block the host.  KOKKOS_TIC marks the
+// current end of the kernel record list and KOKKOS_TOC charges every
+// unclaimed record since that mark to its timer (inner regions claim
+// first).  Records are turned into times by profile_async_resolve, which
+// update_profile calls once per status interval; on CUDA that is the
+// only place the host waits on the device.
+//
+// A Kokkos tool loaded through KOKKOS_PROFILE_LIBRARY (or any callbacks
+// installed before profile_async_initialize) keeps working: the
+// callbacks found at initialization are called from ours.
+
+#include "profile.h"
+
+#if defined(VPIC_ENABLE_ASYNC_PROFILE)
+
+#include <Kokkos_Core.hpp>
+#include <vector>
+
+#if defined(KOKKOS_ENABLE_CUDA)
+#include <cuda_runtime.h>
+#endif
+
+namespace {
+
+using namespace Kokkos::Tools::Experimental;
+
+struct kernel_record {
+  int timer;          // Timer charged, or -1 while unclaimed
+  uint64_t tool_id;   // Kernel id handed out by the chained tool
+#if defined(KOKKOS_ENABLE_CUDA)
+  int timed;          // Launched on a known instance
+  cudaStream_t stream;
+  cudaEvent_t begin, end;
+#else
+  double begin, end;
+#endif
+};
+
+std::vector<kernel_record> records;
+std::vector<size_t> marks;            // Open KOKKOS_TIC regions
+uint64_t first_id = 0;                // Kernel id of records[0]
+
+EventSet chained;                     // Callbacks found at initialization
+
+#if defined(KOKKOS_ENABLE_CUDA)
+std::vector<cudaEvent_t> event_pool;
+
+// Execution space instances kernels can be timed on.  Kernels launched on
+// any other instance are counted but not timed, since recording events on
+// a different stream would time the wrong work.
+std::vector<uint32_t> instance_ids;
+std::vector<cudaStream_t> instance_streams;
+int warned_unknown_instance = 0;
+
+cudaEvent_t
+get_event() {
+  cudaEvent_t e;
+  if( event_pool.empty() ) {
+    if( cudaEventCreate( &e )!=cudaSuccess ) ERROR(( "cudaEventCreate failed" ));
+  } else {
+    e = event_pool.back();
+    event_pool.pop_back();
+  }
+  return e;
+}
+
+int
+find_stream( uint32_t dev_id, cudaStream_t * stream ) {
+  for( size_t i=0; i<instance_ids.size(); i++ )
+    if( instance_ids[i]==dev_id ) { *stream = instance_streams[i]; return 1; }
+  if( !warned_unknown_instance ) {
+    WARNING(( "Kernel launched on an unregistered execution space instance "
+              "(device id %u); its time is not charged to any timer", dev_id ));
+    warned_unknown_instance = 1;
+  }
+  return 0;
+}
+#endif
+
+void
+begin_kernel( uint32_t dev_id, uint64_t * kID ) {
+  kernel_record r;
+  r.timer = -1;
+  r.tool_id = 0;
+#if defined(KOKKOS_ENABLE_CUDA)
+  r.timed = find_stream( dev_id, &r.stream );
+  if( r.timed ) {
+    r.begin = get_event();
+    r.end   = get_event();
+    cudaEventRecord( r.begin, r.stream );
+  }
+#else
+  r.begin = r.end = wallclock();
+#endif
+  *kID = first_id + records.size();
+  records.push_back( r );
+}
+
+kernel_record *
+end_kernel( uint64_t kID ) {
+  if( kID<first_id || kID-first_id>=records.size() ) return NULL;
+  kernel_record & r = records[ kID-first_id ];
+#if defined(KOKKOS_ENABLE_CUDA)
+  if( r.timed ) cudaEventRecord( r.end, r.stream );
+#else
+  r.end = wallclock();
+#endif
+  return &r;
+}
+
+#define PROFILE_ASYNC_CALLBACKS( kind )                                     \
+  void                                                                      \
+  async_begin_##kind( const char * name, uint32_t dev_id, uint64_t * kID ) {\
+    begin_kernel( dev_id, kID );                                            \
+    if( chained.begin_##kind )                                              \
+      chained.begin_##kind( name, dev_id, &records.back().tool_id );        \
+  }                                                                         \
+                                                                            \
+  void                                                                      \
+  async_end_##kind( uint64_t kID ) {                                        \
+    kernel_record * r = end_kernel( kID );                                  \
+    if( r && chained.end_##kind ) chained.end_##kind( r->tool_id );         \
+  }
+
+PROFILE_ASYNC_CALLBACKS( parallel_for )
+PROFILE_ASYNC_CALLBACKS( parallel_reduce )
+PROFILE_ASYNC_CALLBACKS( parallel_scan )
+
+#undef PROFILE_ASYNC_CALLBACKS
+
+} // namespace
+
+void
+profile_async_initialize( void ) {
+  // Installing twice would chain to ourselves
+  EventSet current = get_callbacks();
+  if( current.begin_parallel_for==async_begin_parallel_for ) return;
+  chained = current;
+
+#if defined(KOKKOS_ENABLE_CUDA)
+  if( instance_ids.empty() ) {
+    instance_ids.push_back( device_id( Kokkos::Cuda() ) );
+    instance_streams.push_back( Kokkos::Cuda().cuda_stream() );
+  }
+#endif
+
+  set_begin_parallel_for_callback( async_begin_parallel_for );
+  set_end_parallel_for_callback( async_end_parallel_for );
+  set_begin_parallel_reduce_callback( async_begin_parallel_reduce );
+  set_end_parallel_reduce_callback( async_end_parallel_reduce );
+  set_begin_parallel_scan_callback( async_begin_parallel_scan );
+  set_end_parallel_scan_callback( async_end_parallel_scan );
+}
+
+void
+profile_async_tic( void ) {
+  marks.push_back( records.size() );
+}
+
+void
+profile_async_toc( int timer ) {
+  if( marks.empty() ) ERROR(( "KOKKOS_TOC without KOKKOS_TIC" ));
+  for( size_t i=marks.back(); i<records.size(); i++ )
+    if( records[i].timer<0 ) records[i].timer = timer;
+  marks.pop_back();
+
+  // Keep the record list bounded on long status intervals.  This is only
+  // done outside any open region since open regions hold list offsets.
+  if( marks.empty() && records.size()>65536 ) profile_async_resolve();
+}
+
+void
+profile_async_resolve( void ) {
+  if( !marks.empty() ) return;
+
+#if defined(KOKKOS_ENABLE_CUDA)
+  for( size_t i=0; i<instance_streams.size(); i++ )
+    cudaStreamSynchronize( instance_streams[i] );
+#endif
+
+  for( size_t i=0; i<records.size(); i++ ) {
+    kernel_record & r = records[i];
+#if defined(KOKKOS_ENABLE_CUDA)
+    if( !r.timed ) continue;
+    float ms = 0;
+    if( r.timer>=0 && cudaEventElapsedTime( &ms, r.begin, r.end )==cudaSuccess )
+      profile_internal_use_only[ r.timer ].t_kernel += 1e-3*ms;
+    event_pool.push_back( r.begin );
+    event_pool.push_back( r.end );
+#else
+    if( r.timer>=0 ) profile_internal_use_only[ r.timer ].t_kernel += r.end - r.begin;
+#endif
+  }
+
+  first_id += records.size();
+  records.clear();
+}
+
+#else
+
+void profile_async_initialize( void ) {}
+void profile_async_tic( void ) {}
+void profile_async_toc( int ) {}
+void profile_async_resolve( void ) {}
+
+#endif // VPIC_ENABLE_ASYNC_PROFILE
@@ -14,13 +14,18 @@ int vpic_simulation::advance(void)
 
   //printf("%d: Step %d \n", rank(), step());
 
-  // Use default policy, for now
+  // Use default policy, for now. The default compressor relies on advance_p
+  // having flagged the gaps near the end of the particle array.
   ParticleCompressor<> compressor;
   ParticleSorter<> sorter;
 
   // Determine if we are done ... see note below why this is done here
   if( num_step>0 && step()>=num_step ) return 0;
 
+  // PROFILE_WORK below records the nominal compulsory memory traffic per
+  // voxel or particle, assuming stencil neighbours come from cache.
+  double n_sorted = 0;
+
   KOKKOS_TIC();
 
   // Sort the particles for performance if desired.
@@ -29,11 +34,25 @@ int vpic_simulation::advance(void)
       if( (sp->sort_interval>0) && ((step() % sp->sort_interval)==0) )
       {
           if( rank()==0 ) MESSAGE(( "Performance sorting \"%s\"", sp->name ));
-          sorter.sort( sp->k_p_d, sp->k_p_i_d, sp->np, grid->nv);
+          const int strategy = sorter.select( sp );
+          double sort_start = 0;
+          if( sp->sort_auto_current>=0 ) {
+            Kokkos::fence();
+            sort_start = wallclock();
+          }
+          sorter.sort( sp, strategy, grid->nv );
+          if( sp->sort_auto_current>=0 ) {
+            Kokkos::fence();
+            sp->sort_auto_time[strategy] += wallclock() - sort_start;
+          }
+          sp->last_sorted = step();
+          n_sorted += sp->np;
       }
   }
 
   KOKKOS_TOC( sort_particles, 1);
+  // Each particle is read and written once
+  PROFILE_WORK( sort_particles, 2.*sizeof(particle_t)*n_sorted, n_sorted );
 
   // At this point, fields are at E_0 and B_0 and the particle positions
   // are at r_0 and u_{-1/2}.  Further the mover lists for the particles should
@@ -58,8 +77,10 @@ int vpic_simulation::advance(void)
   //printf("Cleared jf\n");
   if( collision_op_list )
   {
-      Kokkos::abort("Collision is not supported");
-      TIC apply_collision_op_list( collision_op_list ); TOC( collision_model, 1 );
+      // Only device models (e.g. takizuka_abe) see the Kokkos particles
+      if( num_host_collision_op( collision_op_list ) )
+          Kokkos::abort("Host collision models are not supported");
+      KOKKOS_TIC(); apply_collision_op_list( collision_op_list ); KOKKOS_TOC( collision_model, 1 );
   }
 
   // TODO: implement
@@ -69,27 +90,32 @@ int vpic_simulation::advance(void)
   LIST_FOR_EACH( sp, species_list )
   {
       // Now Times internally
-      advance_p( sp, interpolator_array, field_array );
+      if( sp->sort_auto_current>=0 ) {
+        // Charge the push to the sort strategy being tried. advance_p
+        // copies the mover count back, so it is done when it returns.
+        const double push_start = wallclock();
+        advance_p( sp, interpolator_array, field_array, kokkos_tiled_advance_p );
+        sp->sort_auto_time[sp->sort_auto_current] += wallclock() - push_start;
+      } else {
+        advance_p( sp, interpolator_array, field_array, kokkos_tiled_advance_p );
+      }
   }
   //printf("Pushed\n");
 
   // Reduce accumulator contributions into the device array
   KOKKOS_TIC();
   // These aren't behaving as I expect on CPUs, so I'm now doing this at the
-  // end of advance_p.  This is rather wasteful of view allocs and contributes.
-  // TODO: Only contribute once per timestep and do one view creation per
-  // simulation.
+  // end of advance_p, which contributes the field array's persistent scatter
+  // view and resets it with reset_except (reset alone would clear the fields
+  // on backends where the scatter view aliases them).
+  // TODO: Only contribute once per timestep.
   //Kokkos::Experimental::contribute(field_array->k_f_d, field_array->k_field_sa_d);
   //field_array->k_field_sa_d.reset_except(field_array->k_f_d);
   //field_array->k_field_sa_d.reset();
   KOKKOS_TOC( field_sa_contributions, 1);
 
-  // Copy particle movers back to host
-  KOKKOS_TIC();
-  LIST_FOR_EACH( sp, species_list ) {
-    sp->copy_outbound_to_host();
-  }
-  KOKKOS_TOC( PARTICLE_DATA_MOVEMENT, 1);
+  const bool inject_step = (particle_injection_interval>0) &&
+    ((step() % particle_injection_interval)==0);
 
   // Because the partial position push when injecting aged particles might
   // place those particles onto the guard list (boundary interaction) and
@@ -97,29 +123,50 @@ int vpic_simulation::advance(void)
   // be done after advance_p and before guard list processing. Note:
   // user_particle_injection should be a stub if species_list is empty.
 
-  // Probably needs to be on host due to user particle injection
-  // May not touch memory?
+  // Emitters age their particles with the device mover, so like device
+  // injection they run before the movers are read back.
   if( emitter_list )
   {
-    TIC apply_emitter_list( emitter_list ); TOC( emission_model, 1 );
+    if( num_host_emitter( emitter_list ) )
+      ERROR(( "Host emitters are not supported" ));
+    KOKKOS_TIC(); apply_emitter_list( emitter_list ); KOKKOS_TOC( emission_model, 1 );
   }
 
-  if((particle_injection_interval>0) && ((step() % particle_injection_interval)==0)) {
-      if(!kokkos_particle_injection) {
-          KOKKOS_TIC();
-          LIST_FOR_EACH( sp, species_list ) {
-            sp->copy_to_host();
-          }
-          KOKKOS_TOC(PARTICLE_DATA_MOVEMENT, 1);
+  // Device injection (inject_particles) may add movers for aged particles
+  // that reach a boundary, so it runs before the movers are read back.
+  if( inject_step && kokkos_particle_injection ) {
+      TIC user_particle_injection(); TOC( user_particle_injection, 1 );
+  }
+
+  // The device boundary exchange needs the movers to stay where advance_p
+  // left them, so anything below that works on them on the host forces the
+  // host path for this step
+  bool device_boundary_p = kokkos_boundary_p &&
+    !( inject_step && !kokkos_particle_injection );
+  LIST_FOR_EACH( sp, species_list ) {
+    if( sp->pb_diag->enable ) device_boundary_p = false;
+  }
+
+  // Copy particle movers back to host
+  KOKKOS_TIC();
+  LIST_FOR_EACH( sp, species_list ) {
+    if( device_boundary_p ) sp->nm = sp->k_nm_h(0);
+    else                    sp->copy_outbound_to_host();
+  }
+  KOKKOS_TOC( PARTICLE_DATA_MOVEMENT, 1);
+
+  if( inject_step && !kokkos_particle_injection ) {
+      KOKKOS_TIC();
+      LIST_FOR_EACH( sp, species_list ) {
+        sp->copy_to_host();
       }
+      KOKKOS_TOC(PARTICLE_DATA_MOVEMENT, 1);
       TIC user_particle_injection(); TOC( user_particle_injection, 1 );
-      if(!kokkos_particle_injection) {
-          KOKKOS_TIC();
-          LIST_FOR_EACH( sp, species_list ) {
-            sp->copy_to_device();
-          }
-          KOKKOS_TOC(PARTICLE_DATA_MOVEMENT, 1);
+      KOKKOS_TIC();
+      LIST_FOR_EACH( sp, species_list ) {
+        sp->copy_to_device();
       }
+      KOKKOS_TOC(PARTICLE_DATA_MOVEMENT, 1);
   }
 
   //bool accumulate_in_place = false; // This has to be outside the scoped timing block
@@ -157,7 +204,10 @@ int vpic_simulation::advance(void)
     for( int round=0; round<num_comm_round; round++ )
     {
       //boundary_p( particle_bc_list, species_list, field_array, accumulator_array );
-      boundary_p_kokkos( particle_bc_list, species_list, field_array );
+      if( device_boundary_p )
+        boundary_p_kokkos_device( particle_bc_list, species_list, field_array );
+      else
+        boundary_p_kokkos( particle_bc_list, species_list, field_array );
     }
   TOC( boundary_p, num_comm_round );
 
@@ -170,7 +220,8 @@ int vpic_simulation::advance(void)
       KOKKOS_TIC(); // Time this data movement
       const int nm = sp->k_nm_h(0);
 
-      // TODO: this can be hoisted to the end of advance_p if desired
+      // The gap and donor bookkeeping was started in advance_p, so this is
+      // O(nm) and does not need to read anything back from the device
       compressor.compress(
               sp->k_p_d,
               sp->k_p_i_d,
@@ -186,7 +237,8 @@ int vpic_simulation::advance(void)
 
       // Copy data for copies back to device
       KOKKOS_TIC();
-        sp->copy_inbound_to_device();
+      if( device_boundary_p ) sp->append_inbound_on_device();
+      else                    sp->copy_inbound_to_device();
       KOKKOS_TOC( PARTICLE_DATA_MOVEMENT, 1);
 
   }
@@ -229,13 +281,13 @@ int vpic_simulation::advance(void)
   if((current_injection_interval>0) && ((step() % current_injection_interval)==0)) {
       if(!kokkos_current_injection) {
           KOKKOS_TIC();
-          field_array->copy_to_host();
+          field_array->copy_to_host( current_injection_region );
           KOKKOS_TOC(FIELD_DATA_MOVEMENT, 1);
       }
       TIC user_current_injection(); TOC( user_current_injection, 1 );
       if(!kokkos_current_injection) {
           KOKKOS_TIC();
-          field_array->copy_to_device();
+          field_array->copy_to_device( current_injection_region );
           KOKKOS_TOC(FIELD_DATA_MOVEMENT, 1);
       }
   }
@@ -245,12 +297,18 @@ int vpic_simulation::advance(void)
   KOKKOS_TIC();
   FAK->advance_b( field_array, 0.5 );
   KOKKOS_TOC( advance_b, 1 );
+  // Reads E and cB, writes cB
+  PROFILE_WORK( advance_b, 9.*sizeof(float)*grid->nv, grid->nv );
 
   // Advance the electric field from E_0 to E_1
 
   // Device - Touches fields
   //  TIC FAK->advance_e( field_array, 1.0 ); TOC( advance_e, 1 );
-  TIC FAK->advance_e_kokkos( field_array, 1.0 ); TOC( advance_e, 1 );
+  KOKKOS_TIC();
+  FAK->advance_e_kokkos( field_array, 1.0 );
+  KOKKOS_TOC( advance_e, 1 );
+  // Reads E, cB, J and TCA, writes E and TCA
+  PROFILE_WORK( advance_e, 18.*sizeof(float)*grid->nv, grid->nv );
 
   // Let the user add their own contributions to the electric field. It is the
   // users responsibility to insure injected electric fields are consistent
@@ -259,13 +317,13 @@ int vpic_simulation::advance(void)
   if ((field_injection_interval>0) && ((step() % field_injection_interval)==0)) {
       if (!kokkos_field_injection) {
           KOKKOS_TIC();
-          field_array->copy_to_host();
+          field_array->copy_to_host( field_injection_region );
           KOKKOS_TOC(FIELD_DATA_MOVEMENT, 1);
       }
       TIC user_field_injection(); TOC( user_field_injection, 1 );
       if (!kokkos_field_injection) {
           KOKKOS_TIC();
-          field_array->copy_to_device();
+          field_array->copy_to_device( field_injection_region );
           KOKKOS_TOC(FIELD_DATA_MOVEMENT, 1);
       }
   }
@@ -274,7 +332,10 @@ int vpic_simulation::advance(void)
 
   // DEVICE
   // Touches fields
-  TIC FAK->advance_b( field_array, 0.5 ); TOC( advance_b, 1 );
+  KOKKOS_TIC();
+  FAK->advance_b( field_array, 0.5 );
+  KOKKOS_TOC( advance_b, 1 );
+  PROFILE_WORK( advance_b, 9.*sizeof(float)*grid->nv, grid->nv );
 
   // Divergence clean e
 
@@ -290,10 +351,20 @@ int vpic_simulation::advance(void)
       if( species_list )
       {
           KOKKOS_TIC();
-          LIST_FOR_EACH( sp, species_list )
+          if( kokkos_sorted_rho_p )
+          {
+              std::vector<species_t *> sps;
+              LIST_FOR_EACH( sp, species_list ) sps.push_back( sp );
+              k_accumulate_rho_p_sorted( field_array, sps.data(), (int)sps.size(),
+                                         deterministic_rho_p );
+          }
+          else
           {
-              //accumulate_rho_p( field_array, sp ); //TOC( accumulate_rho_p, species_list->id );
-              k_accumulate_rho_p( field_array, sp );
+              LIST_FOR_EACH( sp, species_list )
+              {
+                  //accumulate_rho_p( field_array, sp ); //TOC( accumulate_rho_p, species_list->id );
+                  k_accumulate_rho_p( field_array, sp );
+              }
           }
           KOKKOS_TOC( accumulate_rho_p, species_list->id );
       }
@@ -355,7 +426,15 @@ int vpic_simulation::advance(void)
 
   // DEVICE
   // Touches fields, interpolators
-  if( species_list ) TIC load_interpolator_array( interpolator_array, field_array ); TOC( load_interpolator, 1 );
+  if( species_list ) {
+    KOKKOS_TIC();
+    load_interpolator_array( interpolator_array, field_array );
+    KOKKOS_TOC( load_interpolator, 1 );
+    // Reads E and cB, writes the interpolator (deferred when interpolating
+    // on the fly)
+    if( !interpolator_array->on_the_fly )
+      PROFILE_WORK( load_interpolator, (6.*sizeof(float)+sizeof(interpolator_t))*grid->nv, grid->nv );
+  }
 
   step()++;
 
@@ -363,6 +442,7 @@ int vpic_simulation::advance(void)
   if( (status_interval>0) && ((step() % status_interval)==0) ) {
       if( rank()==0 ) MESSAGE(( "Completed step %i of %i", step(), num_step ));
       update_profile( rank()==0 );
+      workspace_report( rank()==0 );
   }
 
   // Let the user compute diagnostics
@@ -24,6 +24,14 @@
 
 const int max_filename_bytes = 256;
 
+// Host staging for device to host dump streams.  Pinned memory lets the
+// copies run asynchronously with respect to the host.
+#if defined(KOKKOS_ENABLE_CUDA)
+typedef Kokkos::CudaHostPinnedSpace dump_host_space;
+#else
+typedef Kokkos::HostSpace dump_host_space;
+#endif
+
 int vpic_simulation::dump_mkdir(const char * dname) {
 	return FileUtils::makeDirectory(dname);
 } // dump_mkdir
@@ -32,6 +40,56 @@ int vpic_simulation::dump_cwd(char * dname, size_t size) {
 	return FileUtils::getCurrentWorkingDirectory(dname, size);
 } // dump_mkdir
 
+// Returns the background writer used by the binary dumps, or NULL when
+// they should write synchronously.  The MP relay I/O policy is only used
+// from the main thread, so relay builds always write synchronously.
+DumpWriter * vpic_simulation::async_writer() {
+#if defined USE_MPRELAY
+	return NULL;
+#else
+	if( !async_dump ) return NULL;
+	if( !dump_writer ) dump_writer = new DumpWriter();
+	return dump_writer;
+#endif
+} // async_writer
+
+// Checkpts the registered objects to fname (see checkpt_objects).  With
+// async_checkpt the checkpt is serialized to host memory, which includes
+// copying the device data back, and written by checkpt_writer while the
+// caller carries on.  The writer holds a single checkpt, so this first
+// waits for the previous one to be on disk.
+//
+// If fname is the base the newest (delta) checkpt refers to, e.g. when
+// alternating between two restart names, the new checkpt is written next
+// to it and renamed over it once complete, so a restorable checkpt exists
+// throughout the write.
+void vpic_simulation::checkpt_objects(const char * fname) {
+	const int delta = checkpt_full_interval>1 && n_checkpt%checkpt_full_interval;
+	n_checkpt++;
+
+#if !defined USE_MPRELAY
+	if( async_checkpt ) {
+		if( !checkpt_writer ) checkpt_writer = new DumpWriter(1);
+		std::vector<char> data;
+		checkpt_writer->flush();
+		const bool replace = checkpt_base_in_use( fname );
+		::checkpt_objects_buffered( fname, data, delta );
+		checkpt_writer->submit( fname, data, replace );
+		return;
+	}
+#endif
+
+	const bool replace = checkpt_base_in_use( fname );
+	if( !delta && !replace ) {
+		::checkpt_objects( fname );
+		return;
+	}
+
+	std::vector<char> data;
+	::checkpt_objects_buffered( fname, data, delta );
+	DumpWriter::write_file( fname, data, replace );
+} // checkpt_objects
+
 /*****************************************************************************
  * ASCII dump IO
  *****************************************************************************/
@@ -188,7 +246,7 @@ vpic_simulation::dump_fields( const char *fbase, int ftag ) {
         field_array->copy_to_host();
 
   char fname[max_filename_bytes];
-  FileIO fileIO;
+  DumpStream fileIO( async_writer() );
   int dim[3];
 
   if( !fbase ) ERROR(( "Invalid filename" ));
@@ -200,6 +258,7 @@ vpic_simulation::dump_fields( const char *fbase, int ftag ) {
 
   FileIOStatus status = fileIO.open(fname, io_write);
   if( status==fail ) ERROR(( "Could not open \"%s\".", fname ));
+  fileIO.reserve( 256 + sizeof(field_t)*grid->nv );
 
   /* IMPORTANT: these values are written in WRITE_HEADER_V0 */
   nxout = grid->nx;
@@ -227,31 +286,13 @@ vpic_simulation::dump_hydro( const char *sp_name,
 
   species_t *sp;
   char fname[max_filename_bytes];
-  FileIO fileIO;
+  DumpStream fileIO( async_writer() );
   int dim[3];
 
   sp = find_species_name( sp_name, species_list );
   if( !sp ) ERROR(( "Invalid species \"%s\"", sp_name ));
 
-  auto& particles = sp->k_p_d;
-  auto& particles_i = sp->k_p_i_d;
-  auto& interpolators_k = interpolator_array->k_i_d;
-
-  Kokkos::deep_copy(hydro_array->k_h_d, 0.0f);
-  accumulate_hydro_p_kokkos(
-      particles,
-      particles_i,
-      hydro_array->k_h_d,
-      interpolators_k,
-      sp
-  );
-
-  // This is slower in my tests
-  //synchronize_hydro_array_kokkos(hydro_array);
-
-  hydro_array->copy_to_host();
-
-  synchronize_hydro_array( hydro_array );
+  load_hydro( &sp, 1 );
 
   if( !fbase ) ERROR(( "Invalid filename" ));
 
@@ -267,6 +308,7 @@ vpic_simulation::dump_hydro( const char *sp_name,
 
   FileIOStatus status = fileIO.open(fname, io_write);
   if( status==fail) ERROR(( "Could not open \"%s\".", fname ));
+  fileIO.reserve( 256 + sizeof(hydro_t)*grid->nv );
 
   /* IMPORTANT: these values are written in WRITE_HEADER_V0 */
   nxout = grid->nx;
@@ -294,22 +336,15 @@ vpic_simulation::dump_particles( const char *sp_name,
 
     species_t *sp;
     char fname[max_filename_bytes];
-    FileIO fileIO;
-    int dim[1], buf_start;
-    static particle_t * ALIGNED(128) p_buf = NULL;
-# define PBUF_SIZE 32768 // 1MB of particles
+    DumpStream fileIO( async_writer() );
+    int dim[1];
+# define PBUF_SIZE 1048576 // 32MB of particles per buffer
 
     sp = find_species_name( sp_name, species_list );
     if( !sp ) ERROR(( "Invalid species name \"%s\".", sp_name ));
 
     if( !fbase ) ERROR(( "Invalid filename" ));
 
-    // Update the particles on the host only if they haven't been recently
-    if (step() > sp->last_copied)
-      sp->copy_to_host();
-
-    if( !p_buf ) MALLOC_ALIGNED( p_buf, PBUF_SIZE, 128 );
-
     if( rank()==0 )
         MESSAGE(("Dumping \"%s\" particles to \"%s\"",sp->name,fbase));
 
@@ -322,6 +357,7 @@ vpic_simulation::dump_particles( const char *sp_name,
 
     FileIOStatus status = fileIO.open(fname, io_write);
     if( status==fail ) ERROR(( "Could not open \"%s\"", fname ));
+    fileIO.reserve( 256 + sizeof(particle_t)*sp->np );
 
     /* IMPORTANT: these values are written in WRITE_HEADER_V0 */
     nxout = grid->nx;
@@ -334,28 +370,41 @@ vpic_simulation::dump_particles( const char *sp_name,
     WRITE_HEADER_V0( dump_type::particle_dump, sp->id, sp->q/sp->m, fileIO );
 
     dim[0] = sp->np;
-    WRITE_ARRAY_HEADER( p_buf, 1, dim, fileIO );
-
-    // Copy a PBUF_SIZE hunk of the particle list into the particle
-    // buffer, timecenter it and write it out. This is done this way to
-    // guarantee the particle list unchanged while not requiring too
-    // much memory.
-
-    // FIXME: WITH A PIPELINED CENTER_P, PBUF NOMINALLY SHOULD BE QUITE
-    // LARGE.
-
-    particle_t * sp_p = sp->p;      sp->p      = p_buf;
-    int sp_np         = sp->np;     sp->np     = 0;
-    int sp_max_np     = sp->max_np; sp->max_np = PBUF_SIZE;
-    for( buf_start=0; buf_start<sp_np; buf_start += PBUF_SIZE ) {
-        sp->np = sp_np-buf_start; if( sp->np > PBUF_SIZE ) sp->np = PBUF_SIZE;
-        COPY( sp->p, &sp_p[buf_start], sp->np );
-        center_p( sp, interpolator_array );
-        fileIO.write( sp->p, sp->np );
+    WRITE_ARRAY_HEADER( sp->p, 1, dim, fileIO );
+
+    // Stream the species out in PBUF_SIZE chunks.  Each chunk is time
+    // centered on the device into a scratch buffer (so the particle list
+    // is unchanged) and copied asynchronously into one of two host
+    // buffers while the previous chunk is being written.
+
+    const int np = sp->np;
+    const int nbuf = np < PBUF_SIZE ? np : PBUF_SIZE;
+    const int nchunk = ( np + PBUF_SIZE - 1 ) / PBUF_SIZE;
+    Kokkos::DefaultExecutionSpace exec;
+
+    Kokkos::View<particle_t*> chunk_d[2];
+    Kokkos::View<particle_t*, dump_host_space> chunk_h[2];
+    for( int b=0; b<2 && b<nchunk; b++ ) {
+        chunk_d[b] = Kokkos::View<particle_t*>( "dump_particles chunk", nbuf );
+        chunk_h[b] = Kokkos::View<particle_t*, dump_host_space>( "dump_particles host chunk", nbuf );
     }
-    sp->p      = sp_p;
-    sp->np     = sp_np;
-    sp->max_np = sp_max_np;
+
+    auto stage = [&]( int c ) {
+        const int b = c%2, first = c*PBUF_SIZE;
+        const int n = np-first < PBUF_SIZE ? np-first : PBUF_SIZE;
+        center_p_kokkos( sp, interpolator_array, first, n, chunk_d[b] );
+        Kokkos::deep_copy( exec, Kokkos::subview( chunk_h[b], std::make_pair(0, n) ),
+                                 Kokkos::subview( chunk_d[b], std::make_pair(0, n) ) );
+    };
+
+    if( nchunk ) stage( 0 );
+    for( int c=0; c<nchunk; c++ ) {
+        exec.fence();
+        if( c+1<nchunk ) stage( c+1 );
+        const int n = np-c*PBUF_SIZE < PBUF_SIZE ? np-c*PBUF_SIZE : PBUF_SIZE;
+        fileIO.write( chunk_h[c%2].data(), n );
+    }
+# undef PBUF_SIZE
 
     if( fileIO.close() ) ERROR(("File close failed on dump particles!!!"));
 }
@@ -556,13 +605,78 @@ vpic_simulation::global_header( const char * base,
   if( fileIO.close() ) ERROR(( "File close failed on global header!!!" ));
 }
 
+/*****************************************************************************
+ * Strided gathers for band and band_interleave dumps
+ *
+ * A strided dump writes the ghost layers plus every stride-th voxel along
+ * each axis.  Output index i maps to voxel 0, i*stride or n+1, which with
+ * unit stride is simply i.  The gathers below stage a whole band (one
+ * variable) or a whole strided array so it goes out in a single write.
+ *****************************************************************************/
+
+static inline size_t
+dump_offset( size_t i, size_t nout, size_t n, size_t stride ) {
+  return (i == 0) ? 0 : (i == nout+1) ? n+1 : i*stride;
+}
+
+// Gathers 32-bit word var of every output voxel of the array of
+// structures a into band, x fastest.
+template<typename T> static void
+gather_band( const T * a, size_t var, const grid_t * g,
+             size_t nxout, size_t nyout, size_t nzout,
+             size_t istride, size_t jstride, size_t kstride,
+             uint32_t * band ) {
+  size_t n = 0;
+  for(size_t k(0); k<nzout+2; k++) { const size_t koff = dump_offset(k, nzout, g->nz, kstride);
+  for(size_t j(0); j<nyout+2; j++) { const size_t joff = dump_offset(j, nyout, g->ny, jstride);
+  for(size_t i(0); i<nxout+2; i++) { const size_t ioff = dump_offset(i, nxout, g->nx, istride);
+    const uint32_t * ref = reinterpret_cast<const uint32_t *>(&a[VOXEL(ioff,joff,koff, g->nx,g->ny,g->nz)]);
+    band[n++] = ref[var];
+  }
+  }
+  }
+}
+
+// Gathers whole structures for ni x nj x nk output voxels into out.
+template<typename T> static void
+gather_strided( const T * a, const grid_t * g,
+                size_t nxout, size_t nyout, size_t nzout,
+                size_t ni, size_t nj, size_t nk,
+                size_t istride, size_t jstride, size_t kstride,
+                T * out ) {
+  size_t n = 0;
+  for(size_t k(0); k<nk; k++) { const size_t koff = dump_offset(k, nzout, g->nz, kstride);
+  for(size_t j(0); j<nj; j++) { const size_t joff = dump_offset(j, nyout, g->ny, jstride);
+  for(size_t i(0); i<ni; i++) { const size_t ioff = dump_offset(i, nxout, g->nx, istride);
+    out[n++] = a[VOXEL(ioff,joff,koff, g->nx,g->ny,g->nz)];
+  }
+  }
+  }
+}
+
+// Device version of gather_band for the float field variables.  Only the
+// output voxels cross to the host, so strided dumps move a fraction of the
+// field array.
+static void
+gather_field_band_kokkos( const k_field_t & k_field, int var, const grid_t * g,
+                          int nxout, int nyout, int nzout,
+                          int istride, int jstride, int kstride,
+                          Kokkos::View<float*> & band_d ) {
+  const int nx = g->nx, ny = g->ny, nz = g->nz;
+  const int ni = nxout+2, nj = nyout+2;
+  Kokkos::parallel_for("field_dump: gather band", Kokkos::RangePolicy<>(0, band_d.extent(0)),
+    KOKKOS_LAMBDA(const int n) {
+      const int i = n%ni, j = (n/ni)%nj, k = n/(ni*nj);
+      const int ioff = (i == 0) ? 0 : (i == nxout+1) ? nx+1 : i*istride;
+      const int joff = (j == 0) ? 0 : (j == nyout+1) ? ny+1 : j*jstride;
+      const int koff = (k == 0) ? 0 : (k == nzout+1) ? nz+1 : k*kstride;
+      band_d(n) = k_field(VOXEL(ioff,joff,koff, nx,ny,nz), var);
+  });
+}
+
 void
 vpic_simulation::field_dump( DumpParameters & dumpParams ) {
 
-    // Update the fields if necessary
-    if (step() > field_array->last_copied)
-      field_array->copy_to_host();
-
   // Create directory for this time step
   char timeDir[max_filename_bytes];
   int ret = snprintf(timeDir, max_filename_bytes, "%s/T.%ld", dumpParams.baseDir, (long)step());
@@ -579,7 +693,7 @@ vpic_simulation::field_dump( DumpParameters & dumpParams ) {
       ERROR(("snprintf failed"));
   }
 
-  FileIO fileIO;
+  DumpStream fileIO( async_writer() );
   FileIOStatus status;
 
   status = fileIO.open(filename, io_write);
@@ -600,9 +714,6 @@ vpic_simulation::field_dump( DumpParameters & dumpParams ) {
 
   int dim[3];
 
-  /* define to do C-style indexing */
-# define f(x,y,z) f[ VOXEL(x,y,z, grid->nx,grid->ny,grid->nz) ]
-
   /* IMPORTANT: these values are written in WRITE_HEADER_V0 */
   nxout = (grid->nx)/istride;
   nyout = (grid->ny)/jstride;
@@ -646,42 +757,43 @@ vpic_simulation::field_dump( DumpParameters & dumpParams ) {
     for(size_t i(0), c(0); i<total_field_variables; i++)
       if(dumpParams.output_vars.bitset(i)) varlist[c++] = i;
 
-    if( rank()==VERBOSE_rank ) printf("\nBEGIN_OUTPUT\n");
+    // The float variables can be gathered straight from the device.  The
+    // material words only exist in the host field_t layout.
+    bool on_device = true;
+    for(size_t v(0); v<numvars; v++)
+      if(varlist[v] >= FIELD_VAR_COUNT) on_device = false;
+
+    const size_t nband = size_t(dim[0])*dim[1]*dim[2];
 
-    // more efficient for standard case
-    if(istride == 1 && jstride == 1 && kstride == 1)
+    if(on_device) {
+      Kokkos::View<float*> band_d("field_dump band", nband);
+      Kokkos::View<float*>::HostMirror band_h = Kokkos::create_mirror_view(band_d);
       for(size_t v(0); v<numvars; v++) {
-      for(size_t k(0); k<nzout+2; k++) {
-      for(size_t j(0); j<nyout+2; j++) {
-      for(size_t i(0); i<nxout+2; i++) {
-              const uint32_t * fref = reinterpret_cast<uint32_t *>(&field_array->f(i,j,k));
-              fileIO.write(&fref[varlist[v]], 1);
-              if(rank()==VERBOSE_rank) printf("%f ", field_array->f(i,j,k).ex);
-              if(rank()==VERBOSE_rank) std::cout << "(" << i << " " << j << " " << k << ")" << std::endl;
-      } if(rank()==VERBOSE_rank) std::cout << std::endl << "ROW_BREAK " << j << " " << k << std::endl;
-      } if(rank()==VERBOSE_rank) std::cout << std::endl << "PLANE_BREAK " << k << std::endl;
-      } if(rank()==VERBOSE_rank) std::cout << std::endl << "BLOCK_BREAK" << std::endl;
+        gather_field_band_kokkos(field_array->k_f_d, varlist[v], grid,
+                                 nxout, nyout, nzout, istride, jstride, kstride, band_d);
+        Kokkos::deep_copy(band_h, band_d);
+        fileIO.write(band_h.data(), nband);
       }
-
-    else
-
+    }
+    else {
+      if (step() > field_array->last_copied)
+        field_array->copy_to_host();
+      uint32_t * band = new uint32_t[nband];
       for(size_t v(0); v<numvars; v++) {
-      for(size_t k(0); k<nzout+2; k++) { const size_t koff = (k == 0) ? 0 : (k == nzout+1) ? grid->nz+1 : k*kstride;
-      for(size_t j(0); j<nyout+2; j++) { const size_t joff = (j == 0) ? 0 : (j == nyout+1) ? grid->ny+1 : j*jstride;
-      for(size_t i(0); i<nxout+2; i++) { const size_t ioff = (i == 0) ? 0 : (i == nxout+1) ? grid->nx+1 : i*istride;
-              const uint32_t * fref = reinterpret_cast<uint32_t *>(&field_array->f(ioff,joff,koff));
-              fileIO.write(&fref[varlist[v]], 1);
-              if(rank()==VERBOSE_rank) printf("%f ", field_array->f(ioff,joff,koff).ex);
-              if(rank()==VERBOSE_rank) std::cout << "(" << ioff << " " << joff << " " << koff << ")" << std::endl;
-      } if(rank()==VERBOSE_rank) std::cout << std::endl << "ROW_BREAK " << joff << " " << koff << std::endl;
-      } if(rank()==VERBOSE_rank) std::cout << std::endl << "PLANE_BREAK " << koff << std::endl;
-      } if(rank()==VERBOSE_rank) std::cout << std::endl << "BLOCK_BREAK" << std::endl;
+        gather_band(field_array->f, varlist[v], grid,
+                    nxout, nyout, nzout, istride, jstride, kstride, band);
+        fileIO.write(band, nband);
       }
+      delete[] band;
+    }
 
     delete[] varlist;
 
   } else { // band_interleave
 
+    if (step() > field_array->last_copied)
+      field_array->copy_to_host();
+
     WRITE_HEADER_V0(dump_type::field_dump, -1, 0, fileIO);
 
     dim[0] = nxout+2;
@@ -692,24 +804,48 @@ vpic_simulation::field_dump( DumpParameters & dumpParams ) {
 
     if(istride == 1 && jstride == 1 && kstride == 1)
       fileIO.write(field_array->f, dim[0]*dim[1]*dim[2]);
-    else
-      for(size_t k(0); k<nzout+2; k++) { const size_t koff = (k == 0) ? 0 : (k == nzout+1) ? grid->nz+1 : k*kstride;
-      for(size_t j(0); j<nyout+2; j++) { const size_t joff = (j == 0) ? 0 : (j == nyout+1) ? grid->ny+1 : j*jstride;
-      for(size_t i(0); i<nxout+2; i++) { const size_t ioff = (i == 0) ? 0 : (i == nxout+1) ? grid->nx+1 : i*istride;
-            fileIO.write(&field_array->f(ioff,joff,koff), 1);
-      }
-      }
-      }
+    else {
+      field_t * buf = new field_t[size_t(dim[0])*dim[1]*dim[2]];
+      gather_strided(field_array->f, grid, nxout, nyout, nzout,
+                     dim[0], dim[1], dim[2], istride, jstride, kstride, buf);
+      fileIO.write(buf, size_t(dim[0])*dim[1]*dim[2]);
+      delete[] buf;
+    }
   }
 
-# undef f
-
   if( fileIO.close() ) ERROR(( "File close failed on field dump!!!" ));
 }
 
+void
+vpic_simulation::load_hydro( species_t ** sp,
+                             int n_species ) {
+  Kokkos::deep_copy(hydro_array->k_h_d, 0.0f);
+  refresh_interpolator_array( interpolator_array );
+  if( kokkos_sorted_hydro ) {
+    accumulate_hydro_p_kokkos_sorted( hydro_array->k_h_d, sp, n_species,
+                                      interpolator_array->k_i_d );
+  } else {
+    for( int s=0; s<n_species; s++ )
+      accumulate_hydro_p_kokkos( sp[s]->k_p_d, sp[s]->k_p_i_d, hydro_array->k_h_d,
+                                 interpolator_array->k_i_d, sp[s] );
+  }
+
+  // Only the synchronized moments leave the device
+  synchronize_hydro_array_kokkos( hydro_array );
+
+  hydro_array->copy_to_host();
+}
+
 void
 vpic_simulation::hydro_dump( const char * speciesname,
                              DumpParameters & dumpParams ) {
+  hydro_dump( &speciesname, 1, dumpParams );
+}
+
+void
+vpic_simulation::hydro_dump( const char * const * speciesnames,
+                             int n_species,
+                             DumpParameters & dumpParams ) {
 
   // Create directory for this time step
   char timeDir[max_filename_bytes];
@@ -724,34 +860,21 @@ vpic_simulation::hydro_dump( const char * speciesname,
       ERROR(("snprintf failed"));
   }
 
-  FileIO fileIO;
+  DumpStream fileIO( async_writer() );
   FileIOStatus status;
 
   status = fileIO.open(filename, io_write);
   if(status == fail) ERROR(("Failed opening file: %s", filename));
 
-  species_t * sp = find_species_name(speciesname, species_list);
-  if( !sp ) ERROR(( "Invalid species name: %s", speciesname ));
-
-  auto& particles = sp->k_p_d;
-  auto& particles_i = sp->k_p_i_d;
-  auto& interpolators_k = interpolator_array->k_i_d;
-
-  Kokkos::deep_copy(hydro_array->k_h_d, 0.0f);
-  accumulate_hydro_p_kokkos(
-      particles,
-      particles_i,
-      hydro_array->k_h_d,
-      interpolators_k,
-      sp
-  );
-
-  // The legacy synchronize is actually a bit faster
-  //synchronize_hydro_array_kokkos(hydro_array);
-
-  hydro_array->copy_to_host();
+  if( n_species<1 || !speciesnames ) ERROR(( "No species to dump" ));
+  std::vector<species_t *> sps( n_species );
+  for( int s=0; s<n_species; s++ ) {
+    sps[s] = find_species_name(speciesnames[s], species_list);
+    if( !sps[s] ) ERROR(( "Invalid species name: %s", speciesnames[s] ));
+  }
+  species_t * sp = sps[0];
 
-  synchronize_hydro_array( hydro_array );
+  load_hydro( sps.data(), n_species );
 
   // convenience
   const size_t istride(dumpParams.stride_x);
@@ -768,9 +891,6 @@ vpic_simulation::hydro_dump( const char * speciesname,
 
   int dim[3];
 
-  /* define to do C-style indexing */
-# define hydro(x,y,z) hydro_array->h[VOXEL(x,y,z, grid->nx,grid->ny,grid->nz)]
-
   /* IMPORTANT: these values are written in WRITE_HEADER_V0 */
   nxout = (grid->nx)/istride;
   nyout = (grid->ny)/jstride;
@@ -806,28 +926,15 @@ vpic_simulation::hydro_dump( const char * speciesname,
     for(size_t i(0), c(0); i<total_hydro_variables; i++)
       if( dumpParams.output_vars.bitset(i) ) varlist[c++] = i;
 
-    // More efficient for standard case
-    if(istride == 1 && jstride == 1 && kstride == 1)
-
-      for(size_t v(0); v<numvars; v++)
-      for(size_t k(0); k<nzout+2; k++)
-      for(size_t j(0); j<nyout+2; j++)
-      for(size_t i(0); i<nxout+2; i++) {
-              const uint32_t * href = reinterpret_cast<uint32_t *>(&hydro(i,j,k));
-              fileIO.write(&href[varlist[v]], 1);
-      }
-
-    else
-
-      for(size_t v(0); v<numvars; v++)
-      for(size_t k(0); k<nzout+2; k++) { const size_t koff = (k == 0) ? 0 : (k == nzout+1) ? grid->nz+1 : k*kstride;
-      for(size_t j(0); j<nyout+2; j++) { const size_t joff = (j == 0) ? 0 : (j == nyout+1) ? grid->ny+1 : j*jstride;
-      for(size_t i(0); i<nxout+2; i++) { const size_t ioff = (i == 0) ? 0 : (i == nxout+1) ? grid->nx+1 : i*istride;
-              const uint32_t * href = reinterpret_cast<uint32_t *>(&hydro(ioff,joff,koff));
-              fileIO.write(&href[varlist[v]], 1);
-      }
-      }
-      }
+    // Stage one band at a time and write it in one call
+    const size_t nband = size_t(dim[0])*dim[1]*dim[2];
+    uint32_t * band = new uint32_t[nband];
+    for(size_t v(0); v<numvars; v++) {
+      gather_band(hydro_array->h, varlist[v], grid,
+                  nxout, nyout, nzout, istride, jstride, kstride, band);
+      fileIO.write(band, nband);
+    }
+    delete[] band;
 
     delete[] varlist;
 
@@ -845,18 +952,14 @@ vpic_simulation::hydro_dump( const char * speciesname,
 
       fileIO.write(hydro_array->h, dim[0]*dim[1]*dim[2]);
 
-    else
-
-      for(size_t k(0); k<nzout; k++) { const size_t koff = (k == 0) ? 0 : (k == nzout+1) ? grid->nz+1 : k*kstride;
-      for(size_t j(0); j<nyout; j++) { const size_t joff = (j == 0) ? 0 : (j == nyout+1) ? grid->ny+1 : j*jstride;
-      for(size_t i(0); i<nxout; i++) { const size_t ioff = (i == 0) ? 0 : (i == nxout+1) ? grid->nx+1 : i*istride;
-            fileIO.write(&hydro(ioff,joff,koff), 1);
-      }
-      }
-      }
+    else {
+      hydro_t * buf = new hydro_t[size_t(dim[0])*dim[1]*dim[2]];
+      gather_strided(hydro_array->h, grid, nxout, nyout, nzout,
+                     dim[0], dim[1], dim[2], istride, jstride, kstride, buf);
+      fileIO.write(buf, size_t(dim[0])*dim[1]*dim[2]);
+      delete[] buf;
+    }
   }
 
-# undef hydro
-
   if( fileIO.close() ) ERROR(( "File close failed on hydro dump!!!" ));
 }
@@ -1,4 +1,5 @@
 #include "vpic.h"
+#include "../particle_operations/sort.h"
 
 #define FAK field_array->kernel
 
@@ -79,7 +80,9 @@ vpic_simulation::initialize( int argc,
     KOKKOS_TOCN( FIELD_DATA_MOVEMENT, 1);
 
     if( rank()==0 ) MESSAGE(( "Uncentering particles" ));
-    TIC load_interpolator_array( interpolator_array, field_array ); TOC( load_interpolator, 1 );
+    KOKKOS_TIC();
+    load_interpolator_array( interpolator_array, field_array );
+    KOKKOS_TOC( load_interpolator, 1 );
   }
   LIST_FOR_EACH( sp, species_list ) {
       KOKKOS_TIC();
@@ -87,6 +90,20 @@ vpic_simulation::initialize( int argc,
       KOKKOS_TOC( uncenter_p, 1 );
   }
 
+  // From here on the push interpolates the fields itself if asked to
+  if( interpolate_on_the_fly )
+    set_interpolator_array_on_the_fly( interpolator_array, 1 );
+
+  // Size the workspace for the advance loop so the temporaries of the
+  // sorts and the particle push are not allocated every step
+  ParticleSorter<> sorter;
+  LIST_FOR_EACH( sp, species_list )
+    if( sp->sort_interval>0 ) sorter.reserve( sp, grid->nv );
+# if defined( VPIC_ENABLE_ACCUMULATORS ) && !defined( USE_GPU )
+  workspace_reserve( workspace_accumulator,
+                     k_current_accumulator_t::required_allocation_size( field_array->k_f_d.extent(0) ) );
+# endif
+
   if( rank()==0 ) MESSAGE(( "Performing initial diagnostics" ));
 
   // Let the user to perform diagnostics on the initial condition
@@ -95,12 +112,16 @@ vpic_simulation::initialize( int argc,
 
   if( rank()==0 ) MESSAGE(( "Initialization complete" ));
   update_profile( rank()==0 ); // Let the user know how initialization went
+  workspace_report( rank()==0 );
 }
 
 
 void
 vpic_simulation::finalize( void ) {
+  if( dump_writer ) dump_writer->flush();
+  if( checkpt_writer ) checkpt_writer->flush();
   barrier();
   //Kokkos::finalize();
   update_profile( rank()==0 );
+  workspace_report( rank()==0 );
 }
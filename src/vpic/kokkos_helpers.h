@@ -30,6 +30,16 @@
   #define KOKKOS_LAYOUT Kokkos::LayoutRight
 #endif
 
+// Particle storage layout (see VPIC_PARTICLE_LAYOUT).  SoA keeps each
+// particle variable contiguous, which coalesces on GPUs.  AoS keeps the
+// variables of a particle together, so moving, sorting or exchanging one
+// touches one or two cache lines instead of PARTICLE_VAR_COUNT of them.
+#if defined(VPIC_PARTICLE_LAYOUT_AOS)
+  #define KOKKOS_PARTICLE_LAYOUT Kokkos::LayoutRight
+#else
+  #define KOKKOS_PARTICLE_LAYOUT Kokkos::LayoutLeft
+#endif
+
 typedef int16_t material_id;
 
 // TODO: we dont need the [1] here
@@ -45,7 +55,12 @@ using k_field_accum_t = Kokkos::View<float *>;
 
 using k_jf_accum_t = Kokkos::View<float *[NUM_J_DIMS]>;
 
-using k_particles_t = Kokkos::View<float *[PARTICLE_VAR_COUNT], Kokkos::LayoutLeft>;
+template<class Layout>
+using k_particles_view_t = Kokkos::View<float *[PARTICLE_VAR_COUNT], Layout>;
+using k_particles_t = k_particles_view_t<KOKKOS_PARTICLE_LAYOUT>;
+// True if each particle variable of k_particles_t is contiguous
+constexpr bool k_particles_soa =
+  std::is_same<Kokkos::LayoutLeft, k_particles_t::array_layout>::value;
 using k_particles_i_t = Kokkos::View<int*>;
 
 // TODO: think about the layout here
@@ -61,16 +61,44 @@
   #endif
 #endif
 
-// Sorting
-#if defined(KOKKOS_ENABLE_CUDA) || defined(KOKKOS_ENABLE_HIP)
+// Sorting. These are only the defaults for species that do not pick a
+// strategy in the deck, see sort_strategy in species_advance.h
+#if defined(VPIC_ENABLE_INCREMENTAL_SORT)
+  #define SORT_STRATEGY sort_strategy::incremental
+#elif defined(KOKKOS_ENABLE_CUDA) || defined(KOKKOS_ENABLE_HIP)
   // Check if using team reduction optimization
   #if defined(VPIC_ENABLE_TEAM_REDUCTION) || defined(VPIC_ENABLE_HIERARCHICAL)
-    #define SORT standard_sort
+    #define SORT_STRATEGY sort_strategy::standard
   #else
-    #define SORT strided_sort
+    #define SORT_STRATEGY sort_strategy::strided
   #endif
 #else
-  #define SORT standard_sort
+  #define SORT_STRATEGY sort_strategy::standard
+#endif
+
+// Cells per tile for the tiled sorts
+#ifndef SORT_TILE_SIZE
+  #define SORT_TILE_SIZE 32
+#endif
+
+// Voxels per team for the tiled particle push
+#ifndef ADVANCE_P_TILE_SIZE
+  #define ADVANCE_P_TILE_SIZE 32
+#endif
+
+// Spare slots per voxel in the cell table of the incremental sort: one per
+// SORT_SLACK_DIVISOR particles in the voxel plus SORT_SLACK_MIN. The table
+// is only rebuilt (and the particles reordered) once a voxel runs out.
+#ifndef SORT_SLACK_DIVISOR
+  #define SORT_SLACK_DIVISOR 4
+#endif
+#ifndef SORT_SLACK_MIN
+  #define SORT_SLACK_MIN 4
+#endif
+
+// Sort intervals each strategy is timed for by sort_strategy::automatic
+#ifndef SORT_AUTO_TRIALS
+  #define SORT_AUTO_TRIALS 2
 #endif
 
 #endif // _kokkos_tuning_h_
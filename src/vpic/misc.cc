@@ -97,6 +97,126 @@ vpic_simulation::inject_particle( species_t * sp,
   }
 
 }
+
+// Batched injection straight into the device particle arrays. The n new
+// particles are appended at np. Aged particles (non-zero displacement) are
+// moved with move_p_kokkos; the ones that reach a boundary are added to the
+// movers exactly as advance_p would have, so they go through the regular
+// boundary exchange and compress of this step. If the movers are full, the
+// particle is left where it is (like the host injection, with a warning).
+// The current goes through the field array's persistent scatter view, so
+// the cost is O(n) and no other particle is touched.
+
+void
+vpic_simulation::inject_particles( species_t * sp,
+                                   const k_particle_injectors_t & pi,
+                                   int n,
+                                   int update_rhob ) {
+  if( !sp ) ERROR(( "Invalid species" ));
+  if( n<=0 ) return;
+  if( n>(int)pi.extent(0) ) ERROR(( "Injection buffer holds fewer than %i particles", n ));
+  if( sp->np+n>sp->max_np )
+    ERROR(( "No room to inject %i particles in species \"%s\"", n, sp->name ));
+
+  grid_t * g = grid;
+  const int np = sp->np;
+  const int max_nm = sp->max_nm;
+  const float qsp = sp->q;
+  const float q_8V = -qsp*g->r8V;
+  const int64_t rangel = g->rangel;
+  const int64_t rangeh = g->rangeh;
+  const int nx = g->nx, ny = g->ny, nz = g->nz;
+  const int sy = g->sy, sz = g->sz;
+  const float cx = 0.25 * g->rdy * g->rdz / g->dt;
+  const float cy = 0.25 * g->rdz * g->rdx / g->dt;
+  const float cz = 0.25 * g->rdx * g->rdy / g->dt;
+
+  // Avoid capturing sp
+  const auto& k_neighbor = g->k_neighbor_d;
+  k_field_t k_field = field_array->k_f_d;
+  auto& k_particles = sp->k_p_d;
+  auto& k_particles_i = sp->k_p_i_d;
+  auto& movers = sp->k_pm_d;
+  auto& movers_i = sp->k_pm_i_d;
+  auto& particle_copy = sp->k_pc_d;
+  auto& particle_copy_i = sp->k_pc_i_d;
+  auto& k_nm = sp->k_nm_d;
+
+  k_field_sa_t k_f_sv = field_array->k_field_sa_d;
+
+  int nm_skipped = 0;
+  Kokkos::parallel_reduce( "inject_particles", Kokkos::RangePolicy<>(0, n),
+  KOKKOS_LAMBDA( const int k, int & skipped ) {
+    const particle_injector_t& p = pi(k);
+    const int slot = np + k;
+    k_particles(slot, particle_var::dx) = p.dx;
+    k_particles(slot, particle_var::dy) = p.dy;
+    k_particles(slot, particle_var::dz) = p.dz;
+    k_particles(slot, particle_var::ux) = p.ux;
+    k_particles(slot, particle_var::uy) = p.uy;
+    k_particles(slot, particle_var::uz) = p.uz;
+    k_particles(slot, particle_var::w)  = p.w;
+    k_particles_i(slot) = p.i;
+
+    if( update_rhob )
+      k_accumulate_rhob_single( k_field, k_particles, k_particles_i, slot,
+                                q_8V, nx, ny, nz, sy, sz );
+
+    if( p.dispx==0 && p.dispy==0 && p.dispz==0 ) return;
+    if( Kokkos::atomic_load( &k_nm(0) )>=max_nm ) { skipped++; return; }
+
+    DECLARE_ALIGNED_ARRAY( particle_mover_t, 16, local_pm, 1 );
+    local_pm->dispx = p.dispx;
+    local_pm->dispy = p.dispy;
+    local_pm->dispz = p.dispz;
+    local_pm->i     = slot;
+
+    if( move_p_kokkos( k_particles, k_particles_i, local_pm, k_f_sv, g,
+                       k_neighbor, rangel, rangeh, qsp, cx, cy, cz,
+                       nx, ny, nz ) ) {
+      // Another particle may have taken the last mover since the check
+      const int nm = Kokkos::atomic_fetch_add( &k_nm(0), 1 );
+      if( nm >= max_nm ) { skipped++; return; }
+      movers(nm, particle_mover_var::dispx) = local_pm->dispx;
+      movers(nm, particle_mover_var::dispy) = local_pm->dispy;
+      movers(nm, particle_mover_var::dispz) = local_pm->dispz;
+      movers_i(nm) = slot;
+      for( int v=0; v<PARTICLE_VAR_COUNT; v++ )
+        particle_copy(nm, v) = k_particles(slot, v);
+      particle_copy_i(nm) = k_particles_i(slot);
+    }
+  }, nm_skipped );
+
+  Kokkos::Experimental::contribute( k_field, k_f_sv );
+  k_f_sv.reset_except( k_field );
+
+  sp->np += n;
+  sp->invalidate_partition();
+  Kokkos::deep_copy( sp->k_nm_h, sp->k_nm_d );
+  if( sp->k_nm_h(0)>max_nm ) {
+    sp->k_nm_h(0) = max_nm;
+    Kokkos::deep_copy( sp->k_nm_d, sp->k_nm_h );
+  }
+  sp->nm = sp->k_nm_h(0);
+  if( nm_skipped ) WARNING(( "Insufficient local particle mover storage.  Did not "
+                             "(finish) aging %i injected particles", nm_skipped ));
+}
+
+void
+vpic_simulation::inject_particles( species_t * sp,
+                                   const particle_injector_t * pi,
+                                   int n,
+                                   int update_rhob ) {
+  if( !sp || ( n>0 && !pi ) ) ERROR(( "Bad args" ));
+  if( n<=0 ) return;
+  sp->resize_injection( n );
+  auto span = std::make_pair( 0, n );
+  auto staged_h = Kokkos::subview( sp->k_inject_h, span );
+  auto staged_d = Kokkos::subview( sp->k_inject_d, span );
+  for( int k=0; k<n; k++ ) staged_h(k) = pi[k];
+  Kokkos::deep_copy( staged_d, staged_h );
+  inject_particles( sp, sp->k_inject_d, n, update_rhob );
+}
  
 // Add capability to modify certain fields "on the fly" so that one
 // can, e.g., extend a run, change a quota, or modify a dump interval
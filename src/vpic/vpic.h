@@ -21,9 +21,12 @@
 #include "../emitter/emitter.h"
 // FIXME: INCLUDES ONCE ALL IS CLEANED UP
 #include "../util/io/FileIO.h"
+#include "../util/io/DumpWriter.h"
 #include "../util/bitfield.h"
 #include "../util/checksum.h"
 #include "../util/system.h"
+#include "kokkos_tuning.hpp"
+#include "workspace.h"
 
 #ifndef USER_GLOBAL_SIZE
 #define USER_GLOBAL_SIZE 16384
@@ -146,6 +149,47 @@ public:
   bool kokkos_field_injection = false;
   bool kokkos_current_injection = false;
   bool kokkos_particle_injection = false;
+  // Voxels and components written by host field / current injection
+  // (see define_field_injection_region); empty means everything
+  field_region_t field_injection_region = { 0, 0, 0, 0, 0, 0, 0 };
+  field_region_t current_injection_region = { 0, 0, 0, 0, 0, 0, 0 };
+  // Process particle boundaries and exchange movers without leaving the
+  // device (boundary_p_kokkos_device)
+  bool kokkos_boundary_p = false;
+  // Accumulate hydro dumps per voxel in team scratch on partitioned
+  // particles (accumulate_hydro_p_kokkos_sorted) instead of through a
+  // ScatterView. Partitioning may reorder the particles.
+  bool kokkos_sorted_hydro = false;
+  // Deposit rho_p for divergence cleaning for all species in one pass on
+  // partitioned particles (k_accumulate_rho_p_sorted), optionally without
+  // atomics so the result is reproducible. Partitioning may reorder the
+  // particles.
+  bool kokkos_sorted_rho_p = false;
+  bool deterministic_rho_p = false;
+  // Compute the interpolation coefficients from the fields inside the
+  // particle push instead of loading the interpolator array every step.
+  // Saves the interpolator traffic and memory at low particles per cell;
+  // the array is only loaded for the other users of it (diagnostics,
+  // emitters, centering).
+  bool interpolate_on_the_fly = false;
+  // Push the particles a tile of voxels per team with the interpolators
+  // and current of the tile staged in team scratch (advance_p_kokkos_tiled)
+  // instead of gathering per particle. This costs an incremental sort
+  // (ParticleSorter::partition) of every species every step, which is
+  // counted in the advance_p timer; partitioning may reorder the
+  // particles.
+  bool kokkos_tiled_advance_p = false;
+  // Hand binary dumps to a background writer thread once they are staged
+  // in host memory instead of writing them inside user_diagnostics
+  bool async_dump = false;
+  // Serialize checkpts to host memory and write them from a background
+  // thread while the step loop continues (a checkpt waits for the write
+  // of the previous one). With checkpt_full_interval>1 only every nth
+  // checkpt is full; the others only store the sections (particles,
+  // fields, ...) that changed since the last full one and need it to
+  // restore.
+  bool async_checkpt = false;
+  int checkpt_full_interval = 1;
 
   // FIXME: THESE INTERVALS SHOULDN'T BE PART OF vpic_simulation
   // THE BIG LIST FOLLOWING IT SHOULD BE CLEANED UP TOO
@@ -201,6 +245,10 @@ public:
   emitter_t            * emitter_list;       // define_emitter /
                                              // emitter helpers
   collision_op_t       * collision_op_list;  // collision helpers
+  DumpWriter           * dump_writer;        // async_writer (not checkpointed)
+  DumpWriter           * checkpt_writer;     // async_checkpt (not checkpointed)
+  int                    n_checkpt;          // Checkpts made in this run
+                                             // (not checkpointed)
 
   // User defined checkpt preserved variables
   // Note: user_global is aliased with user_global_t (see deck_wrapper.cxx)
@@ -230,6 +278,8 @@ public:
   // Dump helpers
 
   int dump_mkdir(const char * dname);
+  DumpWriter * async_writer();
+  void checkpt_objects( const char * fname );
   int dump_cwd(char * dname, size_t size);
 
   // Text dumps
@@ -245,6 +295,10 @@ public:
   void dump_particles( const char *sp_name, const char *fbase,
                        int fname_tag = 1 );
 
+  // Zeroes the hydro array, adds the moments of the given species and
+  // brings the result to the host
+  void load_hydro( species_t ** sp, int n_species );
+
   // convenience functions for simlog output
   void create_field_list(char * strlist, DumpParameters & dumpParams);
   void create_hydro_list(char * strlist, DumpParameters & dumpParams);
@@ -259,6 +313,10 @@ public:
 
   void field_dump(DumpParameters & dumpParams);
   void hydro_dump(const char * speciesname, DumpParameters & dumpParams);
+  // Dumps the summed moments of several species (e.g. all the electron
+  // populations) with the header of the first one
+  void hydro_dump(const char * const * speciesnames, int n_species,
+                  DumpParameters & dumpParams);
 
   ///////////////////
   // Useful accessors
@@ -498,6 +556,29 @@ public:
     mp_size_send_buffer(grid->mp,BOUNDARY( 0, 0, 1),nx1*ny1*sizeof(hydro_t));
   }
 
+  // Decks whose user_field_injection / user_current_injection run on the
+  // host (kokkos_field_injection / kokkos_current_injection false) can
+  // declare the voxels (inclusive, VOXEL indexing) and field_var
+  // components they read and write, e.g. a laser on the x=0 plane:
+  //   define_field_injection_region( 1, 1, 1, grid->ny+1, 1, grid->nz+1,
+  //     (1<<field_var::ey) | (1<<field_var::ez) );
+  // Only that slab is then copied around the injection instead of the
+  // whole field array.  Everything else on the host is stale there.
+
+  inline void
+  define_field_injection_region( int il, int ih, int jl, int jh,
+                                 int kl, int kh, int vars ) {
+    field_region_t r = { il, ih, jl, jh, kl, kh, vars };
+    field_injection_region = r;
+  }
+
+  inline void
+  define_current_injection_region( int il, int ih, int jl, int jh,
+                                   int kl, int kh, int vars ) {
+    field_region_t r = { il, ih, jl, jh, kl, kh, vars };
+    current_injection_region = r;
+  }
+
   // Other field helpers are provided by macros in deck_wrapper.cxx
 
   //////////////////
@@ -511,7 +592,9 @@ public:
                   double max_local_np,
                   double max_local_nm,
                   double sort_interval,
-                  double sort_out_of_place ) {
+                  double sort_out_of_place,
+                  int sort_method = SORT_STRATEGY,
+                  int sort_tile_size = SORT_TILE_SIZE ) {
     // Compute a reasonble number of movers if user did not specify
     // Based on the twice the number of particles expected to hit the boundary
     // of a wpdt=0.2 / dx=lambda species in a 3x3x3 domain
@@ -520,10 +603,18 @@ public:
       if( max_local_nm<16*(MAX_PIPELINE+1) )
         max_local_nm = 16*(MAX_PIPELINE+1);
     }
-    return append_species( species( name, (float)q, (float)m,
-                                    (int)max_local_np, (int)max_local_nm,
-                                    (int)sort_interval, (int)sort_out_of_place,
-                                    grid ), &species_list );
+    if( sort_method<sort_strategy::automatic ||
+        sort_method>=sort_strategy::count )
+      ERROR(( "Unknown sort strategy %i for species \"%s\"", sort_method, name ));
+    if( sort_tile_size<1 )
+      ERROR(( "Sort tile size must be positive for species \"%s\"", name ));
+    species_t * sp = species( name, (float)q, (float)m,
+                              (int)max_local_np, (int)max_local_nm,
+                              (int)sort_interval, (int)sort_out_of_place,
+                              grid );
+    sp->sort_method    = sort_method;
+    sp->sort_tile_size = sort_tile_size;
+    return append_species( sp, &species_list );
   }
 
   inline species_t *
@@ -549,6 +640,49 @@ public:
                    double ux, double uy, double uz,
                    double w,  double age = 0, int update_rhob = 1 );
 
+  // Batched injection into the device particle arrays (see misc.cc), for
+  // decks that set kokkos_particle_injection. The new particles are given
+  // in cell coordinates as particle_injector_t (sp_id is ignored). A
+  // non-zero dispx, dispy, dispz ages the particle by that displacement
+  // (in cell units, as with a particle mover); particles that reach a
+  // boundary are handed to this step's boundary exchange. These must be
+  // called from user_particle_injection (after advance_p and before the
+  // boundary exchange).
+
+  void
+  inject_particles( species_t * sp,
+                    const particle_injector_t * pi, int n,
+                    int update_rhob = 1 );
+
+  void
+  inject_particles( species_t * sp,
+                    const k_particle_injectors_t & pi, int n,
+                    int update_rhob = 1 );
+
+  // As above, with the particles made on the device by a functor with
+  //   KOKKOS_INLINE_FUNCTION void
+  //   operator()( const int k, particle_injector_t & p ) const;
+  // that fills in particle k of n.
+
+  template<class generator_t>
+  void
+  inject_particles( species_t * sp, int n,
+                    const generator_t & generator,
+                    int update_rhob = 1 ) {
+    if( !sp ) ERROR(( "Invalid species" ));
+    if( n<=0 ) return;
+    sp->resize_injection( n );
+    k_particle_injectors_t staged = sp->k_inject_d;
+    Kokkos::parallel_for( "inject_particles generate", Kokkos::RangePolicy<>(0, n),
+    KOKKOS_LAMBDA( const int k ) {
+      particle_injector_t p;
+      p.dispx = p.dispy = p.dispz = 0;
+      generator( k, p );
+      staged(k) = p;
+    });
+    inject_particles( sp, staged, n, update_rhob );
+  }
+
   // Inject particle raw is for power users!
   // No nannyism _at_ _all_:
   // - Availability of free stoarge is _not_ checked.
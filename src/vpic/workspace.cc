@@ -0,0 +1,86 @@
+#include "workspace.h"
+
+// Slots are held by pointer so nothing Kokkos owned outlives
+// workspace_release (and so Kokkos::finalize)
+
+static const char * workspace_slot_name[ workspace_n_slot ] = {
+  "accumulator", "sort keys", "sort counter", "rho node sum"
+};
+
+static Kokkos::View<char*> * workspace_slot[ workspace_n_slot ] = { NULL, NULL, NULL, NULL };
+static int workspace_n_grow[ workspace_n_slot ] = { 0, 0, 0, 0 };
+
+static k_current_accumulator_sa_t * workspace_accumulator_sa = NULL;
+static const float * workspace_accumulator_data = NULL;
+static size_t workspace_accumulator_nv = 0;
+
+char *
+workspace_storage( int slot,
+                   size_t n_byte ) {
+  if( slot<0 || slot>=workspace_n_slot ) ERROR(( "Bad workspace slot %i", slot ));
+
+  Kokkos::View<char*> * & s = workspace_slot[ slot ];
+  if( !s ) s = new Kokkos::View<char*>();
+  if( s->extent(0)<n_byte ) {
+    // Drop the old buffer first so both are never held at once
+    *s = Kokkos::View<char*>();
+    *s = Kokkos::View<char*>( Kokkos::view_alloc( std::string( "workspace " ) +
+                                                  workspace_slot_name[ slot ],
+                                                  Kokkos::WithoutInitializing ),
+                              n_byte );
+    workspace_n_grow[ slot ]++;
+  }
+  return s->data();
+}
+
+void
+workspace_accumulator( size_t nv,
+                       k_current_accumulator_t & accumulator,
+                       k_current_accumulator_sa_t & accumulator_sa ) {
+  accumulator = workspace_view<float *[12]>( workspace_accumulator, nv );
+  if( !workspace_accumulator_sa ||
+      workspace_accumulator_data!=accumulator.data() ||
+      workspace_accumulator_nv!=nv ) {
+    delete workspace_accumulator_sa;
+    workspace_accumulator_sa = new k_current_accumulator_sa_t(
+      Kokkos::Experimental::create_scatter_view( accumulator ) );
+    workspace_accumulator_data = accumulator.data();
+    workspace_accumulator_nv = nv;
+  }
+  accumulator_sa = *workspace_accumulator_sa;
+}
+
+size_t
+workspace_bytes( void ) {
+  size_t n_byte = 0;
+  for( int slot=0; slot<workspace_n_slot; slot++ )
+    if( workspace_slot[ slot ] ) n_byte += workspace_slot[ slot ]->extent(0);
+  return n_byte;
+}
+
+void
+workspace_report( int dump ) {
+  if( dump ) {
+    log_printf( "    Workspace              |   Bytes    Grows\n"
+                "---------------------------+------------------\n" );
+    for( int slot=0; slot<workspace_n_slot; slot++ )
+      log_printf( "%26.26s | %.3e %i\n", workspace_slot_name[ slot ],
+                  workspace_slot[ slot ] ? (double)workspace_slot[ slot ]->extent(0) : 0.,
+                  workspace_n_grow[ slot ] );
+    log_printf( "%26.26s | %.3e\n\n", "total", (double)workspace_bytes() );
+  }
+  for( int slot=0; slot<workspace_n_slot; slot++ ) workspace_n_grow[ slot ] = 0;
+}
+
+void
+workspace_release( void ) {
+  delete workspace_accumulator_sa;
+  workspace_accumulator_sa = NULL;
+  workspace_accumulator_data = NULL;
+  workspace_accumulator_nv = 0;
+  for( int slot=0; slot<workspace_n_slot; slot++ ) {
+    delete workspace_slot[ slot ];
+    workspace_slot[ slot ] = NULL;
+    workspace_n_grow[ slot ] = 0;
+  }
+}
@@ -0,0 +1,76 @@
+#ifndef _workspace_h_
+#define _workspace_h_
+
+#include "kokkos_helpers.h"
+
+// Persistent device scratch for per-step Kokkos temporaries.
+//
+// Hot paths that need a temporary view every call (sort keys, current
+// accumulators, ...) borrow it from a slot of this arena instead of
+// allocating it.  Each slot is a raw device buffer that only grows, so
+// after the first few steps (or after workspace_reserve, which the
+// simulation calls once initialization is done) borrowing is free.  A
+// borrowed view is unmanaged and is only valid until the same slot is
+// borrowed again or the workspace is released, so routines must not hold
+// on to it across calls or borrow the same slot twice.
+//
+// The arena is released by the simulation before Kokkos is finalized.
+
+enum workspace_slot {
+  workspace_accumulator = 0,  // advance_p current accumulators
+  workspace_sort_keys,        // Per particle sort keys
+  workspace_sort_counter,     // Per bin sort counters
+  workspace_rho_node_sum,     // Per voxel node sums of the deterministic rho_p
+  workspace_n_slot
+};
+
+// Current accumulators (see VPIC_ENABLE_ACCUMULATORS) and their
+// scatter view, which is kept alongside the slot storage
+using k_current_accumulator_t = Kokkos::View<float *[12], Kokkos::MemoryUnmanaged>;
+using k_current_accumulator_sa_t = Kokkos::Experimental::ScatterView<float *[12]>;
+
+// Make sure a slot holds at least n_byte bytes and return its storage
+char *
+workspace_storage( int slot,
+                   size_t n_byte );
+
+// Grow a slot ahead of time so it is not grown in the advance loop
+inline void
+workspace_reserve( int slot,
+                   size_t n_byte ) {
+  workspace_storage( slot, n_byte );
+}
+
+// Borrow a slot as a view with n0 rows of data type T, e.g.
+// workspace_view<int*>( workspace_sort_keys, np ).  The contents are
+// left from the previous borrower.
+template<class T>
+Kokkos::View<T, Kokkos::MemoryUnmanaged>
+workspace_view( int slot,
+                size_t n0 ) {
+  typedef Kokkos::View<T, Kokkos::MemoryUnmanaged> view_t;
+  const size_t n_byte = view_t::required_allocation_size( n0 );
+  return view_t( (typename view_t::pointer_type)workspace_storage( slot, n_byte ), n0 );
+}
+
+// Borrow nv accumulators with their scatter view.  The scatter view is
+// only rebuilt when the accumulator slot moves.
+void
+workspace_accumulator( size_t nv,
+                       k_current_accumulator_t & accumulator,
+                       k_current_accumulator_sa_t & accumulator_sa );
+
+// Bytes held by the arena
+size_t
+workspace_bytes( void );
+
+// Log the size of each slot and how often the arena grew since the last
+// report (with the profile, if dump is set)
+void
+workspace_report( int dump );
+
+// Free all slots
+void
+workspace_release( void );
+
+#endif // _workspace_h_
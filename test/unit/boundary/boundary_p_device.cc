@@ -0,0 +1,186 @@
+// Compares the device particle boundary exchange (boundary_p_kokkos_device)
+// against the host one (boundary_p_kokkos). Run on two ranks so that
+// particles actually cross between domains. Each rank pushes the same
+// particles once with each exchange and must end up with the same
+// particles, current and bound charge.
+
+#define CATCH_CONFIG_MAIN  // This tells Catch to provide a main()
+#include "catch.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include "src/species_advance/species_advance.h"
+#include "src/particle_operations/compress.h"
+#include "src/vpic/vpic.h"
+
+typedef std::array<float, PARTICLE_VAR_COUNT+1> particle_record_t;
+
+// The particles of sp in a canonical order
+static std::vector<particle_record_t>
+particle_set( species_t * sp ) {
+  Kokkos::deep_copy( sp->k_p_h, sp->k_p_d );
+  Kokkos::deep_copy( sp->k_p_i_h, sp->k_p_i_d );
+  std::vector<particle_record_t> set( sp->np );
+  for( int i=0; i<sp->np; i++ ) {
+    set[i][0] = (float)sp->k_p_i_h(i);
+    for( int v=0; v<PARTICLE_VAR_COUNT; v++ ) set[i][v+1] = sp->k_p_h(i, v);
+  }
+  std::sort( set.begin(), set.end() );
+  return set;
+}
+
+void vpic_simulation::user_diagnostics() {}
+
+void
+vpic_simulation::user_initialization( int num_cmdline_arguments,
+                                      char ** cmdline_argument )
+{
+    double L  = 8;
+    int npart = 16384;
+    int nstep = 4;
+
+    define_units( 1, 1 );
+    define_timestep( 0.5 );
+    define_periodic_grid( 0, 0, 0,     // Grid low corner
+                          L, L/2, L/2, // Grid high corner
+                          8, 4, 4,     // Grid resolution
+                          2, 1, 1 );   // Processor configuration
+    define_material( "vacuum", 1.0, 1.0, 0.0 );
+    define_field_array();
+
+    species_t * sp = define_species( "test_species", 1., 1., npart, npart, 0, 0 );
+
+    for (int i = 0; i < npart; i++)
+    {
+        float x = uniform( rng(0), 0, L);
+        float y = uniform( rng(0), 0, L/2);
+        float z = uniform( rng(0), 0, L/2);
+        float ux = uniform( rng(0), -1, 1);
+        float uy = uniform( rng(0), -1, 1);
+        float uz = uniform( rng(0), -1, 1);
+
+        // Only the particles in the local domain are kept
+        inject_particle( sp, x, y, z, ux, uy, uz, 1., 0., 0);
+    }
+
+    field_array->copy_to_device();
+    sp->copy_to_device();
+
+    const int np0 = sp->np;
+    k_particles_t p0( "initial particles", sp->k_p_d.extent(0) );
+    k_particles_i_t p0_i( "initial particles i", sp->k_p_i_d.extent(0) );
+    Kokkos::deep_copy( p0, sp->k_p_d );
+    Kokkos::deep_copy( p0_i, sp->k_p_i_d );
+
+    ParticleCompressor<> compressor;
+    int n_moved = 0;
+
+    // nstep steps from the initial particles, exchanging the movers the way
+    // advance() does on the host or on the device. Returns the fields.
+    auto run = [&]( bool device ) {
+      Kokkos::deep_copy( sp->k_p_d, p0 );
+      Kokkos::deep_copy( sp->k_p_i_d, p0_i );
+      sp->np = np0;
+      sp->nm = 0;
+      sp->num_to_copy = 0;
+      sp->invalidate_partition();
+      Kokkos::deep_copy( field_array->k_f_d, 0.f );
+
+      for( int n=0; n<nstep; n++ ) {
+        advance_p( sp, interpolator_array, field_array );
+        if( device ) sp->nm = sp->k_nm_h(0);
+        else         sp->copy_outbound_to_host();
+        n_moved += sp->nm;
+
+        for( int round=0; round<num_comm_round; round++ ) {
+          if( device ) boundary_p_kokkos_device( particle_bc_list, species_list, field_array );
+          else         boundary_p_kokkos( particle_bc_list, species_list, field_array );
+        }
+
+        const int nm = sp->k_nm_h(0);
+        compressor.compress( sp->k_p_d, sp->k_p_i_d, sp->k_pm_i_d, nm, sp->np, sp );
+        sp->np -= nm;
+        if( device ) sp->append_inbound_on_device();
+        else         sp->copy_inbound_to_device();
+        sp->nm = 0;
+
+        field_array->kernel->k_reduce_jf( field_array );
+      }
+
+      return Kokkos::create_mirror_view_and_copy( Kokkos::HostSpace(),
+                                                  field_array->k_f_d );
+    };
+
+    auto f_host = run( false );
+    const std::vector<particle_record_t> p_host = particle_set( sp );
+    auto f_device = run( true );
+    const std::vector<particle_record_t> p_device = particle_set( sp );
+
+    // Make sure particles actually left the domain
+    REQUIRE( n_moved>0 );
+
+    // The received particles finish their move with the host or the device
+    // mover, so allow for rounding
+    float abstol = 1e-6;
+    float reltol = 1e-5;
+    int failed = 0;
+
+    REQUIRE( p_host.size()==p_device.size() );
+    for( size_t n=0; n<p_host.size(); n++ ) {
+      if( p_host[n][0]!=p_device[n][0] ) failed++;
+      for( int v=1; v<=PARTICLE_VAR_COUNT; v++ ) {
+        const float a = p_host[n][v], b = p_device[n][v];
+        if( std::abs(a-b)>abstol && std::abs(a-b)>reltol*std::abs(a) ) failed++;
+      }
+    }
+
+    // The current is summed in a different order, so compare it to the
+    // largest value rather than to each entry
+    const int check[] = { field_var::jfx, field_var::jfy, field_var::jfz,
+                          field_var::rhob };
+    float f_max = 0;
+    for( int i=0; i<grid->nv; i++ )
+      for( int c : check ) f_max = std::max( f_max, std::abs( f_host(i, c) ) );
+    for( int i=0; i<grid->nv; i++ )
+      for( int c : check ) {
+        const float a = f_host(i, c), b = f_device(i, c);
+        if( std::abs(a-b)>reltol*f_max )
+        {
+          std::cout << " Failed at " << i << " component " << c << " with host "
+                    << a << " and device " << b << std::endl;
+          failed++;
+        }
+      }
+
+    if( failed )
+    {  std::cout << "FAIL" << std::endl;
+    }
+    REQUIRE_FALSE(failed);
+
+    std::cout << "pass" << std::endl;
+}
+
+TEST_CASE( "device boundary exchange matches the host one", "[boundary_p]" ) {
+
+    int pargc = 0;
+    char str[] = "bin/vpic";
+    char **pargv = (char **) malloc(sizeof(char **));
+    pargv[0] = str;
+    boot_services( &pargc, &pargv );
+
+    SECTION( "exchange between two ranks" )
+    {
+        vpic_simulation* simulation = new vpic_simulation;
+        simulation->initialize( pargc, pargv );
+
+        simulation->finalize();
+        delete simulation;
+        if( world_rank==0 ) log_printf( "normal exit\n" );
+
+        halt_mp();
+    }
+}
@@ -0,0 +1,127 @@
+// Delta checkpts: a delta written after changing one of two views stores
+// only that view and refers to the full checkpt for the other. Restoring
+// the delta must give the changed view and the unchanged one from the
+// base, and the base must be reported in use while the delta needs it.
+
+#define CATCH_CONFIG_MAIN  // This tells Catch to provide a main()
+#include "catch.hpp"
+
+#include <iostream>
+#include <vector>
+
+#include "src/vpic/vpic.h"
+#include "src/util/checkpt/checkpt_kokkos.h"
+#include "src/util/io/DumpWriter.h"
+
+void vpic_simulation::user_diagnostics() {}
+
+void
+vpic_simulation::user_initialization( int num_cmdline_arguments,
+                                      char ** cmdline_argument ) {}
+
+struct delta_test_t {
+  int n;
+  Kokkos::View<float*> a;
+  Kokkos::View<float*> b;
+
+  template<class F>
+  void for_each_kokkos_view( F f ) { f(a); f(b); }
+};
+
+void
+checkpt_delta_test( const delta_test_t * t ) {
+  CHECKPT_KOKKOS( t );
+  CHECKPT_VIEW( "a", t->a, t->n );
+  CHECKPT_VIEW( "b", t->b, t->n );
+}
+
+delta_test_t *
+restore_delta_test( void ) {
+  delta_test_t * t;
+  RESTORE( t );
+  if( (int)RESTORE_VIEW( "a", t->a, t->n )!=t->n ||
+      (int)RESTORE_VIEW( "b", t->b, t->n )!=t->n )
+    ERROR(( "Malformed checkpt (sections differ)" ));
+  return t;
+}
+
+static void
+fill( Kokkos::View<float*> v,
+      float seed ) {
+  auto h = Kokkos::create_mirror_view( v );
+  for( int i=0; i<(int)h.extent(0); i++ ) h(i) = 0.25f*i + seed;
+  Kokkos::deep_copy( v, h );
+}
+
+// Number of entries of v that differ from fill( seed )
+static int
+mismatches( Kokkos::View<float*> v,
+            float seed ) {
+  auto h = Kokkos::create_mirror_view_and_copy( Kokkos::HostSpace(), v );
+  int failed = 0;
+  for( int i=0; i<(int)h.extent(0); i++ ) if( h(i)!=0.25f*i + seed ) failed++;
+  return failed;
+}
+
+TEST_CASE( "delta checkpts restore against their base", "[checkpt]" ) {
+
+    int pargc = 0;
+    char str[] = "bin/vpic";
+    char **pargv = (char **) malloc(sizeof(char **));
+    pargv[0] = str;
+    boot_services( &pargc, &pargv );
+
+    SECTION( "delta checkpt" )
+    {
+        delta_test_t * t = new delta_test_t;
+        t->n = 4096;
+        t->a = Kokkos::View<float*>( "a", t->n );
+        t->b = Kokkos::View<float*>( "b", t->n );
+        fill( t->a, 1 );
+        fill( t->b, 2 );
+        REGISTER_OBJECT( t, checkpt_delta_test, restore_delta_test, NULL );
+        const size_t id = object_id( t );
+
+        // The first checkpt is a full one even when a delta is asked for
+        std::vector<char> full;
+        checkpt_objects_buffered( "delta_test.full", full, 1 );
+        DumpWriter::write_file( "delta_test.full", full, false );
+        REQUIRE( !checkpt_base_in_use( "delta_test.full" ) );
+
+        // Only b changes, so only b is stored in the delta
+        fill( t->b, 3 );
+        std::vector<char> delta;
+        checkpt_objects_buffered( "delta_test.delta", delta, 1 );
+        DumpWriter::write_file( "delta_test.delta", delta, false );
+        REQUIRE( delta.size()+t->n*sizeof(float)/2<full.size() );
+        REQUIRE( checkpt_base_in_use( "delta_test.full" ) );
+        REQUIRE( !checkpt_base_in_use( "delta_test.delta" ) );
+
+        fill( t->a, 4 );
+        fill( t->b, 4 );
+        restore_objects( "delta_test.delta" );
+        reanimate_objects();
+        delta_test_t * r = (delta_test_t *)object_ptr( id );
+        REQUIRE( r );
+        REQUIRE( mismatches( r->a, 1 )==0 );
+        REQUIRE( mismatches( r->b, 3 )==0 );
+
+        // The base still holds the original b
+        restore_objects( "delta_test.full" );
+        reanimate_objects();
+        r = (delta_test_t *)object_ptr( id );
+        REQUIRE( r );
+        REQUIRE( mismatches( r->a, 1 )==0 );
+        REQUIRE( mismatches( r->b, 2 )==0 );
+
+        // A delta under the name of its base is written as a full checkpt
+        std::vector<char> again;
+        checkpt_objects_buffered( "delta_test.full", again, 1 );
+        REQUIRE( again.size()>=full.size() );
+        REQUIRE( !checkpt_base_in_use( "delta_test.full" ) );
+
+        if( world_rank==0 ) log_printf( "normal exit\n" );
+
+        halt_mp();
+    }
+}
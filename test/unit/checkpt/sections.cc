@@ -0,0 +1,123 @@
+// Round trip of an object holding Kokkos views through checkpt_objects /
+// restore_objects, with the views stored as checksummed sections
+// (CHECKPT_KOKKOS, CHECKPT_VIEW and RESTORE_VIEW).
+
+#define CATCH_CONFIG_MAIN  // This tells Catch to provide a main()
+#include "catch.hpp"
+
+#include <iostream>
+#include <vector>
+
+#include "src/vpic/vpic.h"
+#include "src/util/checkpt/checkpt_kokkos.h"
+
+void vpic_simulation::user_diagnostics() {}
+
+void
+vpic_simulation::user_initialization( int num_cmdline_arguments,
+                                      char ** cmdline_argument ) {}
+
+// A checkpointed object with a rank 1 and a rank 2 view, of which only the
+// first n rows are in use
+struct section_test_t {
+  int n;
+  Kokkos::View<float*> a;
+  Kokkos::View<int*[3], Kokkos::LayoutLeft> b;
+
+  template<class F>
+  void for_each_kokkos_view( F f ) { f(a); f(b); }
+};
+
+void
+checkpt_section_test( const section_test_t * t ) {
+  CHECKPT_KOKKOS( t );
+  CHECKPT_VIEW( "a", t->a, t->n );
+  CHECKPT_VIEW( "b", t->b, t->n );
+}
+
+section_test_t *
+restore_section_test( void ) {
+  section_test_t * t;
+  RESTORE( t );
+  if( (int)RESTORE_VIEW( "a", t->a, 2*t->n )!=t->n ||
+      (int)RESTORE_VIEW( "b", t->b, 2*t->n )!=t->n )
+    ERROR(( "Malformed checkpt (sections differ)" ));
+  return t;
+}
+
+static void
+fill( section_test_t * t,
+      int seed ) {
+  auto a = Kokkos::create_mirror_view( t->a );
+  auto b = Kokkos::create_mirror_view( t->b );
+  for( int i=0; i<(int)a.extent(0); i++ ) {
+    a(i) = 0.5f*i + seed;
+    for( int j=0; j<3; j++ ) b(i, j) = 3*i + j + seed;
+  }
+  Kokkos::deep_copy( t->a, a );
+  Kokkos::deep_copy( t->b, b );
+}
+
+// Number of rows in use of t that differ from fill( seed )
+static int
+mismatches( section_test_t * t,
+            int seed ) {
+  auto a = Kokkos::create_mirror_view_and_copy( Kokkos::HostSpace(), t->a );
+  auto b = Kokkos::create_mirror_view_and_copy( Kokkos::HostSpace(), t->b );
+  int failed = 0;
+  for( int i=0; i<t->n; i++ ) {
+    if( a(i)!=0.5f*i + seed ) failed++;
+    for( int j=0; j<3; j++ ) if( b(i, j)!=3*i + j + seed ) failed++;
+  }
+  return failed;
+}
+
+TEST_CASE( "checkpt sections round trip", "[checkpt]" ) {
+
+    int pargc = 0;
+    char str[] = "bin/vpic";
+    char **pargv = (char **) malloc(sizeof(char **));
+    pargv[0] = str;
+    boot_services( &pargc, &pargv );
+
+    SECTION( "views survive checkpt and restore" )
+    {
+        // Any change to the data changes the checksum, including ones
+        // that keep the sum of the words
+        std::vector<uint32_t> w( 64 );
+        for( size_t i=0; i<w.size(); i++ ) w[i] = 7*i + 1;
+        const uint64_t h = checkpt_checksum( w.data(), w.size()*sizeof(uint32_t) );
+        std::swap( w[3], w[40] );
+        REQUIRE( checkpt_checksum( w.data(), w.size()*sizeof(uint32_t) )!=h );
+        std::swap( w[3], w[40] );
+        w[5]++; w[6]--;
+        REQUIRE( checkpt_checksum( w.data(), w.size()*sizeof(uint32_t) )!=h );
+        w[5]--; w[6]++;
+        REQUIRE( checkpt_checksum( w.data(), w.size()*sizeof(uint32_t)-1 )!=h );
+
+        section_test_t * t = new section_test_t;
+        t->n = 1000;
+        t->a = Kokkos::View<float*>( "a", 1500 );
+        t->b = Kokkos::View<int*[3], Kokkos::LayoutLeft>( "b", 1500 );
+        fill( t, 1 );
+        REGISTER_OBJECT( t, checkpt_section_test, restore_section_test, NULL );
+        const size_t id = object_id( t );
+
+        checkpt_objects( "section_test.checkpt" );
+        fill( t, 2 );
+        REQUIRE( mismatches( t, 1 )>0 );
+
+        // Restoring replaces every registered object
+        restore_objects( "section_test.checkpt" );
+        reanimate_objects();
+        section_test_t * r = (section_test_t *)object_ptr( id );
+        REQUIRE( r );
+        REQUIRE( r->n==1000 );
+        REQUIRE( r->a.extent(0)==2000 );
+        REQUIRE( mismatches( r, 1 )==0 );
+
+        if( world_rank==0 ) log_printf( "normal exit\n" );
+
+        halt_mp();
+    }
+}
@@ -0,0 +1,120 @@
+// The Langevin model decays the momentum of every particle by
+// exp(-nu dt) and adds a normal kick per component, so a cold beam keeps
+// a mean momentum of exp(-n nu dt) u0 after n steps while each component
+// spreads to a variance of (1 - exp(-2 n nu dt)) kT / mc.
+
+#define CATCH_CONFIG_MAIN  // This tells Catch to provide a main()
+#include "catch.hpp"
+
+#include <cmath>
+#include <iostream>
+
+#include "src/species_advance/species_advance.h"
+#include "src/vpic/vpic.h"
+
+void vpic_simulation::user_diagnostics() {}
+
+void
+vpic_simulation::user_initialization( int num_cmdline_arguments,
+                                      char ** cmdline_argument )
+{
+    double L  = 4;
+    int npart = 65536;
+    int nstep = 4;
+    float kT  = 0.01;
+    float nu  = 0.5;
+    float u0  = 1;
+
+    define_units( 1, 1 );
+    define_timestep( 0.5 );
+    define_periodic_grid( 0, 0, 0,   // Grid low corner
+                          L, L, L,   // Grid high corner
+                          4, 4, 4,   // Grid resolution
+                          1, 1, 1 ); // Processor configuration
+    define_material( "vacuum", 1.0, 1.0, 0.0 );
+    define_field_array();
+
+    species_t * sp = define_species( "beam", -1., 2., npart, npart, 0, 0 );
+
+    for (int i = 0; i < npart; i++)
+    {
+        float x = uniform( rng(0), 0, L);
+        float y = uniform( rng(0), 0, L);
+        float z = uniform( rng(0), 0, L);
+        inject_particle( sp, x, y, z, u0, 0, 0, 1., 0., 0);
+    }
+
+    sp->copy_to_device();
+
+    collision_op_t * cop = langevin( kT, nu, sp, entropy, 1 );
+    const double nudt = nu*grid->dt;
+    const double kT_mc = kT/( sp->m*grid->cvac );
+    int failed = 0;
+
+    for( int n=1; n<=nstep; n++ ) {
+      apply_collision_op_list( cop );
+
+      double mean[3] = { 0, 0, 0 }, var[3] = { 0, 0, 0 };
+      Kokkos::deep_copy( sp->k_p_h, sp->k_p_d );
+      for( int i=0; i<sp->np; i++ ) {
+        mean[0] += sp->k_p_h(i, particle_var::ux);
+        mean[1] += sp->k_p_h(i, particle_var::uy);
+        mean[2] += sp->k_p_h(i, particle_var::uz);
+      }
+      for( int d=0; d<3; d++ ) mean[d] /= sp->np;
+      for( int i=0; i<sp->np; i++ ) {
+        const double du[3] = { sp->k_p_h(i, particle_var::ux) - mean[0],
+                               sp->k_p_h(i, particle_var::uy) - mean[1],
+                               sp->k_p_h(i, particle_var::uz) - mean[2] };
+        for( int d=0; d<3; d++ ) var[d] += du[d]*du[d];
+      }
+      for( int d=0; d<3; d++ ) var[d] /= sp->np - 1;
+
+      // The sample mean is off by about sqrt(var/np) and the sample
+      // variance by about sqrt(2/np) of itself; allow 5 of those
+      const double expected_var = -std::expm1( -2*n*nudt )*kT_mc;
+      const double mean_tol = 5*std::sqrt( expected_var/sp->np );
+      const double var_tol  = 5*std::sqrt( 2./sp->np )*expected_var;
+      for( int d=0; d<3; d++ ) {
+        const double expected_mean = d==0 ? std::exp( -n*nudt )*u0 : 0;
+        if( std::abs( mean[d]-expected_mean )>mean_tol ||
+            std::abs( var[d]-expected_var )>var_tol )
+        {
+          std::cout << " Step " << n << " component " << d << ": mean " << mean[d]
+                    << " (expected " << expected_mean << "), variance " << var[d]
+                    << " (expected " << expected_var << ")" << std::endl;
+          failed++;
+        }
+      }
+    }
+
+    delete_collision_op_list( cop );
+
+    if( failed )
+    {  std::cout << "FAIL" << std::endl;
+    }
+    REQUIRE_FALSE(failed);
+
+    std::cout << "pass" << std::endl;
+}
+
+TEST_CASE( "Langevin drag and diffusion", "[collision]" ) {
+
+    int pargc = 0;
+    char str[] = "bin/vpic";
+    char **pargv = (char **) malloc(sizeof(char **));
+    pargv[0] = str;
+    boot_services( &pargc, &pargv );
+
+    SECTION( "moments" )
+    {
+        vpic_simulation* simulation = new vpic_simulation;
+        simulation->initialize( pargc, pargv );
+
+        simulation->finalize();
+        delete simulation;
+        if( world_rank==0 ) log_printf( "normal exit\n" );
+
+        halt_mp();
+    }
+}
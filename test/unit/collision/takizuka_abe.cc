@@ -0,0 +1,210 @@
+// The Takizuka-Abe model rotates the relative momentum of each colliding
+// pair about their center of mass, so it conserves the total momentum and
+// the (non-relativistic) kinetic energy of the particles, both within a
+// species and between two species. Between two species every collision
+// uses the lower of the two densities, so a beam is slowed down by a
+// heavy background at the rate set by the background density, whichever
+// of the two has more particles.
+
+#define CATCH_CONFIG_MAIN  // This tells Catch to provide a main()
+#include "catch.hpp"
+
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include "src/species_advance/species_advance.h"
+#include "src/vpic/vpic.h"
+
+// Add the momentum (x, y, z), the kinetic energy sum m w |u|^2 / 2 and
+// its z part of sp to m
+static void
+moments( species_t * sp,
+         double m[5] ) {
+  Kokkos::deep_copy( sp->k_p_h, sp->k_p_d );
+  for( int i=0; i<sp->np; i++ ) {
+    const double w  = sp->k_p_h(i, particle_var::w);
+    const double ux = sp->k_p_h(i, particle_var::ux);
+    const double uy = sp->k_p_h(i, particle_var::uy);
+    const double uz = sp->k_p_h(i, particle_var::uz);
+    m[0] += sp->m*w*ux;
+    m[1] += sp->m*w*uy;
+    m[2] += sp->m*w*uz;
+    m[3] += 0.5*sp->m*w*( ux*ux + uy*uy + uz*uz );
+    m[4] += 0.5*sp->m*w*uz*uz;
+  }
+}
+
+// Number of pairs of particles of spi and spj that share a voxel
+static double
+voxel_pairs( species_t * spi,
+             species_t * spj ) {
+  std::vector<double> ni( spi->g->nv, 0. );
+  double pairs = 0;
+  Kokkos::deep_copy( spi->k_p_i_h, spi->k_p_i_d );
+  Kokkos::deep_copy( spj->k_p_i_h, spj->k_p_i_d );
+  for( int i=0; i<spi->np; i++ ) ni[ spi->k_p_i_h(i) ]++;
+  for( int j=0; j<spj->np; j++ ) pairs += ni[ spj->k_p_i_h(j) ];
+  return pairs;
+}
+
+// Mean x momentum of sp, per unit mass
+static double
+mean_ux( species_t * sp ) {
+  double s = 0;
+  Kokkos::deep_copy( sp->k_p_h, sp->k_p_d );
+  for( int i=0; i<sp->np; i++ ) s += sp->k_p_h(i, particle_var::ux);
+  return s/sp->np;
+}
+
+void vpic_simulation::user_diagnostics() {}
+
+void
+vpic_simulation::user_initialization( int num_cmdline_arguments,
+                                      char ** cmdline_argument )
+{
+    double L  = 4;
+    int npart = 8192;
+    int nstep = 8;
+
+    define_units( 1, 1 );
+    define_timestep( 0.5 );
+    define_periodic_grid( 0, 0, 0,   // Grid low corner
+                          L, L, L,   // Grid high corner
+                          4, 4, 4,   // Grid resolution
+                          1, 1, 1 ); // Processor configuration
+    define_material( "vacuum", 1.0, 1.0, 0.0 );
+    define_field_array();
+
+    species_t * sp_list[2];
+    sp_list[0] = define_species( "electron", -1., 1., npart, npart, 0, 0 );
+    sp_list[1] = define_species( "ion", 1., 4., npart, npart, 0, 0 );
+
+    // A cold beam in x through a heavy background at rest, with the beam
+    // the less (first pair) and the more (second pair) populated species
+    const int nsparse = npart/8, ndense = npart/2;
+    species_t * beam[2], * background[2];
+    beam[0]       = define_species( "beam_sparse", -1., 1., nsparse, nsparse, 0, 0 );
+    background[0] = define_species( "background_dense", 1., 1e4, ndense, ndense, 0, 0 );
+    beam[1]       = define_species( "beam_dense", -1., 1., ndense, ndense, 0, 0 );
+    background[1] = define_species( "background_sparse", 1., 1e4, nsparse, nsparse, 0, 0 );
+
+    // Random counts per voxel, so odd counts (the three particle
+    // collisions) and unequal counts of the two species come up. The
+    // weights are the same, as the model assumes.
+    for( int s=0; s<2; s++ )
+      for (int i = 0; i < npart; i++)
+      {
+        float x = uniform( rng(0), 0, L);
+        float y = uniform( rng(0), 0, L);
+        float z = uniform( rng(0), 0, L);
+        float ux = normal( rng(0), 0.05, 0.1);
+        float uy = normal( rng(0), 0, 0.1);
+        float uz = normal( rng(0), 0, 0.2);
+        inject_particle( sp_list[s], x, y, z, ux, uy, uz, 1., 0., 0);
+      }
+
+    for( int s=0; s<2; s++ ) sp_list[s]->copy_to_device();
+
+    const float w_beam = 1e-3;
+    for( int b=0; b<2; b++ ) {
+      species_t * sp[2] = { beam[b], background[b] };
+      for( int s=0; s<2; s++ ) {
+        for( int i=0; i<sp[s]->max_np; i++ )
+          inject_particle( sp[s], uniform( rng(0), 0, L ), uniform( rng(0), 0, L ),
+                           uniform( rng(0), 0, L ), s ? 0 : 1, 0, 0, w_beam, 0., 0 );
+        sp[s]->copy_to_device();
+      }
+    }
+
+    float reltol = 1e-4;
+    int failed = 0;
+
+    // Electron-electron, then electron-ion
+    for( int c=0; c<2; c++ ) {
+      collision_op_t * cop = takizuka_abe( c ? "ei" : "ee", sp_list[0],
+                                           sp_list[c], entropy, 10, 1 );
+
+      double before[5] = { 0, 0, 0, 0, 0 }, after[5] = { 0, 0, 0, 0, 0 };
+      for( int s=0; s<=c; s++ ) moments( sp_list[s], before );
+
+      for( int n=0; n<nstep; n++ ) apply_collision_op_list( cop );
+      delete_collision_op_list( cop );
+
+      for( int s=0; s<=c; s++ ) moments( sp_list[s], after );
+
+      // The momenta start hotter in z, so the collisions must have moved
+      // energy out of z
+      REQUIRE( after[4]<(1-100*reltol)*before[4] );
+
+      // Compare the momentum against its thermal spread, summed in
+      // quadrature over the particles
+      const double p_scale = std::sqrt( 2*before[3]*sp_list[1]->m );
+      for( int d=0; d<3; d++ )
+        if( std::abs( after[d]-before[d] )>reltol*p_scale )
+        {
+          std::cout << " Momentum " << d << " of model " << c << " went from "
+                    << before[d] << " to " << after[d] << std::endl;
+          failed++;
+        }
+      if( std::abs( after[3]-before[3] )>reltol*before[3] )
+      {
+        std::cout << " Energy of model " << c << " went from "
+                  << before[3] << " to " << after[3] << std::endl;
+        failed++;
+      }
+    }
+
+    // Each collision of a beam particle takes 1-cos(theta) ~ 2 delta^2 of
+    // its momentum, and delta^2 has a variance of var0 w n_lower / u^3
+    // (u = 1). Each particle of the more populated species collides once
+    // and each of the other about n_more/n_less times, so either way a
+    // voxel loses 2 var0 w n_beam n_background of beam momentum.
+    const double var0 = 10*grid->dt /
+                        ( 8*M_PI*grid->eps0*grid->eps0*std::pow( 1e4/(1+1e4), 2 )*
+                          std::pow( grid->cvac, 3 )*grid->dV );
+    for( int b=0; b<2; b++ ) {
+      collision_op_t * cop = takizuka_abe( "beam", beam[b], background[b],
+                                           entropy, 10, 1 );
+      const double expected = 2*var0*w_beam*voxel_pairs( beam[b], background[b] )
+                            / beam[b]->np;
+      apply_collision_op_list( cop );
+      delete_collision_op_list( cop );
+
+      const double slowdown = 1 - mean_ux( beam[b] );
+      if( std::abs( slowdown-expected )>0.1*expected )
+      {
+        std::cout << " Beam " << b << " slowed down by " << slowdown
+                  << " instead of " << expected << std::endl;
+        failed++;
+      }
+    }
+
+    if( failed )
+    {  std::cout << "FAIL" << std::endl;
+    }
+    REQUIRE_FALSE(failed);
+
+    std::cout << "pass" << std::endl;
+}
+
+TEST_CASE( "Takizuka-Abe collisions conserve momentum and energy", "[collision]" ) {
+
+    int pargc = 0;
+    char str[] = "bin/vpic";
+    char **pargv = (char **) malloc(sizeof(char **));
+    pargv[0] = str;
+    boot_services( &pargc, &pargv );
+
+    SECTION( "conservation" )
+    {
+        vpic_simulation* simulation = new vpic_simulation;
+        simulation->initialize( pargc, pargv );
+
+        simulation->finalize();
+        delete simulation;
+        if( world_rank==0 ) log_printf( "normal exit\n" );
+
+        halt_mp();
+    }
+}
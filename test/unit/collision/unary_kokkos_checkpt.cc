@@ -0,0 +1,116 @@
+// A unary_collision_model_kokkos operator keeps its model as raw bytes
+// next to the kernel instantiated for the model type. After a checkpt
+// and restore, the restored operator must still run that kernel with the
+// same model parameters on the restored species.
+
+#define CATCH_CONFIG_MAIN  // This tells Catch to provide a main()
+#include "catch.hpp"
+
+#include <iostream>
+
+#include "src/species_advance/species_advance.h"
+#include "src/vpic/vpic.h"
+
+// Every particle that collides is given the momentum (ux, uy, uz)
+struct reset_model {
+  float rate, ux, uy, uz;
+
+  KOKKOS_INLINE_FUNCTION float
+  rate_constant( float, float, float ) const { return rate; }
+
+  template<class generator_t>
+  KOKKOS_INLINE_FUNCTION void
+  collide( float & ux_, float & uy_, float & uz_,
+           generator_t & ) const {
+    ux_ = ux; uy_ = uy; uz_ = uz;
+  }
+};
+
+static const int npart = 4096;
+static const reset_model model = { 2, 0.25, -0.5, 0.75 }; // rate dt = 1
+
+// Objects of the checkpointed simulation, found again after the restore
+static size_t sp_id, op_id;
+
+void vpic_simulation::user_diagnostics() {}
+
+void
+vpic_simulation::user_initialization( int num_cmdline_arguments,
+                                      char ** cmdline_argument )
+{
+    double L = 4;
+
+    define_units( 1, 1 );
+    define_timestep( 0.5 );
+    define_periodic_grid( 0, 0, 0,   // Grid low corner
+                          L, L, L,   // Grid high corner
+                          4, 4, 4,   // Grid resolution
+                          1, 1, 1 ); // Processor configuration
+    define_material( "vacuum", 1.0, 1.0, 0.0 );
+    define_field_array();
+
+    species_t * sp = define_species( "test_species", 1., 1., npart, npart, 0, 0 );
+    for (int i = 0; i < npart; i++)
+    {
+        float x = uniform( rng(0), 0, L);
+        float y = uniform( rng(0), 0, L);
+        float z = uniform( rng(0), 0, L);
+        inject_particle( sp, x, y, z, 0, 0, 0, 1., 0., 0);
+    }
+    sp->copy_to_device();
+
+    // A collision probability of exactly one, so every particle collides
+    // if the model and the interval come back intact
+    collision_op_t * cop = define_collision_op(
+      unary_collision_model_kokkos( "reset", model, sp, entropy, 1 ) );
+
+    sp_id = object_id( sp );
+    op_id = object_id( cop );
+}
+
+TEST_CASE( "unary_collision_model_kokkos survives checkpt and restore", "[collision]" ) {
+
+    int pargc = 0;
+    char str[] = "bin/vpic";
+    char **pargv = (char **) malloc(sizeof(char **));
+    pargv[0] = str;
+    boot_services( &pargc, &pargv );
+
+    SECTION( "checkpt and restore" )
+    {
+        vpic_simulation* simulation = new vpic_simulation;
+        simulation->initialize( pargc, pargv );
+        const size_t sim_id = object_id( simulation );
+
+        checkpt_objects( "unary_kokkos.checkpt" );
+
+        // The original objects are no longer registered after this, so
+        // only the restored simulation is finalized and deleted
+        restore_objects( "unary_kokkos.checkpt" );
+        reanimate_objects();
+        vpic_simulation * restored = (vpic_simulation *)object_ptr( sim_id );
+        species_t * sp = (species_t *)object_ptr( sp_id );
+        collision_op_t * cop = (collision_op_t *)object_ptr( op_id );
+        REQUIRE( restored );
+        REQUIRE( sp );
+        REQUIRE( cop );
+        REQUIRE( sp->np==npart );
+
+        apply_collision_op_list( cop );
+
+        Kokkos::deep_copy( sp->k_p_h, sp->k_p_d );
+        int failed = 0;
+        for( int i=0; i<sp->np; i++ )
+          if( sp->k_p_h(i, particle_var::ux)!=model.ux ||
+              sp->k_p_h(i, particle_var::uy)!=model.uy ||
+              sp->k_p_h(i, particle_var::uz)!=model.uz ) failed++;
+        if( failed ) std::cout << failed << " particles did not collide as modeled" << std::endl;
+        REQUIRE_FALSE( failed );
+
+        restored->finalize();
+        delete restored;
+        if( world_rank==0 ) log_printf( "normal exit\n" );
+
+        halt_mp();
+    }
+}
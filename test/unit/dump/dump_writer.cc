@@ -0,0 +1,124 @@
+// The background DumpWriter must put the same bytes on disk as a
+// synchronous dump, and a dump handed to it must not change once the
+// dump routine has returned, whatever happens to the fields afterwards.
+
+#define CATCH_CONFIG_MAIN  // This tells Catch to provide a main()
+#include "catch.hpp"
+
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <vector>
+
+#include "src/util/io/DumpWriter.h"
+#include "src/vpic/vpic.h"
+
+static std::vector<char>
+read_file( const char * fname ) {
+  std::ifstream in( fname, std::ios::binary );
+  return std::vector<char>( (std::istreambuf_iterator<char>( in )),
+                            std::istreambuf_iterator<char>() );
+}
+
+static bool
+file_exists( const char * fname ) {
+  return std::ifstream( fname ).good();
+}
+
+void vpic_simulation::user_diagnostics() {}
+
+void
+vpic_simulation::user_initialization( int num_cmdline_arguments,
+                                      char ** cmdline_argument )
+{
+    double L = 4;
+    int npart = 4096;
+
+    define_units( 1, 1 );
+    define_timestep( 0.5 );
+    define_periodic_grid( 0, 0, 0,   // Grid low corner
+                          L, L, L,   // Grid high corner
+                          4, 4, 4,   // Grid resolution
+                          1, 1, 1 ); // Processor configuration
+    define_material( "vacuum", 1.0, 1.0, 0.0 );
+    define_field_array();
+
+    species_t * sp = define_species( "test_species", 1., 1., npart, npart, 0, 0 );
+    for( int i=0; i<npart; i++ )
+      inject_particle( sp, uniform( rng(0), 0, L ), uniform( rng(0), 0, L ),
+                       uniform( rng(0), 0, L ), uniform( rng(0), -1, 1 ),
+                       uniform( rng(0), -1, 1 ), uniform( rng(0), -1, 1 ), 1., 0., 0 );
+    for( int v=0; v<grid->nv; v++ ) field_array->f[v].ex = v;
+    field_array->copy_to_device();
+    sp->copy_to_device();
+
+    async_dump = false;
+    dump_fields( "sync_fields", 0 );
+    dump_particles( "test_species", "sync_particles", 0 );
+
+    async_dump = true;
+    dump_fields( "async_fields", 0 );
+    dump_particles( "test_species", "async_particles", 0 );
+    REQUIRE( dump_writer );
+
+    // The staged dump is already decoupled from the fields
+    for( int v=0; v<grid->nv; v++ ) field_array->f[v].ex = -1;
+    dump_writer->flush();
+
+    const std::vector<char> sync_f = read_file( "sync_fields.0" );
+    const std::vector<char> sync_p = read_file( "sync_particles.0" );
+    REQUIRE( sync_f.size()>grid->nv*sizeof(field_t) );
+    REQUIRE( sync_p.size()>npart*sizeof(particle_t) );
+    REQUIRE( read_file( "async_fields.0" )==sync_f );
+    REQUIRE( read_file( "async_particles.0" )==sync_p );
+
+    std::cout << "pass" << std::endl;
+}
+
+TEST_CASE( "background dump writer", "[dump]" )
+{
+    int pargc = 0;
+    char str[] = "bin/vpic";
+    char **pargv = (char **) malloc(sizeof(char **));
+    pargv[0] = str;
+    boot_services( &pargc, &pargv );
+
+    SECTION("main")
+    {
+        // With a single slot every submit waits for the previous file,
+        // which must still come out complete and in order
+        {
+            DumpWriter writer( 1 );
+            for( int n=0; n<8; n++ ) {
+                char fname[64];
+                snprintf( fname, 64, "writer_test.%d", n );
+                std::vector<char> data( 1000*(n+1), char('a'+n) );
+                writer.submit( fname, data );
+                REQUIRE( data.empty() );
+            }
+        } // The destructor finishes the queue
+        for( int n=0; n<8; n++ ) {
+            char fname[64];
+            snprintf( fname, 64, "writer_test.%d", n );
+            REQUIRE( read_file( fname )==std::vector<char>( 1000*(n+1), char('a'+n) ) );
+        }
+
+        // A replacing write leaves no temporary behind
+        {
+            DumpWriter writer;
+            std::vector<char> data( 10, 'z' );
+            writer.submit( "writer_test.0", data, true );
+            writer.flush();
+        }
+        REQUIRE( read_file( "writer_test.0" )==std::vector<char>( 10, 'z' ) );
+        REQUIRE( !file_exists( "writer_test.0.tmp" ) );
+
+        vpic_simulation* simulation = new vpic_simulation;
+        simulation->initialize( pargc, pargv );
+        simulation->finalize();
+        delete simulation;
+        if( world_rank==0 ) log_printf( "normal exit\n" );
+
+        halt_mp();
+    }
+}
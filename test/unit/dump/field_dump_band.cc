@@ -0,0 +1,129 @@
+// Reads back strided field_dump output and checks it voxel by voxel
+// against the fields it was written from. A band dump of float variables
+// only is gathered on the device, one that also selects a material word
+// is gathered on the host; band_interleave writes whole field_t.
+
+#define CATCH_CONFIG_MAIN  // This tells Catch to provide a main()
+#include "catch.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <vector>
+
+#include "src/vpic/vpic.h"
+
+// The last nbytes of the dump file of this step
+static std::vector<char>
+dump_tail( const char * base,
+           long step,
+           size_t nbytes ) {
+  char fname[256];
+  snprintf( fname, 256, "./T.%ld/%s.%ld.%d", step, base, step, world_rank );
+  std::ifstream in( fname, std::ios::binary );
+  std::vector<char> all( (std::istreambuf_iterator<char>( in )),
+                         std::istreambuf_iterator<char>() );
+  REQUIRE( all.size()>nbytes );
+  return std::vector<char>( all.end()-nbytes, all.end() );
+}
+
+// Voxel written at output index i of an axis with n cells
+static int
+dump_voxel( int i,
+            int nout,
+            int n,
+            int stride ) {
+  return i==0 ? 0 : i==nout+1 ? n+1 : i*stride;
+}
+
+void vpic_simulation::user_diagnostics() {}
+
+void
+vpic_simulation::user_initialization( int num_cmdline_arguments,
+                                      char ** cmdline_argument )
+{
+    define_units( 1, 1 );
+    define_timestep( 0.5 );
+    define_periodic_grid( 0, 0, 0,   // Grid low corner
+                          8, 6, 4,   // Grid high corner
+                          8, 6, 4,   // Grid resolution
+                          1, 1, 1 ); // Processor configuration
+    define_material( "vacuum", 1.0, 1.0, 0.0 );
+    define_field_array();
+
+    // Every float of every voxel is distinct
+    field_t * f = field_array->f;
+    for( int v=0; v<grid->nv; v++ ) {
+      float * w = (float *)( f + v );
+      for( int c=0; c<FIELD_VAR_COUNT; c++ ) w[c] = 100*v + c;
+    }
+    field_array->copy_to_device();
+
+    const int nx = grid->nx, ny = grid->ny, nz = grid->nz;
+    const int sx = 2, sy = 3, sz = 2;
+    const int nxo = nx/sx, nyo = ny/sy, nzo = nz/sz;
+    const size_t nband = size_t(nxo+2)*(nyo+2)*(nzo+2);
+
+    DumpParameters p;
+    p.stride_x = sx; p.stride_y = sy; p.stride_z = sz;
+    strcpy( p.baseDir, "." );
+
+    // The 32-bit words of the selected variables, one band per variable
+    const int selections[2][3] = { { 0, 6, 13 },                  // ex, cbz, jfy
+                                   { 2, 11, FIELD_VAR_COUNT } };  // ez, tcaz, ematx|ematy
+    for( int s=0; s<2; s++ ) {
+      p.format = band;
+      snprintf( p.baseFileName, 128, "band%d", s );
+      p.output_vars.clear( 0xffffffff );
+      for( int c=0; c<3; c++ ) p.output_vars.setibit( selections[s][c] );
+      field_dump( p );
+
+      std::vector<char> tail = dump_tail( p.baseFileName, step(), 3*nband*sizeof(uint32_t) );
+      const uint32_t * out = (const uint32_t *)tail.data();
+      int failed = 0;
+      for( int c=0; c<3; c++ )
+        for( int k=0; k<nzo+2; k++ ) for( int j=0; j<nyo+2; j++ ) for( int i=0; i<nxo+2; i++ ) {
+          const int v = VOXEL( dump_voxel(i, nxo, nx, sx), dump_voxel(j, nyo, ny, sy),
+                               dump_voxel(k, nzo, nz, sz), nx, ny, nz );
+          if( *(out++)!=( (const uint32_t *)( f + v ) )[ selections[s][c] ] ) failed++;
+        }
+      REQUIRE( failed==0 );
+    }
+
+    p.format = band_interleave;
+    strcpy( p.baseFileName, "interleave" );
+    field_dump( p );
+
+    std::vector<char> tail = dump_tail( p.baseFileName, step(), nband*sizeof(field_t) );
+    const field_t * out = (const field_t *)tail.data();
+    int failed = 0;
+    for( int k=0; k<nzo+2; k++ ) for( int j=0; j<nyo+2; j++ ) for( int i=0; i<nxo+2; i++ ) {
+      const int v = VOXEL( dump_voxel(i, nxo, nx, sx), dump_voxel(j, nyo, ny, sy),
+                           dump_voxel(k, nzo, nz, sz), nx, ny, nz );
+      if( memcmp( out++, f + v, sizeof(field_t) ) ) failed++;
+    }
+    REQUIRE( failed==0 );
+
+    std::cout << "pass" << std::endl;
+}
+
+TEST_CASE( "strided field dumps", "[dump]" )
+{
+    int pargc = 0;
+    char str[] = "bin/vpic";
+    char **pargv = (char **) malloc(sizeof(char **));
+    pargv[0] = str;
+    boot_services( &pargc, &pargv );
+
+    SECTION("main")
+    {
+        vpic_simulation* simulation = new vpic_simulation;
+        simulation->initialize( pargc, pargv );
+        simulation->finalize();
+        delete simulation;
+        if( world_rank==0 ) log_printf( "normal exit\n" );
+
+        halt_mp();
+    }
+}
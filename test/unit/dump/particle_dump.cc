@@ -0,0 +1,118 @@
+// dump_particles time centers the particles on the device (center_p_kokkos)
+// and streams them out in chunks. The centering must agree with the host
+// center_p, the file must hold the centered particles of every chunk in
+// order, and the species itself must be left as it was.
+
+#define CATCH_CONFIG_MAIN  // This tells Catch to provide a main()
+#include "catch.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <vector>
+
+#include "src/species_advance/species_advance.h"
+#include "src/vpic/vpic.h"
+
+static bool
+close_enough( float a,
+              float b ) {
+  return std::fabs( a-b ) <= 1e-5*( 1 + std::fabs( b ) );
+}
+
+void vpic_simulation::user_diagnostics() {}
+
+void
+vpic_simulation::user_initialization( int num_cmdline_arguments,
+                                      char ** cmdline_argument )
+{
+    double L  = 4;
+    int npart = 1048576 + 4099; // One full chunk and a partial one
+
+    define_units( 1, 1 );
+    define_timestep( 0.5 );
+    define_periodic_grid( 0, 0, 0,   // Grid low corner
+                          L, L, L,   // Grid high corner
+                          4, 4, 4,   // Grid resolution
+                          1, 1, 1 ); // Processor configuration
+    define_material( "vacuum", 1.0, 1.0, 0.0 );
+    define_field_array();
+
+    species_t * sp = define_species( "test_species", -1., 1., npart, npart, 0, 0 );
+    for( int i=0; i<npart; i++ )
+      inject_particle( sp, uniform( rng(0), 0, L ), uniform( rng(0), 0, L ),
+                       uniform( rng(0), 0, L ), uniform( rng(0), -1, 1 ),
+                       uniform( rng(0), -1, 1 ), uniform( rng(0), -1, 1 ), 1., 0., 0 );
+
+    // Fields that vary across the grid so that every interpolation
+    // coefficient takes part
+    field_t * f = field_array->f;
+    for( int v=0; v<grid->nv; v++ ) {
+      f[v].ex  = 0.02*( v%5 );  f[v].ey  = 0.01*( v%7 );  f[v].ez  = -0.03*( v%3 );
+      f[v].cbx = 0.1*( v%4 );   f[v].cby = -0.05*( v%6 ); f[v].cbz = 0.2 + 0.02*( v%9 );
+    }
+    field_array->copy_to_device();
+    sp->copy_to_device();
+    load_interpolator_array( interpolator_array, field_array );
+    interpolator_array->copy_to_host();
+
+    // Host reference on a copy of the particles
+    std::vector<particle_t> ref( sp->p, sp->p + sp->np );
+    particle_t * sp_p = sp->p;
+    sp->p = ref.data();
+    center_p( sp, interpolator_array );
+    sp->p = sp_p;
+
+    Kokkos::View<particle_t*> out( "centered", sp->np );
+    center_p_kokkos( sp, interpolator_array, 0, sp->np, out );
+    auto out_h = Kokkos::create_mirror_view_and_copy( Kokkos::HostSpace(), out );
+
+    int failed = 0;
+    for( int n=0; n<sp->np; n++ ) {
+      const particle_t & a = out_h(n), & b = ref[n];
+      if( a.dx!=b.dx || a.dy!=b.dy || a.dz!=b.dz || a.i!=b.i || a.w!=b.w ||
+          !close_enough( a.ux, b.ux ) || !close_enough( a.uy, b.uy ) ||
+          !close_enough( a.uz, b.uz ) ) failed++;
+    }
+    REQUIRE( ref[0].ux!=sp->p[0].ux ); // The fields did move the particles
+    REQUIRE_FALSE( failed );
+
+    dump_particles( "test_species", "centered", 0 );
+    std::ifstream in( "centered.0", std::ios::binary );
+    std::vector<char> file( (std::istreambuf_iterator<char>( in )),
+                            std::istreambuf_iterator<char>() );
+    const size_t nbytes = sp->np*sizeof(particle_t);
+    REQUIRE( file.size()>nbytes );
+    REQUIRE( !memcmp( file.data() + file.size() - nbytes, out_h.data(), nbytes ) );
+
+    // The species still holds the particles half a step stale
+    Kokkos::deep_copy( sp->k_p_h, sp->k_p_d );
+    for( int n=0; n<sp->np; n++ )
+      if( sp->k_p_h(n, particle_var::ux)!=sp->p[n].ux ||
+          sp->k_p_h(n, particle_var::uz)!=sp->p[n].uz ) failed++;
+    REQUIRE_FALSE( failed );
+
+    std::cout << "pass" << std::endl;
+}
+
+TEST_CASE( "device centered particle dump", "[dump]" )
+{
+    int pargc = 0;
+    char str[] = "bin/vpic";
+    char **pargv = (char **) malloc(sizeof(char **));
+    pargv[0] = str;
+    boot_services( &pargc, &pargv );
+
+    SECTION("main")
+    {
+        vpic_simulation* simulation = new vpic_simulation;
+        simulation->initialize( pargc, pargv );
+        simulation->finalize();
+        delete simulation;
+        if( world_rank==0 ) log_printf( "normal exit\n" );
+
+        halt_mp();
+    }
+}
@@ -0,0 +1,140 @@
+// Device child_langmuir emission. A field that points into the domain on
+// the low x faces and out of it on the high x faces makes only the low x
+// faces emit. Each of them must emit n_emit_per_face particles at np+k,
+// with the Child-Langmuir weight and a half-Maxwellian momentum, aged
+// a little way into their cell. An emitter that runs out of particle
+// storage fills what there is.
+
+#define CATCH_CONFIG_MAIN  // This tells Catch to provide a main()
+#include "catch.hpp"
+
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include "src/emitter/emitter.h"
+#include "src/vpic/vpic.h"
+
+// Low x faces of the first layer of cells, high x faces of the last one,
+// and an edge of each, which the emitter must ignore
+static emitter_t *
+emit_from_x_faces( emitter_t * e,
+                   const grid_t * g ) {
+  const int nx = g->nx, ny = g->ny, nz = g->nz;
+  int32_t * c = size_emitter( e, 3*ny*nz );
+  for( int k=1; k<=nz; k++ ) for( int j=1; j<=ny; j++ ) {
+    *(c++) = COMPONENT_ID( VOXEL(1, j,k, nx,ny,nz), BOUNDARY(-1, 0, 0) );
+    *(c++) = COMPONENT_ID( VOXEL(nx,j,k, nx,ny,nz), BOUNDARY( 1, 0, 0) );
+    *(c++) = COMPONENT_ID( VOXEL(1, j,k, nx,ny,nz), BOUNDARY(-1,-1, 0) );
+  }
+  return e;
+}
+
+void vpic_simulation::user_diagnostics() {}
+
+void
+vpic_simulation::user_initialization( int num_cmdline_arguments,
+                                      char ** cmdline_argument )
+{
+    double L = 4;
+    int n_emit = 64;
+    float e0 = 0.5, ut_para = 0.1, ut_perp = 0.05;
+
+    define_units( 1, 1 );
+    define_timestep( 0.5 );
+    define_periodic_grid( 0, 0, 0,   // Grid low corner
+                          L, L, L,   // Grid high corner
+                          4, 4, 4,   // Grid resolution
+                          1, 1, 1 ); // Processor configuration
+    define_material( "vacuum", 1.0, 1.0, 0.0 );
+    define_field_array();
+
+    species_t * sp     = define_species( "electron", -1., 1., 4*16*n_emit, 16*n_emit, 0, 0 );
+    species_t * capped = define_species( "capped",   -1., 1., 100, 100, 0, 0 );
+
+    accumulator_array_t * aa = new_accumulator_array( grid );
+    emit_from_x_faces( define_emitter( child_langmuir( sp, interpolator_array, field_array,
+                       aa, entropy, n_emit, ut_para, ut_perp, 0, CHILD_LANGMUIR ) ), grid );
+    emit_from_x_faces( define_emitter( child_langmuir( capped, interpolator_array, field_array,
+                       aa, entropy, n_emit, ut_para, ut_perp, 0, CHILD_LANGMUIR ) ), grid );
+
+    for( int v=0; v<grid->nv; v++ ) field_array->f[v].ex = -e0;
+    field_array->copy_to_device();
+    load_interpolator_array( interpolator_array, field_array );
+
+    apply_emitter_list( emitter_list );
+    const int n = 16*n_emit;
+    REQUIRE( sp->np==n );
+    REQUIRE( capped->np==capped->max_np );
+
+    const float w = ( CHILD_LANGMUIR*grid->eps0*grid->dt ) /
+                    ( sqrtf( fabsf( sp->q*sp->m ) )*(float)n_emit ) *
+                    sqrtf( grid->rdx )*grid->dy*grid->dz * sqrtf( e0*e0*e0 );
+
+    // Particles in the first cells, drifting into them
+    auto check = [&]( species_t * s ) {
+      auto p   = Kokkos::create_mirror_view_and_copy( Kokkos::HostSpace(), s->k_p_d );
+      auto p_i = Kokkos::create_mirror_view_and_copy( Kokkos::HostSpace(), s->k_p_i_d );
+      int failed = 0, aged = 0;
+      double ux = 0, uy = 0, uz = 0;
+      for( int m=0; m<s->np; m++ ) {
+        const int x = p_i(m) % grid->sy;
+        if( x!=1 || p(m, particle_var::dx)<-1 || p(m, particle_var::dx)>0 ||
+            p(m, particle_var::ux)<0 ||
+            fabsf( p(m, particle_var::w) - w )>1e-5*w ) failed++;
+        if( p(m, particle_var::dx)>-1 ) aged++;
+        ux += p(m, particle_var::ux);
+        uy += p(m, particle_var::uy);
+        uz += p(m, particle_var::uz);
+      }
+      REQUIRE_FALSE( failed );
+      REQUIRE( aged>s->np/2 );
+      return std::vector<double>{ ux/s->np, uy/s->np, uz/s->np };
+    };
+    check( capped );
+    std::vector<double> u = check( sp );
+
+    // Normal momentum is Rayleigh distributed, tangential ones are normal
+    const double pi = M_PI;
+    REQUIRE( std::fabs( u[0] - ut_para*sqrt( pi/2 ) ) < 5*ut_para*sqrt( (4-pi)/2/n ) );
+    REQUIRE( std::fabs( u[1] ) < 5*ut_perp/sqrt( n ) );
+    REQUIRE( std::fabs( u[2] ) < 5*ut_perp/sqrt( n ) );
+
+    // A second step appends behind the particles of the first
+    Kokkos::View<float*> first( "first", n );
+    auto k_p = sp->k_p_d;
+    Kokkos::parallel_for( "copy dx", n, KOKKOS_LAMBDA( const int m ) {
+      first(m) = k_p(m, particle_var::dx);
+    });
+    apply_emitter_list( emitter_list );
+    REQUIRE( sp->np==2*n );
+    REQUIRE( capped->np==capped->max_np );
+    int changed = 0;
+    Kokkos::parallel_reduce( "compare", n, KOKKOS_LAMBDA( const int m, int & c ) {
+      if( k_p(m, particle_var::dx)!=first(m) ) c++;
+    }, changed );
+    REQUIRE( changed==0 );
+    check( sp );
+
+    std::cout << "pass" << std::endl;
+}
+
+TEST_CASE( "child langmuir emission on the device", "[emitter]" )
+{
+    int pargc = 0;
+    char str[] = "bin/vpic";
+    char **pargv = (char **) malloc(sizeof(char **));
+    pargv[0] = str;
+    boot_services( &pargc, &pargv );
+
+    SECTION("main")
+    {
+        vpic_simulation* simulation = new vpic_simulation;
+        simulation->initialize( pargc, pargv );
+        simulation->finalize();
+        delete simulation;
+        if( world_rank==0 ) log_printf( "normal exit\n" );
+
+        halt_mp();
+    }
+}
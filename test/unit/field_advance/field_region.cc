@@ -0,0 +1,110 @@
+// field_array_t::copy_to_host / copy_to_device of a field_region_t must
+// move exactly the requested components of the requested voxels through
+// the k_region_d staging view, and nothing else, in either direction.
+
+#define CATCH_CONFIG_MAIN  // This tells Catch to provide a main()
+#include "catch.hpp"
+
+#include <iostream>
+
+#include "src/vpic/vpic.h"
+
+static inline float
+device_value( int v, int c ) { return 16*v + c; }
+
+static bool
+in_region( const field_region_t & r, const grid_t * g, int v, int c ) {
+  const int x = v%g->sy, y = (v/g->sy)%(g->ny+2), z = v/g->sz;
+  return ( r.vars & (1<<c) ) && x>=r.il && x<=r.ih && y>=r.jl && y<=r.jh &&
+         z>=r.kl && z<=r.kh;
+}
+
+void vpic_simulation::user_diagnostics() {}
+
+void
+vpic_simulation::user_initialization( int num_cmdline_arguments,
+                                      char ** cmdline_argument )
+{
+    define_units( 1, 1 );
+    define_timestep( 0.5 );
+    define_periodic_grid( 0, 0, 0,   // Grid low corner
+                          6, 5, 4,   // Grid high corner
+                          6, 5, 4,   // Grid resolution
+                          1, 1, 1 ); // Processor configuration
+    define_material( "vacuum", 1.0, 1.0, 0.0 );
+    define_field_array();
+
+    field_array_t * fa = field_array;
+    const int nv = grid->nv;
+    k_field_t k_field = fa->k_f_d;
+    Kokkos::parallel_for( "fill fields", nv, KOKKOS_LAMBDA( const int v ) {
+      for( int c=0; c<FIELD_VAR_COUNT; c++ ) k_field(v, c) = 16*v + c;
+    });
+    for( int v=0; v<nv; v++ ) {
+      float * hf = (float *)( fa->f + v );
+      for( int c=0; c<FIELD_VAR_COUNT; c++ ) hf[c] = -1;
+    }
+
+    // A slab reaching into the y ghosts and the high z ghosts
+    field_region_t r = { 2, 5, 0, 3, 1, grid->nz+1,
+                         (1<<field_var::ey)|(1<<field_var::ez)|(1<<field_var::jfx) };
+
+    fa->copy_to_host( r );
+    int failed = 0;
+    for( int v=0; v<nv; v++ ) {
+      const float * hf = (const float *)( fa->f + v );
+      for( int c=0; c<FIELD_VAR_COUNT; c++ )
+        if( hf[c]!=( in_region( r, grid, v, c ) ? device_value( v, c ) : -1 ) ) failed++;
+    }
+    REQUIRE( failed==0 );
+
+    // Host changes inside and outside the region; only the inside goes back
+    for( int v=0; v<nv; v++ ) {
+      float * hf = (float *)( fa->f + v );
+      for( int c=0; c<FIELD_VAR_COUNT; c++ ) hf[c] = -2 - c;
+    }
+    fa->copy_to_device( r );
+    Kokkos::deep_copy( fa->k_f_h, fa->k_f_d );
+    for( int v=0; v<nv; v++ )
+      for( int c=0; c<FIELD_VAR_COUNT; c++ )
+        if( fa->k_f_h(v, c)!=( in_region( r, grid, v, c ) ? -2 - c : device_value( v, c ) ) ) failed++;
+    REQUIRE( failed==0 );
+
+    // A smaller region reuses the staging view, a larger one grows it
+    const float * stage = fa->k_region_d.data();
+    const size_t len = fa->k_region_d.extent(0);
+    REQUIRE( len>=size_t( 4*4*(grid->nz+1)*3 ) );
+    field_region_t small = { 1, 1, 1, 1, 1, 1, 1<<field_var::cbx };
+    fa->copy_to_host( small );
+    REQUIRE( fa->k_region_d.data()==stage );
+    field_region_t all = { 0, grid->nx+1, 0, grid->ny+1, 0, grid->nz+1, (1<<FIELD_VAR_COUNT)-1 };
+    fa->copy_to_host( all );
+    REQUIRE( fa->k_region_d.extent(0)>=size_t( nv*FIELD_VAR_COUNT ) );
+    REQUIRE( fa->k_region_d.extent(0)>len );
+    for( int v=0; v<nv; v++ )
+      for( int c=0; c<FIELD_VAR_COUNT; c++ )
+        if( ((const float *)( fa->f + v ))[c]!=fa->k_f_h(v, c) ) failed++;
+    REQUIRE( failed==0 );
+
+    std::cout << "pass" << std::endl;
+}
+
+TEST_CASE( "field region copies", "[field_advance]" )
+{
+    int pargc = 0;
+    char str[] = "bin/vpic";
+    char **pargv = (char **) malloc(sizeof(char **));
+    pargv[0] = str;
+    boot_services( &pargc, &pargv );
+
+    SECTION("main")
+    {
+        vpic_simulation* simulation = new vpic_simulation;
+        simulation->initialize( pargc, pargv );
+        simulation->finalize();
+        delete simulation;
+        if( world_rank==0 ) log_printf( "normal exit\n" );
+
+        halt_mp();
+    }
+}
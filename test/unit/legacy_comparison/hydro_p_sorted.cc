@@ -0,0 +1,145 @@
+// Compares the one pass hydro moments of several species
+// (accumulate_hydro_p_kokkos_sorted) against the per species ScatterView
+// version (accumulate_hydro_p_kokkos), before and after a push.
+
+#define CATCH_CONFIG_MAIN  // This tells Catch to provide a main()
+#include "catch.hpp"
+
+#include <cmath>
+#include <iostream>
+#include <limits>
+
+#include "src/species_advance/species_advance.h"
+#include "src/particle_operations/compress.h"
+#include "src/vpic/vpic.h"
+
+void vpic_simulation::user_diagnostics() {}
+
+void
+vpic_simulation::user_initialization( int num_cmdline_arguments,
+                                      char ** cmdline_argument )
+{
+    double L  = 8;
+    int npart = 65536;
+
+    define_units( 1, 1 );
+    define_timestep( 0.5 );
+    define_periodic_grid( 0, 0, 0,   // Grid low corner
+                          L, L, L,   // Grid high corner
+                          8, 8, 8,   // Grid resolution
+                          1, 1, 1 ); // Processor configuration
+    define_material( "vacuum", 1.0, 1.0, 0.0 );
+    define_field_array();
+
+    // Some structure in the fields so the interpolators matter
+    for( int z=1; z<=grid->nz+1; z++ )
+      for( int y=1; y<=grid->ny+1; y++ )
+        for( int x=1; x<=grid->nx+1; x++ ) {
+          field(x,y,z).ex  = 0.1*x;
+          field(x,y,z).ey  = 0.2*y;
+          field(x,y,z).ez  = 0.3*z;
+          field(x,y,z).cbx = 0.1*z;
+          field(x,y,z).cby = 0.1*x;
+          field(x,y,z).cbz = 0.1*y;
+        }
+
+    species_t * sp_list[2];
+    sp_list[0] = define_species( "electron", -1., 1., npart, npart, 0, 0 );
+    sp_list[1] = define_species( "ion", 1., 10., npart, npart, 0, 0 );
+
+    for( int s=0; s<2; s++ )
+      for (int i = 0; i < npart; i++)
+      {
+        float x = uniform( rng(0), 0, L);
+        float y = uniform( rng(0), 0, L);
+        float z = uniform( rng(0), 0, L);
+
+        // Some random relativistic momemtum
+        float px = normal( rng(0), 0, 0.5);
+        float py = normal( rng(0), 0, 1);
+        float pz = normal( rng(0), 0, 2);
+        float w = uniform( rng(0), 0.5, 2);
+        inject_particle( sp_list[s], x, y, z, px, py, pz, w, 0., 0);
+      }
+
+    field_array->copy_to_device();
+    for( int s=0; s<2; s++ ) sp_list[s]->copy_to_device();
+    load_interpolator_array( interpolator_array, field_array );
+
+    hydro_array_t * hydro_scatter = new_hydro_array( grid );
+    hydro_array_t * hydro_sorted  = new_hydro_array( grid );
+
+    ParticleCompressor<> compressor;
+    float abstol = 1e3*std::numeric_limits<float>::min();
+    float reltol = 1e-4;
+    int failed = 0;
+
+    for( int n=0; n<2; n++ ) {
+      Kokkos::deep_copy( hydro_scatter->k_h_d, 0.f );
+      Kokkos::deep_copy( hydro_sorted->k_h_d, 0.f );
+
+      for( int s=0; s<2; s++ )
+        accumulate_hydro_p_kokkos( sp_list[s]->k_p_d, sp_list[s]->k_p_i_d,
+                                   hydro_scatter->k_h_d, interpolator_array->k_i_d,
+                                   sp_list[s] );
+      accumulate_hydro_p_kokkos_sorted( hydro_sorted->k_h_d, sp_list, 2,
+                                        interpolator_array->k_i_d );
+
+      Kokkos::deep_copy( hydro_scatter->k_h_h, hydro_scatter->k_h_d );
+      Kokkos::deep_copy( hydro_sorted->k_h_h, hydro_sorted->k_h_d );
+
+      for( int i=0; i<grid->nv; i++ )
+        for( int c=0; c<HYDRO_VAR_COUNT; c++ ) {
+          double a = hydro_scatter->k_h_h(i, c);
+          double b = hydro_sorted->k_h_h(i, c);
+          double rel_err = (a-b)/a;
+          if (std::abs(rel_err) > reltol && std::abs(a)>abstol && std::abs(b)>abstol)
+          {
+              std::cout << " Failed at " << i << " component " << c
+                        << " with relative error " << rel_err
+                        << " from hydro scatter and hydro sorted " << a << " " << b << std::endl;
+              failed++;
+          }
+        }
+
+      // Move the particles so the offsets built above no longer match
+      for( int s=0; s<2; s++ ) {
+        species_t * sp = sp_list[s];
+        advance_p( sp, interpolator_array, field_array );
+        const int nm = sp->k_nm_h(0);
+        compressor.compress( sp->k_p_d, sp->k_p_i_d, sp->k_pm_i_d, nm, sp->np, sp );
+        sp->np -= nm;
+      }
+    }
+
+    delete_hydro_array( hydro_scatter );
+    delete_hydro_array( hydro_sorted );
+
+    if( failed )
+    {  std::cout << "FAIL" << std::endl;
+    }
+    REQUIRE_FALSE(failed);
+
+    std::cout << "pass" << std::endl;
+}
+
+TEST_CASE( "sorted hydro_p matches the scatter hydro_p", "[hydro_p]" ) {
+
+    int pargc = 0;
+    char str[] = "bin/vpic";
+    char **pargv = (char **) malloc(sizeof(char **));
+    pargv[0] = str;
+    boot_services( &pargc, &pargv );
+
+    SECTION( "sorted hydro moments" )
+    {
+        vpic_simulation* simulation = new vpic_simulation;
+        simulation->initialize( pargc, pargv );
+
+        simulation->finalize();
+        delete simulation;
+        if( world_rank==0 ) log_printf( "normal exit\n" );
+
+        halt_mp();
+    }
+}
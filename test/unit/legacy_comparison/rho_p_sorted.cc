@@ -0,0 +1,153 @@
+// Compares the one pass charge deposit of several species
+// (k_accumulate_rho_p_sorted, with and without deterministic) against the
+// per species ScatterView deposit (k_accumulate_rho_p). The comparison is
+// repeated after a push, which moves the particles under any partition
+// left behind by the first deposit.
+
+#define CATCH_CONFIG_MAIN  // This tells Catch to provide a main()
+#include "catch.hpp"
+
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+#include "src/species_advance/species_advance.h"
+#include "src/particle_operations/compress.h"
+#include "src/vpic/vpic.h"
+
+// rhof of every voxel after depositing sp_list with the given method
+// (-1 for k_accumulate_rho_p, otherwise the deterministic flag of
+// k_accumulate_rho_p_sorted)
+static std::vector<float>
+deposit( field_array_t * fa,
+         species_t ** sp_list,
+         int n_species,
+         int method ) {
+  Kokkos::deep_copy( Kokkos::subview( fa->k_f_d, Kokkos::ALL, (int)field_var::rhof ), 0.f );
+  if( method<0 ) {
+    for( int s=0; s<n_species; s++ ) k_accumulate_rho_p( fa, sp_list[s] );
+  } else {
+    k_accumulate_rho_p_sorted( fa, sp_list, n_species, method );
+  }
+  Kokkos::deep_copy( fa->k_f_h, fa->k_f_d );
+  std::vector<float> rho( fa->g->nv );
+  for( int i=0; i<fa->g->nv; i++ ) rho[i] = fa->k_f_h(i, field_var::rhof);
+  return rho;
+}
+
+static int
+compare( const std::vector<float> & a,
+         const std::vector<float> & b,
+         const char * what ) {
+    // The sums are done in a different order, so allow for rounding
+    float abstol = 1e3*std::numeric_limits<float>::min();
+    float reltol = 1e-4;
+    int failed = 0;
+    for( size_t i=0; i<a.size(); i++ ) {
+        double rel_err = (a[i]-b[i])/a[i];
+        if (std::abs(rel_err) > reltol && std::abs(a[i])>abstol && std::abs(b[i])>abstol)
+        {
+            std::cout << " Failed at " << i << " with relative error " << rel_err
+                      << " from " << what << " " << a[i] << " " << b[i] << std::endl;
+            failed++;
+        }
+    }
+    return failed;
+}
+
+void vpic_simulation::user_diagnostics() {}
+
+void
+vpic_simulation::user_initialization( int num_cmdline_arguments,
+                                      char ** cmdline_argument )
+{
+    double L  = 8;
+    int npart = 65536;
+
+    define_units( 1, 1 );
+    define_timestep( 0.5 );
+    define_periodic_grid( 0, 0, 0,   // Grid low corner
+                          L, L, L,   // Grid high corner
+                          8, 8, 8,   // Grid resolution
+                          1, 1, 1 ); // Processor configuration
+    define_material( "vacuum", 1.0, 1.0, 0.0 );
+    define_field_array();
+
+    // Different charges and weights so each species' charge is checked
+    species_t * sp_list[3];
+    sp_list[0] = define_species( "electron", -1., 1., npart, npart, 0, 0 );
+    sp_list[1] = define_species( "ion", 1., 10., npart, npart, 0, 0 );
+    sp_list[2] = define_species( "alpha", 2., 40., npart, npart, 0, 0 );
+
+    for( int s=0; s<3; s++ )
+      for (int i = 0; i < npart; i++)
+      {
+        float x = uniform( rng(0), 0, L);
+        float y = uniform( rng(0), 0, L);
+        float z = uniform( rng(0), 0, L);
+        float ux = uniform( rng(0), -1, 1);
+        float uy = uniform( rng(0), -1, 1);
+        float uz = uniform( rng(0), -1, 1);
+        float w = uniform( rng(0), 0.5, 2);
+        inject_particle( sp_list[s], x, y, z, ux, uy, uz, w, 0., 0);
+      }
+
+    field_array->copy_to_device();
+    for( int s=0; s<3; s++ ) sp_list[s]->copy_to_device();
+
+    ParticleCompressor<> compressor;
+    int failed = 0;
+
+    for( int n=0; n<2; n++ ) {
+      const std::vector<float> ref = deposit( field_array, sp_list, 3, -1 );
+      const std::vector<float> sorted = deposit( field_array, sp_list, 3, 0 );
+      const std::vector<float> det = deposit( field_array, sp_list, 3, 1 );
+      const std::vector<float> det2 = deposit( field_array, sp_list, 3, 1 );
+
+      failed += compare( ref, sorted, "scatter and sorted" );
+      failed += compare( ref, det, "scatter and deterministic" );
+
+      // Same particle order, so the deterministic deposit must repeat
+      // exactly
+      for( int i=0; i<grid->nv; i++ ) if( det[i]!=det2[i] ) failed++;
+
+      // Move the particles (and drop the ones leaving the domain) so the
+      // offsets built above no longer match
+      for( int s=0; s<3; s++ ) {
+        species_t * sp = sp_list[s];
+        advance_p( sp, interpolator_array, field_array );
+        const int nm = sp->k_nm_h(0);
+        compressor.compress( sp->k_p_d, sp->k_p_i_d, sp->k_pm_i_d, nm, sp->np, sp );
+        sp->np -= nm;
+      }
+    }
+
+    if( failed )
+    {  std::cout << "FAIL" << std::endl;
+    }
+    REQUIRE_FALSE(failed);
+
+    std::cout << "pass" << std::endl;
+}
+
+TEST_CASE( "sorted rho_p matches the scatter rho_p", "[rho_p]" ) {
+
+    int pargc = 0;
+    char str[] = "bin/vpic";
+    char **pargv = (char **) malloc(sizeof(char **));
+    pargv[0] = str;
+    boot_services( &pargc, &pargv );
+
+    SECTION( "sorted and deterministic deposits" )
+    {
+        vpic_simulation* simulation = new vpic_simulation;
+        simulation->initialize( pargc, pargv );
+
+        simulation->finalize();
+        delete simulation;
+        if( world_rank==0 ) log_printf( "normal exit\n" );
+
+        halt_mp();
+    }
+}
@@ -0,0 +1,46 @@
+#ifndef TEST_CELL_TABLE_H
+#define TEST_CELL_TABLE_H
+
+// Shared check for the tests of the cell table kept by the incremental
+// sort (see species_t::k_partition_d)
+
+#include <vector>
+
+#include "src/species_advance/species_advance.h"
+
+// Number of slots, counts or particles that do not agree with the cell
+// table of sp: every particle has to be listed exactly once, in a slot of
+// its own voxel, and every other slot has to be unused
+static int
+cell_table_errors( species_t * sp ) {
+  auto partition = Kokkos::create_mirror_view_and_copy( Kokkos::HostSpace(),
+                                                        sp->k_partition_d );
+  auto slot = Kokkos::create_mirror_view_and_copy( Kokkos::HostSpace(),
+                                                   sp->k_cell_slot_d );
+  auto count = Kokkos::create_mirror_view_and_copy( Kokkos::HostSpace(),
+                                                    sp->k_cell_count_d );
+  Kokkos::deep_copy( sp->k_p_i_h, sp->k_p_i_d );
+  const int nv = sp->g->nv;
+  std::vector<int> listed( sp->np, 0 );
+  int failed = 0;
+  if( partition(0)!=0 ) failed++;
+  for( int v=0; v<nv; v++ ) {
+    if( partition(v)>partition(v+1) || partition(v+1)>(int)slot.extent(0) ) {
+      failed++;
+      continue;
+    }
+    int n = 0;
+    for( int k=partition(v); k<partition(v+1); k++ ) {
+      const int i = slot(k);
+      if( i<0 ) continue;
+      if( i>=sp->np || sp->k_p_i_h(i)!=v ) failed++;
+      else listed[i]++;
+      n++;
+    }
+    if( n!=count(v) ) failed++;
+  }
+  for( int i=0; i<sp->np; i++ ) if( listed[i]!=1 ) failed++;
+  return failed;
+}
+
+#endif // TEST_CELL_TABLE_H
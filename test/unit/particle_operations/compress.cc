@@ -0,0 +1,121 @@
+// Compares FusedCompress, which uses the tail flags advance_p leaves
+// behind, against DefaultCompress on two species holding the same
+// particles. The two may backfill in a different order, so the surviving
+// particles are compared as sets.
+
+#define CATCH_CONFIG_MAIN  // This tells Catch to provide a main()
+#include "catch.hpp"
+
+#include <algorithm>
+#include <array>
+#include <iostream>
+#include <vector>
+
+#include "src/species_advance/species_advance.h"
+#include "src/particle_operations/compress.h"
+#include "src/vpic/vpic.h"
+
+typedef std::array<float, PARTICLE_VAR_COUNT+1> particle_record_t;
+
+// The particles of sp in a canonical order
+static std::vector<particle_record_t>
+particle_set( species_t * sp ) {
+  Kokkos::deep_copy( sp->k_p_h, sp->k_p_d );
+  Kokkos::deep_copy( sp->k_p_i_h, sp->k_p_i_d );
+  std::vector<particle_record_t> set( sp->np );
+  for( int i=0; i<sp->np; i++ ) {
+    set[i][0] = (float)sp->k_p_i_h(i);
+    for( int v=0; v<PARTICLE_VAR_COUNT; v++ ) set[i][v+1] = sp->k_p_h(i, v);
+  }
+  std::sort( set.begin(), set.end() );
+  return set;
+}
+
+void vpic_simulation::user_diagnostics() {}
+
+void
+vpic_simulation::user_initialization( int num_cmdline_arguments,
+                                      char ** cmdline_argument )
+{
+    double L  = 8;
+    int npart = 16384;
+    int nstep = 8;
+
+    define_units( 1, 1 );
+    define_timestep( 0.5 );
+    define_periodic_grid( 0, 0, 0,   // Grid low corner
+                          L, L, L,   // Grid high corner
+                          8, 8, 8,   // Grid resolution
+                          1, 1, 1 ); // Processor configuration
+    define_material( "vacuum", 1.0, 1.0, 0.0 );
+    define_field_array();
+
+    species_t * sp  = define_species( "fused", 1., 1., npart, npart, 0, 0 );
+    species_t * sp2 = define_species( "default", 1., 1., npart, npart, 0, 0 );
+
+    for (int i = 0; i < npart; i++)
+    {
+        float x = uniform( rng(0), 0, L);
+        float y = uniform( rng(0), 0, L);
+        float z = uniform( rng(0), 0, L);
+        float ux = uniform( rng(0), -1, 1);
+        float uy = uniform( rng(0), -1, 1);
+        float uz = uniform( rng(0), -1, 1);
+
+        // Put two sets of particle in the exact same space
+        inject_particle( sp , x, y, z, ux, uy, uz, 1., 0., 0);
+        inject_particle( sp2, x, y, z, ux, uy, uz, 1., 0., 0);
+    }
+
+    field_array->copy_to_device();
+    sp->copy_to_device();
+    sp2->copy_to_device();
+
+    ParticleCompressor<FusedCompress> fused;
+    ParticleCompressor<DefaultCompress> reference;
+    int n_moved = 0;
+
+    for( int n=0; n<nstep; n++ ) {
+      advance_p( sp , interpolator_array, field_array );
+      advance_p( sp2, interpolator_array, field_array );
+
+      const int nm = sp->k_nm_h(0);
+      REQUIRE( sp2->k_nm_h(0)==nm );
+      n_moved += nm;
+
+      fused.compress( sp->k_p_d, sp->k_p_i_d, sp->k_pm_i_d, nm, sp->np, sp );
+      reference.compress( sp2->k_p_d, sp2->k_p_i_d, sp2->k_pm_i_d, nm, sp2->np, sp2 );
+      sp->np  -= nm;
+      sp2->np -= nm;
+
+      // The fused compress must have used (and cleared) the tail flags
+      REQUIRE( sp->tail_hole_nm==0 );
+      REQUIRE( particle_set( sp )==particle_set( sp2 ) );
+    }
+
+    // Make sure the movers actually exercised the backfill
+    REQUIRE( n_moved>0 );
+
+    std::cout << "pass" << std::endl;
+}
+
+TEST_CASE( "fused compress matches the default compress", "[compress]" ) {
+
+    int pargc = 0;
+    char str[] = "bin/vpic";
+    char **pargv = (char **) malloc(sizeof(char **));
+    pargv[0] = str;
+    boot_services( &pargc, &pargv );
+
+    SECTION( "compress after advance_p" )
+    {
+        vpic_simulation* simulation = new vpic_simulation;
+        simulation->initialize( pargc, pargv );
+
+        simulation->finalize();
+        delete simulation;
+        if( world_rank==0 ) log_printf( "normal exit\n" );
+
+        halt_mp();
+    }
+}
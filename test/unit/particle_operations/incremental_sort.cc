@@ -0,0 +1,181 @@
+// Checks that the incremental sort patches its cell table instead of
+// reordering the particles: a particle changing voxel (however far) is
+// only listed again, the voxel offsets are kept, and the particles are
+// only sorted again once a voxel runs out of spare slots.
+
+#define CATCH_CONFIG_MAIN  // This tells Catch to provide a main()
+#include "catch.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+#include "src/species_advance/species_advance.h"
+#include "src/particle_operations/compress.h"
+#include "src/particle_operations/sort.h"
+#include "src/vpic/vpic.h"
+#include "cell_table.h"
+
+// The particle array of sp as stored, to see whether anything moved
+static std::vector<float>
+particle_data( species_t * sp ) {
+  Kokkos::deep_copy( sp->k_p_h, sp->k_p_d );
+  Kokkos::deep_copy( sp->k_p_i_h, sp->k_p_i_d );
+  std::vector<float> data;
+  for( int i=0; i<sp->np; i++ ) {
+    data.push_back( (float)sp->k_p_i_h(i) );
+    for( int v=0; v<PARTICLE_VAR_COUNT; v++ ) data.push_back( sp->k_p_h(i, v) );
+  }
+  return data;
+}
+
+static std::vector<int>
+cell_offsets( species_t * sp ) {
+  auto partition = Kokkos::create_mirror_view_and_copy( Kokkos::HostSpace(),
+                                                        sp->k_partition_d );
+  return std::vector<int>( partition.data(), partition.data()+partition.extent(0) );
+}
+
+static bool
+sorted_by_voxel( species_t * sp ) {
+  Kokkos::deep_copy( sp->k_p_i_h, sp->k_p_i_d );
+  for( int i=1; i<sp->np; i++ ) if( sp->k_p_i_h(i)<sp->k_p_i_h(i-1) ) return false;
+  return true;
+}
+
+// Move particle i of sp to voxel v (on the host copy, which is then
+// pushed back to the device)
+static void
+move_to_voxel( species_t * sp,
+               int i,
+               int v ) {
+  Kokkos::deep_copy( sp->k_p_i_h, sp->k_p_i_d );
+  sp->k_p_i_h(i) = v;
+  Kokkos::deep_copy( sp->k_p_i_d, sp->k_p_i_h );
+  sp->invalidate_partition();
+}
+
+void vpic_simulation::user_diagnostics() {}
+
+void
+vpic_simulation::user_initialization( int num_cmdline_arguments,
+                                      char ** cmdline_argument )
+{
+    double L  = 8;
+    int npart = 32768;
+
+    define_units( 1, 1 );
+    define_timestep( 0.5 );
+    define_periodic_grid( 0, 0, 0,   // Grid low corner
+                          L, L, L,   // Grid high corner
+                          8, 8, 8,   // Grid resolution
+                          1, 1, 1 ); // Processor configuration
+    define_material( "vacuum", 1.0, 1.0, 0.0 );
+    define_field_array();
+
+    species_t * sp = define_species( "test_species", 1., 1., npart+64, npart, 0, 0,
+                                     sort_strategy::incremental );
+
+    for (int i = 0; i < npart; i++)
+    {
+        float x = uniform( rng(0), 0, L);
+        float y = uniform( rng(0), 0, L);
+        float z = uniform( rng(0), 0, L);
+        float ux = uniform( rng(0), -1, 1);
+        float uy = uniform( rng(0), -1, 1);
+        float uz = uniform( rng(0), -1, 1);
+        inject_particle( sp, x, y, z, ux, uy, uz, 1., 0., 0);
+    }
+
+    field_array->copy_to_device();
+    sp->copy_to_device();
+
+    ParticleSorter<> sorter;
+    const int nv = grid->nv;
+
+    // The first sort has no table to patch, so it sorts the particles
+    sorter.sort( sp, sort_strategy::incremental, nv );
+    REQUIRE( cell_table_errors( sp )==0 );
+    REQUIRE( sorted_by_voxel( sp ) );
+    const std::vector<int> offsets = cell_offsets( sp );
+
+    // Send the first particle (lowest voxel) to the voxel of the last one.
+    // Only its entry in the table changes; the particles stay put and so
+    // do the offsets of every voxel in between.
+    Kokkos::deep_copy( sp->k_p_i_h, sp->k_p_i_d );
+    const int v_low = sp->k_p_i_h(0), v_high = sp->k_p_i_h(sp->np-1);
+    REQUIRE( v_low<v_high );
+    move_to_voxel( sp, 0, v_high );
+    const std::vector<float> moved = particle_data( sp );
+    sorter.partition( sp, nv );
+    REQUIRE( cell_table_errors( sp )==0 );
+    REQUIRE( particle_data( sp )==moved );
+    REQUIRE( cell_offsets( sp )==offsets );
+
+    // And back again, into the slot it left or a spare one
+    move_to_voxel( sp, 0, v_low );
+    sorter.partition( sp, nv );
+    REQUIRE( cell_table_errors( sp )==0 );
+    REQUIRE( cell_offsets( sp )==offsets );
+
+    // Pushes move particles between neighbouring voxels and the compress
+    // backfills the ones that left from the end of the array
+    ParticleCompressor<> compressor;
+    for( int n=0; n<4; n++ ) {
+      advance_p( sp, interpolator_array, field_array );
+      const int nm = sp->k_nm_h(0);
+      compressor.compress( sp->k_p_d, sp->k_p_i_d, sp->k_pm_i_d, nm, sp->np, sp );
+      sp->np -= nm;
+      sorter.partition( sp, nv );
+      REQUIRE( cell_table_errors( sp )==0 );
+    }
+
+    // Particles appended at the end (as injection and the boundary
+    // exchange do) are listed too
+    Kokkos::deep_copy( sp->k_p_h, sp->k_p_d );
+    Kokkos::deep_copy( sp->k_p_i_h, sp->k_p_i_d );
+    for( int j=0; j<32; j++ ) {
+      for( int v=0; v<PARTICLE_VAR_COUNT; v++ ) sp->k_p_h(sp->np+j, v) = sp->k_p_h(j, v);
+      sp->k_p_i_h(sp->np+j) = sp->k_p_i_h(j);
+    }
+    sp->np += 32;
+    Kokkos::deep_copy( sp->k_p_d, sp->k_p_h );
+    Kokkos::deep_copy( sp->k_p_i_d, sp->k_p_i_h );
+    sp->invalidate_partition();
+    sorter.partition( sp, nv );
+    REQUIRE( cell_table_errors( sp )==0 );
+
+    // Crowding one voxel past its spare slots falls back to a full sort
+    Kokkos::deep_copy( sp->k_p_i_h, sp->k_p_i_d );
+    const int v_crowd = sp->k_p_i_h(0);
+    const int n_crowd = npart/nv/SORT_SLACK_DIVISOR + 8*SORT_SLACK_MIN + 64;
+    for( int j=0; j<n_crowd; j++ ) sp->k_p_i_h(sp->np-1-j) = v_crowd;
+    Kokkos::deep_copy( sp->k_p_i_d, sp->k_p_i_h );
+    sp->invalidate_partition();
+    sorter.partition( sp, nv );
+    REQUIRE( cell_table_errors( sp )==0 );
+    REQUIRE( sorted_by_voxel( sp ) );
+
+    std::cout << "pass" << std::endl;
+}
+
+TEST_CASE( "incremental sort patches its cell table", "[sort]" ) {
+
+    int pargc = 0;
+    char str[] = "bin/vpic";
+    char **pargv = (char **) malloc(sizeof(char **));
+    pargv[0] = str;
+    boot_services( &pargc, &pargv );
+
+    SECTION( "incremental sort" )
+    {
+        vpic_simulation* simulation = new vpic_simulation;
+        simulation->initialize( pargc, pargv );
+
+        simulation->finalize();
+        delete simulation;
+        if( world_rank==0 ) log_printf( "normal exit\n" );
+
+        halt_mp();
+    }
+}
@@ -0,0 +1,174 @@
+// Batched device injection (vpic_simulation::inject_particles) against the
+// host inject_particle_raw. New particle k must land at np+k, be aged by
+// its displacement, deposit the same bound charge and leave a mover for
+// each particle that reaches the absorbing domain boundary. When the
+// movers run out the remaining particles are not aged, but every mover
+// that was handed out must still describe its particle.
+
+#define CATCH_CONFIG_MAIN  // This tells Catch to provide a main()
+#include "catch.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include "src/species_advance/species_advance.h"
+#include "src/vpic/vpic.h"
+
+// Particles on the low x face, each displaced out of the domain
+struct face_crossing_t {
+  int nx, ny;
+  KOKKOS_INLINE_FUNCTION void
+  operator()( const int k, particle_injector_t & p ) const {
+    p.dx = -0.9; p.dy = 0; p.dz = 0;
+    p.i  = VOXEL( 1, 1 + k%ny, 1 + (k/ny)%ny, nx, ny, ny );
+    p.ux = p.uy = p.uz = 0;
+    p.w  = k;
+    p.dispx = -0.5;
+  }
+};
+
+static bool
+close_enough( float a,
+              float b ) {
+  return std::fabs( a-b ) <= 1e-5*( 1 + std::fabs( b ) );
+}
+
+void vpic_simulation::user_diagnostics() {}
+
+void
+vpic_simulation::user_initialization( int num_cmdline_arguments,
+                                      char ** cmdline_argument )
+{
+    double L = 8;
+    int npart = 1024, ninject = 512;
+
+    define_units( 1, 1 );
+    define_timestep( 0.5 );
+    define_absorbing_grid( 0, 0, 0,    // Grid low corner
+                           L, L, L,    // Grid high corner
+                           8, 8, 8,    // Grid resolution
+                           1, 1, 1,    // Processor configuration
+                           absorb_particles );
+    define_material( "vacuum", 1.0, 1.0, 0.0 );
+    define_field_array();
+
+    species_t * aged = define_species( "aged", -1., 1., npart+ninject, ninject, 0, 0 );
+    species_t * crowded = define_species( "crowded", 1., 1., 64, 4, 0, 0 );
+
+    for( int i=0; i<npart; i++ )
+      inject_particle( aged, uniform( rng(0), 0, L ), uniform( rng(0), 0, L ),
+                       uniform( rng(0), 0, L ), uniform( rng(0), -1, 1 ),
+                       uniform( rng(0), -1, 1 ), uniform( rng(0), -1, 1 ), 1., 0., 0 );
+    field_array->copy_to_device();
+    aged->copy_to_device();
+    crowded->copy_to_device();
+    const int np0 = aged->np;
+
+    // Crowded: 64 particles want a mover, only 4 exist
+    inject_particles( crowded, 64, face_crossing_t{ grid->nx, grid->ny }, 0 );
+    REQUIRE( crowded->np==64 );
+    REQUIRE( crowded->nm==crowded->max_nm );
+    {
+      auto p   = Kokkos::create_mirror_view_and_copy( Kokkos::HostSpace(), crowded->k_p_d );
+      auto pc  = Kokkos::create_mirror_view_and_copy( Kokkos::HostSpace(), crowded->k_pc_d );
+      auto pmi = Kokkos::create_mirror_view_and_copy( Kokkos::HostSpace(), crowded->k_pm_i_d );
+      std::vector<int> slots;
+      for( int m=0; m<crowded->nm; m++ ) {
+        slots.push_back( pmi(m) );
+        REQUIRE( pmi(m)>=0 );
+        REQUIRE( pmi(m)<64 );
+        for( int v=0; v<PARTICLE_VAR_COUNT; v++ ) REQUIRE( pc(m, v)==p(pmi(m), v) );
+      }
+      std::sort( slots.begin(), slots.end() );
+      REQUIRE( std::unique( slots.begin(), slots.end() )==slots.end() );
+      for( int k=0; k<64; k++ ) REQUIRE( p(k, particle_var::w)==k );
+    }
+
+    // Without update_rhob no bound charge was deposited
+    Kokkos::deep_copy( field_array->k_f_h, field_array->k_f_d );
+    for( int v=0; v<grid->nv; v++ ) REQUIRE( field_array->k_f_h(v, field_var::rhob)==0 );
+
+    // Aged: random particles and displacements, a quarter not displaced
+    std::vector<particle_injector_t> pi( ninject );
+    for( int k=0; k<ninject; k++ ) {
+      particle_injector_t & p = pi[k];
+      p.dx = uniform( rng(0), -1, 1 );
+      p.dy = uniform( rng(0), -1, 1 );
+      p.dz = uniform( rng(0), -1, 1 );
+      p.i  = VOXEL( 1 + k%8, 1 + (k/8)%8, 1 + (k/64)%8, grid->nx, grid->ny, grid->nz );
+      p.ux = uniform( rng(0), -1, 1 );
+      p.uy = uniform( rng(0), -1, 1 );
+      p.uz = uniform( rng(0), -1, 1 );
+      p.w  = 1 + k;
+      const float s = k%4 ? 1.5 : 0;
+      p.dispx = s*uniform( rng(0), -1, 1 );
+      p.dispy = s*uniform( rng(0), -1, 1 );
+      p.dispz = s*uniform( rng(0), -1, 1 );
+    }
+    inject_particles( aged, pi.data(), ninject );
+    REQUIRE( aged->np==np0+ninject );
+    const int nm = aged->nm;
+    REQUIRE( nm>0 ); // Some reached the boundary
+
+    // Host reference on the host copy of the particles
+    aged->np = np0;
+    aged->nm = 0;
+    for( int k=0; k<ninject; k++ ) {
+      const particle_injector_t & p = pi[k];
+      inject_particle_raw( aged, p.dx, p.dy, p.dz, p.i, p.ux, p.uy, p.uz, p.w,
+                           p.dispx, p.dispy, p.dispz, 1 );
+    }
+    REQUIRE( aged->nm==nm );
+
+    auto k_p   = Kokkos::create_mirror_view_and_copy( Kokkos::HostSpace(), aged->k_p_d );
+    auto k_p_i = Kokkos::create_mirror_view_and_copy( Kokkos::HostSpace(), aged->k_p_i_d );
+    int failed = 0;
+    for( int n=0; n<aged->np; n++ ) {
+      const particle_t & p = aged->p[n];
+      if( k_p_i(n)!=p.i || k_p(n, particle_var::w)!=p.w ||
+          k_p(n, particle_var::ux)!=p.ux || k_p(n, particle_var::uy)!=p.uy ||
+          k_p(n, particle_var::uz)!=p.uz ||
+          !close_enough( k_p(n, particle_var::dx), p.dx ) ||
+          !close_enough( k_p(n, particle_var::dy), p.dy ) ||
+          !close_enough( k_p(n, particle_var::dz), p.dz ) ) failed++;
+    }
+    REQUIRE_FALSE( failed );
+
+    // The same particles were handed to the boundary exchange
+    auto pmi = Kokkos::create_mirror_view_and_copy( Kokkos::HostSpace(), aged->k_pm_i_d );
+    std::vector<int> device_movers( pmi.data(), pmi.data()+nm ), host_movers;
+    for( int m=0; m<nm; m++ ) host_movers.push_back( aged->pm[m].i );
+    std::sort( device_movers.begin(), device_movers.end() );
+    std::sort( host_movers.begin(), host_movers.end() );
+    REQUIRE( device_movers==host_movers );
+    REQUIRE( device_movers.front()>=np0 );
+
+    Kokkos::deep_copy( field_array->k_f_h, field_array->k_f_d );
+    for( int v=0; v<grid->nv; v++ )
+      if( !close_enough( field_array->k_f_h(v, field_var::rhob), field_array->f[v].rhob ) ) failed++;
+    REQUIRE_FALSE( failed );
+
+    std::cout << "pass" << std::endl;
+}
+
+TEST_CASE( "batched device injection", "[injection]" )
+{
+    int pargc = 0;
+    char str[] = "bin/vpic";
+    char **pargv = (char **) malloc(sizeof(char **));
+    pargv[0] = str;
+    boot_services( &pargc, &pargv );
+
+    SECTION("main")
+    {
+        vpic_simulation* simulation = new vpic_simulation;
+        simulation->initialize( pargc, pargv );
+        simulation->finalize();
+        delete simulation;
+        if( world_rank==0 ) log_printf( "normal exit\n" );
+
+        halt_mp();
+    }
+}
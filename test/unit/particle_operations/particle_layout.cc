@@ -0,0 +1,128 @@
+// Runs the sorts and the particle dump on k_particles_t in the layout the
+// library was configured with (VPIC_PARTICLE_LAYOUT; CI builds both). The
+// AoS sorts move whole rows instead of one variable at a time, so every
+// strategy must keep each particle's variables together, and the dump
+// must write the particles as they are stored.
+
+#define CATCH_CONFIG_MAIN  // This tells Catch to provide a main()
+#include "catch.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <vector>
+
+#include "src/species_advance/species_advance.h"
+#include "src/particle_operations/sort.h"
+#include "src/vpic/vpic.h"
+
+typedef std::array<float, PARTICLE_VAR_COUNT+1> particle_record_t;
+
+// The particles of sp in storage order, voxel first
+static std::vector<particle_record_t>
+particle_list( species_t * sp ) {
+  Kokkos::deep_copy( sp->k_p_h, sp->k_p_d );
+  Kokkos::deep_copy( sp->k_p_i_h, sp->k_p_i_d );
+  std::vector<particle_record_t> list( sp->np );
+  for( int i=0; i<sp->np; i++ ) {
+    list[i][0] = (float)sp->k_p_i_h(i);
+    for( int v=0; v<PARTICLE_VAR_COUNT; v++ ) list[i][v+1] = sp->k_p_h(i, v);
+  }
+  return list;
+}
+
+void vpic_simulation::user_diagnostics() {}
+
+void
+vpic_simulation::user_initialization( int num_cmdline_arguments,
+                                      char ** cmdline_argument )
+{
+    double L  = 8;
+    int npart = 8192;
+
+    define_units( 1, 1 );
+    define_timestep( 0.5 );
+    define_periodic_grid( 0, 0, 0,   // Grid low corner
+                          L, L, L,   // Grid high corner
+                          8, 8, 8,   // Grid resolution
+                          1, 1, 1 ); // Processor configuration
+    define_material( "vacuum", 1.0, 1.0, 0.0 );
+    define_field_array();
+
+    species_t * sp = define_species( "test_species", 1., 1., npart, npart, 0, 0 );
+
+    // The weight tags each particle, so that a row torn apart by a sort
+    // no longer matches any particle
+    for( int i=0; i<npart; i++ )
+      inject_particle( sp, uniform( rng(0), 0, L ), uniform( rng(0), 0, L ),
+                       uniform( rng(0), 0, L ), uniform( rng(0), -1, 1 ),
+                       uniform( rng(0), -1, 1 ), uniform( rng(0), -1, 1 ), 1. + i, 0., 0 );
+    field_array->copy_to_device();
+    sp->copy_to_device();
+
+#if defined(VPIC_PARTICLE_LAYOUT_AOS)
+    REQUIRE( !k_particles_soa );
+    REQUIRE( sp->k_p_d.stride_1()==1 );
+#else
+    REQUIRE( k_particles_soa );
+    REQUIRE( sp->k_p_d.stride_0()==1 );
+#endif
+
+    std::vector<particle_record_t> reference = particle_list( sp );
+    std::sort( reference.begin(), reference.end() );
+
+    ParticleSorter<> sorter;
+    for( int s=sort_strategy::standard; s<sort_strategy::count; s++ ) {
+      sorter.sort( sp, s, grid->nv );
+      std::vector<particle_record_t> list = particle_list( sp );
+      if( s==sort_strategy::standard || s==sort_strategy::incremental )
+        for( int i=1; i<sp->np; i++ ) REQUIRE( list[i-1][0]<=list[i][0] );
+      std::sort( list.begin(), list.end() );
+      REQUIRE( list==reference );
+    }
+
+    // With no fields the dump writes the particles unchanged, in order
+    load_interpolator_array( interpolator_array, field_array );
+    dump_particles( "test_species", "layout", 0 );
+    std::ifstream in( "layout.0", std::ios::binary );
+    std::vector<char> file( (std::istreambuf_iterator<char>( in )),
+                            std::istreambuf_iterator<char>() );
+    REQUIRE( file.size()>sp->np*sizeof(particle_t) );
+    const particle_t * p = (const particle_t *)( file.data() + file.size() -
+                                                 sp->np*sizeof(particle_t) );
+    const std::vector<particle_record_t> stored = particle_list( sp );
+    int failed = 0;
+    for( int i=0; i<sp->np; i++ ) {
+      const particle_record_t & r = stored[i];
+      if( p[i].i!=(int)r[0] || p[i].dx!=r[1+particle_var::dx] ||
+          p[i].dy!=r[1+particle_var::dy] || p[i].dz!=r[1+particle_var::dz] ||
+          p[i].ux!=r[1+particle_var::ux] || p[i].uy!=r[1+particle_var::uy] ||
+          p[i].uz!=r[1+particle_var::uz] || p[i].w!=r[1+particle_var::w] ) failed++;
+    }
+    REQUIRE( failed==0 );
+
+    std::cout << "pass" << std::endl;
+}
+
+TEST_CASE( "sorts and dumps in the configured particle layout", "[layout]" )
+{
+    int pargc = 0;
+    char str[] = "bin/vpic";
+    char **pargv = (char **) malloc(sizeof(char **));
+    pargv[0] = str;
+    boot_services( &pargc, &pargv );
+
+    SECTION("main")
+    {
+        vpic_simulation* simulation = new vpic_simulation;
+        simulation->initialize( pargc, pargv );
+        simulation->finalize();
+        delete simulation;
+        if( world_rank==0 ) log_printf( "normal exit\n" );
+
+        halt_mp();
+    }
+}
@@ -0,0 +1,141 @@
+// Checks the incremental sort and ParticleSorter::partition: the cell
+// table must match the particles right after it is built, and must be
+// brought up to date once anything has moved or reordered the particles.
+
+#define CATCH_CONFIG_MAIN  // This tells Catch to provide a main()
+#include "catch.hpp"
+
+#include <algorithm>
+#include <array>
+#include <iostream>
+#include <vector>
+
+#include "src/species_advance/species_advance.h"
+#include "src/particle_operations/compress.h"
+#include "src/particle_operations/sort.h"
+#include "src/vpic/vpic.h"
+#include "cell_table.h"
+
+typedef std::array<float, PARTICLE_VAR_COUNT+1> particle_record_t;
+
+// The particles of sp in a canonical order, so that the same particles
+// compare equal whatever order they are stored in
+static std::vector<particle_record_t>
+particle_set( species_t * sp ) {
+  Kokkos::deep_copy( sp->k_p_h, sp->k_p_d );
+  Kokkos::deep_copy( sp->k_p_i_h, sp->k_p_i_d );
+  std::vector<particle_record_t> set( sp->np );
+  for( int i=0; i<sp->np; i++ ) {
+    set[i][0] = (float)sp->k_p_i_h(i);
+    for( int v=0; v<PARTICLE_VAR_COUNT; v++ ) set[i][v+1] = sp->k_p_h(i, v);
+  }
+  std::sort( set.begin(), set.end() );
+  return set;
+}
+
+void vpic_simulation::user_diagnostics() {}
+
+void
+vpic_simulation::user_initialization( int num_cmdline_arguments,
+                                      char ** cmdline_argument )
+{
+    double L  = 8;
+    int npart = 16384;
+
+    define_units( 1, 1 );
+    define_timestep( 0.5 );
+    define_periodic_grid( 0, 0, 0,   // Grid low corner
+                          L, L, L,   // Grid high corner
+                          8, 8, 8,   // Grid resolution
+                          1, 1, 1 ); // Processor configuration
+    define_material( "vacuum", 1.0, 1.0, 0.0 );
+    define_field_array();
+
+    species_t * sp = define_species( "test_species", 1., 1., npart, npart, 0, 0,
+                                     sort_strategy::incremental );
+
+    for (int i = 0; i < npart; i++)
+    {
+        float x = uniform( rng(0), 0, L);
+        float y = uniform( rng(0), 0, L);
+        float z = uniform( rng(0), 0, L);
+        float ux = uniform( rng(0), -1, 1);
+        float uy = uniform( rng(0), -1, 1);
+        float uz = uniform( rng(0), -1, 1);
+        inject_particle( sp, x, y, z, ux, uy, uz, 1., 0., 0);
+    }
+
+    field_array->copy_to_device();
+    sp->copy_to_device();
+    REQUIRE_FALSE( sp->partition_valid );
+
+    ParticleSorter<> sorter;
+    const int nv = grid->nv;
+    const std::vector<particle_record_t> loaded = particle_set( sp );
+
+    // The incremental sort groups the particles and leaves the cell table
+    sorter.sort( sp, sort_strategy::incremental, nv );
+    REQUIRE( sp->partition_valid );
+    REQUIRE( cell_table_errors( sp )==0 );
+    REQUIRE( particle_set( sp )==loaded );
+
+    // Nothing changed, so partition must not touch the particles
+    Kokkos::deep_copy( sp->k_p_i_h, sp->k_p_i_d );
+    std::vector<int> cells( sp->k_p_i_h.data(), sp->k_p_i_h.data()+sp->np );
+    sorter.partition( sp, nv );
+    Kokkos::deep_copy( sp->k_p_i_h, sp->k_p_i_d );
+    REQUIRE( std::equal( cells.begin(), cells.end(), sp->k_p_i_h.data() ) );
+
+    // The other strategies reorder the particles without the cell table
+    for( int s=sort_strategy::standard; s<sort_strategy::count; s++ ) {
+      if( s==sort_strategy::incremental ) continue;
+      sorter.sort( sp, s, nv );
+      REQUIRE_FALSE( sp->partition_valid );
+      sorter.partition( sp, nv );
+      REQUIRE( sp->partition_valid );
+      REQUIRE( cell_table_errors( sp )==0 );
+      REQUIRE( particle_set( sp )==loaded );
+    }
+
+    // A push moves particles between cells and the compress removes and
+    // reorders them. The table from before must not be handed out again.
+    // (The movers hold particle indices, so nothing may be partitioned
+    // between the push and the compress.)
+    ParticleCompressor<> compressor;
+    for( int n=0; n<4; n++ ) {
+      advance_p( sp, interpolator_array, field_array );
+      REQUIRE_FALSE( sp->partition_valid );
+
+      const int nm = sp->k_nm_h(0);
+      compressor.compress( sp->k_p_d, sp->k_p_i_d, sp->k_pm_i_d, nm, sp->np, sp );
+      sp->np -= nm;
+      if( nm ) REQUIRE_FALSE( sp->partition_valid );
+
+      sorter.partition( sp, nv );
+      REQUIRE( sp->partition_valid );
+      REQUIRE( cell_table_errors( sp )==0 );
+    }
+
+    std::cout << "pass" << std::endl;
+}
+
+TEST_CASE( "partition follows the particles", "[partition]" ) {
+
+    int pargc = 0;
+    char str[] = "bin/vpic";
+    char **pargv = (char **) malloc(sizeof(char **));
+    pargv[0] = str;
+    boot_services( &pargc, &pargv );
+
+    SECTION( "incremental sort and partition" )
+    {
+        vpic_simulation* simulation = new vpic_simulation;
+        simulation->initialize( pargc, pargv );
+
+        simulation->finalize();
+        delete simulation;
+        if( world_rank==0 ) log_printf( "normal exit\n" );
+
+        halt_mp();
+    }
+}
@@ -0,0 +1,135 @@
+// Checks that every sort strategy groups the same particles into each
+// voxel: the cell table built after each sort must list the same
+// particles per voxel, and the two strategies that order the particles by
+// voxel (standard and incremental) must store them in the same order.
+
+#define CATCH_CONFIG_MAIN  // This tells Catch to provide a main()
+#include "catch.hpp"
+
+#include <algorithm>
+#include <array>
+#include <iostream>
+#include <vector>
+
+#include "src/species_advance/species_advance.h"
+#include "src/particle_operations/sort.h"
+#include "src/vpic/vpic.h"
+#include "cell_table.h"
+
+typedef std::array<float, PARTICLE_VAR_COUNT> particle_record_t;
+
+// The particles listed in each voxel of the cell table of sp, in a
+// canonical order within the voxel
+static std::vector< std::vector<particle_record_t> >
+particles_by_voxel( species_t * sp ) {
+  auto partition = Kokkos::create_mirror_view_and_copy( Kokkos::HostSpace(),
+                                                        sp->k_partition_d );
+  auto slot = Kokkos::create_mirror_view_and_copy( Kokkos::HostSpace(),
+                                                   sp->k_cell_slot_d );
+  Kokkos::deep_copy( sp->k_p_h, sp->k_p_d );
+  std::vector< std::vector<particle_record_t> > voxels( sp->g->nv );
+  for( int v=0; v<sp->g->nv; v++ ) {
+    for( int k=partition(v); k<partition(v+1); k++ ) {
+      const int i = slot(k);
+      if( i<0 ) continue;
+      particle_record_t r;
+      for( int n=0; n<PARTICLE_VAR_COUNT; n++ ) r[n] = sp->k_p_h(i, n);
+      voxels[v].push_back( r );
+    }
+    std::sort( voxels[v].begin(), voxels[v].end() );
+  }
+  return voxels;
+}
+
+static std::vector<int>
+voxel_sequence( species_t * sp ) {
+  Kokkos::deep_copy( sp->k_p_i_h, sp->k_p_i_d );
+  return std::vector<int>( sp->k_p_i_h.data(), sp->k_p_i_h.data()+sp->np );
+}
+
+void vpic_simulation::user_diagnostics() {}
+
+void
+vpic_simulation::user_initialization( int num_cmdline_arguments,
+                                      char ** cmdline_argument )
+{
+    double L  = 8;
+    int npart = 16384;
+
+    define_units( 1, 1 );
+    define_timestep( 0.5 );
+    define_periodic_grid( 0, 0, 0,   // Grid low corner
+                          L, L, L,   // Grid high corner
+                          8, 8, 8,   // Grid resolution
+                          1, 1, 1 ); // Processor configuration
+    define_material( "vacuum", 1.0, 1.0, 0.0 );
+    define_field_array();
+
+    species_t * sp = define_species( "test_species", 1., 1., npart, npart, 0, 0 );
+
+    for (int i = 0; i < npart; i++)
+    {
+        float x = uniform( rng(0), 0, L);
+        float y = uniform( rng(0), 0, L);
+        float z = uniform( rng(0), 0, L);
+        float ux = uniform( rng(0), -1, 1);
+        float uy = uniform( rng(0), -1, 1);
+        float uz = uniform( rng(0), -1, 1);
+        inject_particle( sp, x, y, z, ux, uy, uz, 1., 0., 0);
+    }
+
+    sp->copy_to_device();
+
+    ParticleSorter<> sorter;
+    const int nv = grid->nv;
+
+    // Reference: the plain bin sort by voxel
+    sorter.sort( sp, sort_strategy::standard, nv );
+    const std::vector<int> sorted = voxel_sequence( sp );
+    REQUIRE( std::is_sorted( sorted.begin(), sorted.end() ) );
+    sorter.partition( sp, nv );
+    REQUIRE( cell_table_errors( sp )==0 );
+    const std::vector< std::vector<particle_record_t> > reference = particles_by_voxel( sp );
+
+    // Each strategy is run from the order the previous one left behind
+    for( int s=sort_strategy::standard; s<sort_strategy::count; s++ ) {
+      sorter.sort( sp, s, nv );
+
+      const std::vector<int> sequence = voxel_sequence( sp );
+      if( s==sort_strategy::standard || s==sort_strategy::incremental )
+        REQUIRE( sequence==sorted );
+      else {
+        // Interleaved, but with the same number of particles per voxel
+        std::vector<int> counted = sequence;
+        std::sort( counted.begin(), counted.end() );
+        REQUIRE( counted==sorted );
+      }
+
+      sorter.partition( sp, nv );
+      REQUIRE( cell_table_errors( sp )==0 );
+      REQUIRE( particles_by_voxel( sp )==reference );
+    }
+
+    std::cout << "pass" << std::endl;
+}
+
+TEST_CASE( "sort strategies agree on the voxels", "[sort]" ) {
+
+    int pargc = 0;
+    char str[] = "bin/vpic";
+    char **pargv = (char **) malloc(sizeof(char **));
+    pargv[0] = str;
+    boot_services( &pargc, &pargv );
+
+    SECTION( "sort strategies" )
+    {
+        vpic_simulation* simulation = new vpic_simulation;
+        simulation->initialize( pargc, pargv );
+
+        simulation->finalize();
+        delete simulation;
+        if( world_rank==0 ) log_printf( "normal exit\n" );
+
+        halt_mp();
+    }
+}
@@ -0,0 +1,127 @@
+// The workspace arena must hand the same storage back to a slot that is
+// borrowed again at the same or a smaller size, keep what the previous
+// borrower left there, and keep slots apart. Once ParticleSorter::reserve
+// has sized the slots for a species, sorting it with the strategy it
+// reserved for must not grow the arena.
+
+#define CATCH_CONFIG_MAIN  // This tells Catch to provide a main()
+#include "catch.hpp"
+
+#include <iostream>
+
+#include "src/species_advance/species_advance.h"
+#include "src/particle_operations/sort.h"
+#include "src/vpic/workspace.h"
+#include "src/vpic/vpic.h"
+
+// Storage of a slot, without growing it
+static const char *
+slot_data( int slot ) {
+  return workspace_storage( slot, 0 );
+}
+
+void vpic_simulation::user_diagnostics() {}
+
+void
+vpic_simulation::user_initialization( int num_cmdline_arguments,
+                                      char ** cmdline_argument )
+{
+    double L  = 8;
+    int npart = 32768;
+
+    define_units( 1, 1 );
+    define_timestep( 0.5 );
+    define_periodic_grid( 0, 0, 0,   // Grid low corner
+                          L, L, L,   // Grid high corner
+                          8, 8, 8,   // Grid resolution
+                          1, 1, 1 ); // Processor configuration
+    define_material( "vacuum", 1.0, 1.0, 0.0 );
+    define_field_array();
+
+    species_t * sp = define_species( "test_species", 1., 1., npart, npart, 0, 0 );
+    for( int i=0; i<npart/2; i++ )
+      inject_particle( sp, uniform( rng(0), 0, L ), uniform( rng(0), 0, L ),
+                       uniform( rng(0), 0, L ), 0, 0, 0, 1., 0., 0 );
+    sp->copy_to_device();
+
+    workspace_release();
+    REQUIRE( workspace_bytes()==0 );
+
+    // Borrowing again reuses the slot and sees what was left in it
+    auto a = workspace_view<int*>( workspace_sort_keys, 1000 );
+    Kokkos::parallel_for( "fill slot", 1000, KOKKOS_LAMBDA( const int i ) { a(i) = 3*i; } );
+    auto b = workspace_view<int*>( workspace_sort_keys, 500 );
+    REQUIRE( b.data()==a.data() );
+    int wrong = 0;
+    Kokkos::parallel_reduce( "read slot", 500, KOKKOS_LAMBDA( const int i, int & w ) {
+      if( b(i)!=3*i ) w++;
+    }, wrong );
+    REQUIRE( wrong==0 );
+    REQUIRE( workspace_bytes()==1000*sizeof(int) );
+
+    // Other slots have their own storage
+    auto c = workspace_view<float*>( workspace_sort_counter, 1000 );
+    REQUIRE( ( c.data()+1000<=(float *)a.data() || (float *)( a.data()+1000 )<=c.data() ) );
+    REQUIRE( workspace_bytes()==2000*sizeof(int) );
+
+    // Growing replaces the storage
+    workspace_view<int*>( workspace_sort_keys, 4000 );
+    REQUIRE( workspace_bytes()==5000*sizeof(int) );
+
+    // Sorting after reserve does not grow the arena
+    ParticleSorter<> sorter;
+    const int strategies[3] = { sort_strategy::strided, sort_strategy::tiled,
+                                sort_strategy::tiled_strided };
+    for( int s : strategies ) {
+      workspace_release();
+      sp->sort_method = s;
+      sorter.reserve( sp, grid->nv );
+      const size_t n_byte = workspace_bytes();
+      const char * keys = slot_data( workspace_sort_keys );
+      const char * counter = slot_data( workspace_sort_counter );
+      REQUIRE( n_byte>=( s==sort_strategy::strided ? sizeof(uint64_t) : sizeof(int) )*sp->max_np );
+
+      sorter.sort( sp, s, grid->nv );
+      REQUIRE( workspace_bytes()==n_byte );
+      REQUIRE( slot_data( workspace_sort_keys )==keys );
+      REQUIRE( slot_data( workspace_sort_counter )==counter );
+
+      // Still true once the species has filled up
+      for( int i=sp->np; i<npart; i++ )
+        inject_particle( sp, uniform( rng(0), 0, L ), uniform( rng(0), 0, L ),
+                         uniform( rng(0), 0, L ), 0, 0, 0, 1., 0., 0 );
+      sp->copy_to_device();
+      sorter.sort( sp, s, grid->nv );
+      REQUIRE( workspace_bytes()==n_byte );
+      REQUIRE( slot_data( workspace_sort_keys )==keys );
+    }
+
+    // The standard sort borrows nothing
+    workspace_release();
+    sp->sort_method = sort_strategy::standard;
+    sorter.reserve( sp, grid->nv );
+    sorter.sort( sp, sort_strategy::standard, grid->nv );
+    REQUIRE( workspace_bytes()==0 );
+
+    std::cout << "pass" << std::endl;
+}
+
+TEST_CASE( "workspace slots and sort reservations", "[workspace]" )
+{
+    int pargc = 0;
+    char str[] = "bin/vpic";
+    char **pargv = (char **) malloc(sizeof(char **));
+    pargv[0] = str;
+    boot_services( &pargc, &pargv );
+
+    SECTION("main")
+    {
+        vpic_simulation* simulation = new vpic_simulation;
+        simulation->initialize( pargc, pargv );
+        simulation->finalize();
+        delete simulation;
+        if( world_rank==0 ) log_printf( "normal exit\n" );
+
+        halt_mp();
+    }
+}
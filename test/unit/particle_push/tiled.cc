@@ -0,0 +1,169 @@
+// Compares the tiled particle push (advance_p with tiled set) against the
+// regular push, with stored interpolators and on the fly. The tiled push
+// partitions the particles first, so they are compared as sets.
+
+#define CATCH_CONFIG_MAIN  // This tells Catch to provide a main()
+#include "catch.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include "src/species_advance/species_advance.h"
+#include "src/particle_operations/compress.h"
+#include "src/vpic/vpic.h"
+
+typedef std::array<float, PARTICLE_VAR_COUNT+1> particle_record_t;
+
+// The particles of sp in a canonical order
+static std::vector<particle_record_t>
+particle_set( species_t * sp ) {
+  Kokkos::deep_copy( sp->k_p_h, sp->k_p_d );
+  Kokkos::deep_copy( sp->k_p_i_h, sp->k_p_i_d );
+  std::vector<particle_record_t> set( sp->np );
+  for( int i=0; i<sp->np; i++ ) {
+    set[i][0] = (float)sp->k_p_i_h(i);
+    for( int v=0; v<PARTICLE_VAR_COUNT; v++ ) set[i][v+1] = sp->k_p_h(i, v);
+  }
+  std::sort( set.begin(), set.end() );
+  return set;
+}
+
+void vpic_simulation::user_diagnostics() {}
+
+void
+vpic_simulation::user_initialization( int num_cmdline_arguments,
+                                      char ** cmdline_argument )
+{
+    double L  = 8;
+    int npart = 16384;
+    int nstep = 4;
+
+    define_units( 1, 1 );
+    define_timestep( 0.5 );
+    define_periodic_grid( 0, 0, 0,   // Grid low corner
+                          L, L, L,   // Grid high corner
+                          8, 8, 8,   // Grid resolution
+                          1, 1, 1 ); // Processor configuration
+    define_material( "vacuum", 1.0, 1.0, 0.0 );
+    define_field_array();
+
+    for( int z=1; z<=grid->nz+1; z++ )
+      for( int y=1; y<=grid->ny+1; y++ )
+        for( int x=1; x<=grid->nx+1; x++ ) {
+          field(x,y,z).ex  = 0.01*x*y;
+          field(x,y,z).ey  = 0.02*y*z;
+          field(x,y,z).ez  = 0.03*z*x;
+          field(x,y,z).cbx = 0.01*z;
+          field(x,y,z).cby = 0.02*x;
+          field(x,y,z).cbz = 0.03*y;
+        }
+
+    species_t * sp  = define_species( "regular", -1., 1., npart, npart, 0, 0 );
+    species_t * sp2 = define_species( "tiled", -1., 1., npart, npart, 0, 0 );
+
+    for (int i = 0; i < npart; i++)
+    {
+        float x = uniform( rng(0), 0, L);
+        float y = uniform( rng(0), 0, L);
+        float z = uniform( rng(0), 0, L);
+        float ux = uniform( rng(0), -1, 1);
+        float uy = uniform( rng(0), -1, 1);
+        float uz = uniform( rng(0), -1, 1);
+
+        // Put two sets of particle in the exact same space
+        inject_particle( sp , x, y, z, ux, uy, uz, 1., 0., 0);
+        inject_particle( sp2, x, y, z, ux, uy, uz, 1., 0., 0);
+    }
+
+    field_array->copy_to_device();
+    sp->copy_to_device();
+    sp2->copy_to_device();
+
+    ParticleCompressor<> compressor;
+    float reltol = 1e-5;
+    int failed = 0;
+
+    // Push one species and return the current it deposited
+    auto push = [&]( species_t * s, int tiled ) {
+      field_array->kernel->clear_jf_kokkos( field_array );
+      advance_p( s, interpolator_array, field_array, tiled );
+      return Kokkos::create_mirror_view_and_copy( Kokkos::HostSpace(),
+                                                  field_array->k_f_d );
+    };
+
+    for( int on_the_fly=0; on_the_fly<2; on_the_fly++ ) {
+      set_interpolator_array_on_the_fly( interpolator_array, on_the_fly );
+      load_interpolator_array( interpolator_array, field_array );
+
+      for( int n=0; n<nstep; n++ ) {
+        auto f_regular = push( sp, 0 );
+        auto f_tiled = push( sp2, 1 );
+
+        const int nm = sp->k_nm_h(0);
+        REQUIRE( sp2->k_nm_h(0)==nm );
+
+        const std::vector<particle_record_t> a = particle_set( sp );
+        const std::vector<particle_record_t> b = particle_set( sp2 );
+        REQUIRE( a.size()==b.size() );
+        for( size_t k=0; k<a.size(); k++ )
+          for( int v=0; v<=PARTICLE_VAR_COUNT; v++ )
+            if( std::abs(a[k][v]-b[k][v])>reltol*std::max( 1.f, std::abs(a[k][v]) ) )
+              failed++;
+
+        // The tiled push sums the current of a tile in scratch first
+        float j_max = 0;
+        for( int i=0; i<grid->nv; i++ )
+          for( int c=field_var::jfx; c<=field_var::jfz; c++ )
+            j_max = std::max( j_max, std::abs( f_regular(i, c) ) );
+        for( int i=0; i<grid->nv; i++ )
+          for( int c=field_var::jfx; c<=field_var::jfz; c++ )
+            if( std::abs( f_regular(i, c)-f_tiled(i, c) )>reltol*j_max )
+            {
+              std::cout << " Failed at " << i << " component " << c << " with "
+                        << f_regular(i, c) << " and " << f_tiled(i, c) << std::endl;
+              failed++;
+            }
+
+        // Start the next step from the same particles. Copying over the
+        // tiled species reorders it, so its offsets have to go.
+        compressor.compress( sp->k_p_d, sp->k_p_i_d, sp->k_pm_i_d, nm, sp->np, sp );
+        compressor.compress( sp2->k_p_d, sp2->k_p_i_d, sp2->k_pm_i_d, nm, sp2->np, sp2 );
+        sp->np  -= nm;
+        sp2->np -= nm;
+        Kokkos::deep_copy( sp2->k_p_d, sp->k_p_d );
+        Kokkos::deep_copy( sp2->k_p_i_d, sp->k_p_i_d );
+        sp2->invalidate_partition();
+      }
+    }
+
+    if( failed )
+    {  std::cout << "FAIL" << std::endl;
+    }
+    REQUIRE_FALSE(failed);
+
+    std::cout << "pass" << std::endl;
+}
+
+TEST_CASE( "tiled push matches the regular push", "[push]" ) {
+
+    int pargc = 0;
+    char str[] = "bin/vpic";
+    char **pargv = (char **) malloc(sizeof(char **));
+    pargv[0] = str;
+    boot_services( &pargc, &pargv );
+
+    SECTION( "tiled push" )
+    {
+        vpic_simulation* simulation = new vpic_simulation;
+        simulation->initialize( pargc, pargv );
+
+        simulation->finalize();
+        delete simulation;
+        if( world_rank==0 ) log_printf( "normal exit\n" );
+
+        halt_mp();
+    }
+}
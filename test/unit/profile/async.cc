@@ -0,0 +1,110 @@
+// Checks the KOKKOS_TIC / KOKKOS_TOC timers.  With
+// VPIC_ENABLE_ASYNC_PROFILE the kernels of a region are charged to its
+// kernel time (inner regions first) on top of its host wall time, and
+// callbacks installed before the profiler (as a Kokkos tool loaded
+// through KOKKOS_PROFILE_LIBRARY would be) still see every kernel.
+
+#define CATCH_CONFIG_MAIN  // This tells Catch to provide a main()
+#include "catch.hpp"
+
+#include <cmath>
+#include <iostream>
+
+#include "src/vpic/vpic.h"
+
+void vpic_simulation::user_diagnostics() {}
+
+void
+vpic_simulation::user_initialization( int num_cmdline_arguments,
+                                      char ** cmdline_argument ) {}
+
+// Stand-in for an external tool: hands out its own kernel ids and checks
+// it gets them back
+static int tool_begin = 0, tool_end = 0, tool_mismatch = 0;
+
+static void
+tool_begin_parallel_for( const char *, uint32_t, uint64_t * kID ) {
+  *kID = 1000 + tool_begin++;
+}
+
+static void
+tool_end_parallel_for( uint64_t kID ) {
+  if( kID!=(uint64_t)( 1000 + tool_end++ ) ) tool_mismatch++;
+}
+
+static void
+work( Kokkos::View<double*> a,
+      int passes ) {
+  Kokkos::parallel_for( "profile test work", a.extent(0), KOKKOS_LAMBDA( const int i ) {
+    double x = a(i);
+    for( int k=0; k<passes; k++ ) x = sqrt( x*x + 1. );
+    a(i) = x;
+  });
+}
+
+TEST_CASE( "asynchronous profile timers", "[profile]" ) {
+
+    int pargc = 0;
+    char str[] = "bin/vpic";
+    char **pargv = (char **) malloc(sizeof(char **));
+    pargv[0] = str;
+    boot_services( &pargc, &pargv );
+
+    SECTION( "kernels are charged to the innermost region" )
+    {
+        Kokkos::View<double*> a( "a", 1<<20 );
+
+#if defined(VPIC_ENABLE_ASYNC_PROFILE)
+        // The profiler was installed by boot_services; install the tool
+        // over it and let the profiler chain to the tool again
+        Kokkos::Tools::Experimental::set_begin_parallel_for_callback( tool_begin_parallel_for );
+        Kokkos::Tools::Experimental::set_end_parallel_for_callback( tool_end_parallel_for );
+        profile_async_initialize();
+#endif
+
+        work( a, 1 ); // Not in any region
+
+        KOKKOS_TIC();
+          work( a, 4 );
+          KOKKOS_TIC();
+            work( a, 16 );
+          KOKKOS_TOC( advance_b, 1 );
+          work( a, 4 );
+        KOKKOS_TOC( advance_e, 1 );
+
+        update_profile( 0 );
+
+        const profile_internal_use_only_timer_t & inner =
+          profile_internal_use_only[ profile_internal_use_only_advance_b ];
+        const profile_internal_use_only_timer_t & outer =
+          profile_internal_use_only[ profile_internal_use_only_advance_e ];
+
+        // Wall time is charged either way
+        REQUIRE( inner.n_total==1 );
+        REQUIRE( outer.n_total==1 );
+        REQUIRE( inner.t_total>0 );
+        REQUIRE( outer.t_total>=inner.t_total );
+
+#if defined(VPIC_ENABLE_ASYNC_PROFILE)
+        REQUIRE( inner.t_kernel_total>0 );
+        REQUIRE( outer.t_kernel_total>0 );
+#if !defined(KOKKOS_ENABLE_CUDA)
+        // Host kernels run inside the region that launched them, read off
+        // the same clock, so the outer kernels fit in the outer region
+        // minus the inner one
+        REQUIRE( inner.t_kernel_total<=inner.t_total + 1e-6 );
+        REQUIRE( outer.t_kernel_total<=outer.t_total - inner.t_total + 1e-6 );
+#endif
+        REQUIRE( tool_begin==4 );
+        REQUIRE( tool_end==4 );
+        REQUIRE( tool_mismatch==0 );
+#else
+        REQUIRE( inner.t_kernel_total==0 );
+        REQUIRE( outer.t_kernel_total==0 );
+#endif
+
+        if( world_rank==0 ) log_printf( "normal exit\n" );
+
+        halt_mp();
+    }
+}